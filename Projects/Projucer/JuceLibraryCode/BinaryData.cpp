@@ -1282,6 +1282,10 @@ static const unsigned char temp_binary_data_91[] =
 "      { \"command\": \"SwitchToArrangeMode\", \"key\": \"Page Down\" },\n"
 "      { \"command\": \"SwitchToVersioningMode\", \"key\": \"Control + S\" },\n"
 "      { \"command\": \"SwitchToVersioningMode\", \"key\": \"Command + S\" },\n"
+"\n"
+"      // Frame time and paint counters overlay, click on it to export a Chrome trace:\n"
+"      { \"command\": \"ToggleProfilerOverlay\", \"key\": \"Control + Shift + F12\" },\n"
+"      { \"command\": \"ToggleProfilerOverlay\", \"key\": \"Command + Shift + F12\" },\n"
 "    ]\n"
 "  }, // ANCHOR_END: MainLayout\n"
 "  {  // ANCHOR: SequencerLayout\n"
@@ -4183,7 +4187,7 @@ const char* getNamedResource (const char* resourceNameUTF8, int& numBytes)
         case 0xb278622d:  numBytes = 64; return arpeggiators_json;
         case 0xd1d24c90:  numBytes = 768; return chords_json;
         case 0x41b35b05:  numBytes = 3297; return colourSchemes_json;
-        case 0x25669f2b:  numBytes = 15701; return hotkeySchemes_json;
+        case 0x25669f2b:  numBytes = 15944; return hotkeySchemes_json;
         case 0xfd7446db:  numBytes = 588; return keyboardMappings_json;
         case 0x048f5efe:  numBytes = 9400; return scales_json;
         case 0x77719112:  numBytes = 1091; return temperaments_json;
@@ -282,7 +282,7 @@ namespace BinaryData
     const int            colourSchemes_jsonSize = 3297;
 
     extern const char*   hotkeySchemes_json;
-    const int            hotkeySchemes_jsonSize = 15701;
+    const int            hotkeySchemes_jsonSize = 15944;
 
     extern const char*   keyboardMappings_json;
     const int            keyboardMappings_jsonSize = 588;
@@ -15,6 +15,7 @@
 #include "../../Source/Core/Audio/Instruments/Instrument.cpp"
 #include "../../Source/Core/Audio/Instruments/OrchestraPit.cpp"
 #include "../../Source/Core/Audio/Instruments/PluginScanner.cpp"
+#include "../../Source/Core/Audio/Instruments/PluginScanCache.cpp"
 #include "../../Source/Core/Audio/Instruments/SerializablePluginDescription.cpp"
 #include "../../Source/Core/Audio/Monitoring/AudioMonitor.cpp"
 #include "../../Source/Core/Audio/Monitoring/SpectrumAnalyzer.cpp"
@@ -63,6 +64,7 @@
 #include "../../Source/Core/Midi/Sequences/PianoSequence.cpp"
 #include "../../Source/Core/Midi/Sequences/TimeSignaturesSequence.cpp"
 #include "../../Source/Core/Midi/MidiTrack.cpp"
+#include "../../Source/Core/Midi/MidiFileWriter.cpp"
 #include "../../Source/Core/Network/Requests/BackendRequest.cpp"
 #include "../../Source/Core/Network/Requests/UserConfigSyncThread.cpp"
 #include "../../Source/Core/Network/Requests/ProjectCloneThread.cpp"
@@ -77,6 +79,7 @@
 #include "../../Source/Core/Serialization/Document.cpp"
 #include "../../Source/Core/Serialization/DocumentHelpers.cpp"
 #include "../../Source/Core/Serialization/SerializedData.cpp"
+#include "../../Source/Core/Serialization/SerializedDataWriter.cpp"
 #include "../../Source/Core/Serialization/BinarySerializer.cpp"
 #include "../../Source/Core/Serialization/JsonSerializer.cpp"
 #include "../../Source/Core/Serialization/XmlSerializer.cpp"
@@ -109,6 +112,7 @@
 #include "../../Source/Core/VCS/DiffLogic/AutomationTrackDiffLogic.cpp"
 #include "../../Source/Core/VCS/DiffLogic/DiffLogic.cpp"
 #include "../../Source/Core/VCS/DiffLogic/PatternDiffHelpers.cpp"
+#include "../../Source/Core/VCS/DiffLogic/PackedNotes.cpp"
 #include "../../Source/Core/VCS/DiffLogic/PianoTrackDiffLogic.cpp"
 #include "../../Source/Core/VCS/DiffLogic/ProjectInfoDiffLogic.cpp"
 #include "../../Source/Core/VCS/DiffLogic/ProjectTimelineDiffLogic.cpp"
@@ -127,6 +131,7 @@
 #include "../../Source/Core/Workspace/UserSessionInfo.cpp"
 #include "../../Source/Core/Workspace/UserProfile.cpp"
 #include "../../Source/Core/Workspace/Workspace.cpp"
+#include "../../Source/Core/Workspace/BatchRunner.cpp"
 #include "../../Source/Core/App.cpp"
 #include "../../Source/UI/Common/AudioMonitors/SpectrogramAudioMonitorComponent.cpp"
 #include "../../Source/UI/Common/AudioMonitors/WaveformAudioMonitorComponent.cpp"
@@ -134,12 +139,15 @@
 #include "../../Source/UI/Common/Origami/OrigamiHorizontal.cpp"
 #include "../../Source/UI/Common/Origami/OrigamiVertical.cpp"
 #include "../../Source/UI/Common/ColourButton.cpp"
+#include "../../Source/UI/Common/AnimationClock.cpp"
 #include "../../Source/UI/Common/ColourSwatches.cpp"
 #include "../../Source/UI/Common/CommandIDs.cpp"
 #include "../../Source/UI/Common/ColourIDs.cpp"
 #include "../../Source/UI/Common/DraggingListBoxComponent.cpp"
 #include "../../Source/UI/Common/FineTuningComponentDragger.cpp"
 #include "../../Source/UI/Common/FineTuningValueIndicator.cpp"
+#include "../../Source/UI/Common/FrameProfiler.cpp"
+#include "../../Source/UI/Common/FrameProfilerOverlay.cpp"
 #include "../../Source/UI/Common/KeySelector.cpp"
 #include "../../Source/UI/Common/MobileComboBox.cpp"
 #include "../../Source/UI/Common/ModeIndicatorComponent.cpp"
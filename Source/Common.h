@@ -43,6 +43,7 @@
 #include <climits>
 #include <cfloat>
 #include <cmath>
+#include <set>
 
 //===----------------------------------------------------------------------===//
 // A better hash map
@@ -81,6 +82,14 @@ struct IdentifierHash
     }
 };
 
+struct UuidHash
+{
+    inline HashCode operator()(const juce::Uuid &key) const noexcept
+    {
+        return static_cast<HashCode>(key.hash());
+    }
+};
+
 //===----------------------------------------------------------------------===//
 // Various helpers
 //===----------------------------------------------------------------------===//
@@ -21,6 +21,8 @@
 #include "HelioTheme.h"
 #include "Config.h"
 #include "Icons.h"
+#include "AnimationClock.h"
+#include "BatchRunner.h"
 
 #include "DocumentHelpers.h"
 #include "XmlSerializer.h"
@@ -115,6 +117,13 @@ public:
         }
     }
 
+    // nothing to animate while the window is minimized:
+    void minimisationStateChanged(bool isNowMinimised) override
+    {
+        DocumentWindow::minimisationStateChanged(isNowMinimised);
+        App::AnimationClock().setSuspended(isNowMinimised);
+    }
+
     // Overridden to avoid assertions in ResizableWindow:
 #if JUCE_DEBUG
     void addChildComponent(Component *child, int zOrder = -1)
@@ -255,6 +264,11 @@ class Clipboard &App::Clipboard() noexcept
     return static_cast<App *>(getInstance())->clipboard;
 }
 
+class AnimationClock &App::AnimationClock() noexcept
+{
+    return *static_cast<App *>(getInstance())->animationClock;
+}
+
 static Point<double> getScreenInCm()
 {
     const auto *mainDisplay = Desktop::getInstance().getDisplays().getPrimaryDisplay();
@@ -488,6 +502,10 @@ void App::initialise(const String &commandLine)
     {
         this->runMode = RunMode::PluginCheck;
     }
+    else if (BatchRunner::isBatchCommandLine(this->getCommandLineParameterArray()))
+    {
+        this->runMode = RunMode::Batch;
+    }
 
     if (this->runMode == RunMode::Normal)
     {
@@ -541,6 +559,7 @@ void App::initialise(const String &commandLine)
 
         // if this is not a unit test runner, proceed as normal:
 
+        this->animationClock = make<class AnimationClock>();
         this->workspace = make<class Workspace>();
         
         const auto shouldEnableOpenGL = this->config->getUiFlags()->isOpenGlRendererEnabled();
@@ -568,6 +587,30 @@ void App::initialise(const String &commandLine)
         this->checkPlugin(commandLine);
         this->quit();
     }
+    else if (this->runMode == RunMode::Batch)
+    {
+#if JUCE_MAC
+        Process::setDockIconVisible(false);
+#endif
+
+        // no window, no network, and no user's workspace loaded;
+        // projects still create their (never shown) pages, hence the theme
+        this->config = make<class Config>();
+        this->config->initResources();
+
+        auto helioTheme = make<HelioTheme>();
+        helioTheme->initResources();
+        helioTheme->initColours(this->config->getColourSchemes()->getCurrent());
+        this->theme = move(helioTheme);
+        LookAndFeel::setDefaultLookAndFeel(this->theme.get());
+
+        this->animationClock = make<class AnimationClock>();
+        this->workspace = make<class Workspace>();
+        this->workspace->initHeadless();
+
+        this->batchRunner = make<BatchRunner>(this->getCommandLineParameterArray());
+        this->batchRunner->start();
+    }
 }
 
 void App::shutdown()
@@ -587,6 +630,7 @@ void App::shutdown()
             this->workspace = nullptr;
         }
 
+        this->animationClock = nullptr;
         this->theme = nullptr;
         this->config = nullptr;
 
@@ -600,6 +644,17 @@ void App::shutdown()
         Icons::clearPrerenderedCache();
         Icons::clearBuiltInImages();
     }
+    else if (this->runMode == RunMode::Batch)
+    {
+        this->batchRunner = nullptr;
+        this->workspace = nullptr;
+        this->animationClock = nullptr;
+        this->theme = nullptr;
+        this->config = nullptr;
+
+        Icons::clearPrerenderedCache();
+        Icons::clearBuiltInImages();
+    }
 }
 
 const String App::getApplicationName()
@@ -647,6 +702,11 @@ void App::suspended()
         this->workspace->getAudioCore().setCanSleepAfter(0);
         this->workspace->autosave();
     }
+
+    if (this->animationClock != nullptr)
+    {
+        this->animationClock->setSuspended(true);
+    }
     
 #if JUCE_ANDROID
     this->window->detachOpenGLContextIfAny();
@@ -660,6 +720,11 @@ void App::resumed()
         this->workspace->getAudioCore().setAwake();
     }
 
+    if (this->animationClock != nullptr)
+    {
+        this->animationClock->setSuspended(false);
+    }
+
 #if JUCE_ANDROID
     this->window->attachOpenGLContext();
 #endif
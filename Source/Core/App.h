@@ -22,6 +22,8 @@ class Network;
 class Workspace;
 class MainWindow;
 class MainLayout;
+class AnimationClock;
+class BatchRunner;
 
 #include "Serializable.h"
 #include "UserInterfaceFlags.h"
@@ -59,6 +61,7 @@ public:
     static class MainLayout &Layout() noexcept;
     static class Workspace &Workspace() noexcept;
     static class Clipboard &Clipboard() noexcept;
+    static class AnimationClock &AnimationClock() noexcept;
 
     static bool isRunningOnPhone();
     static bool isRunningOnTablet();
@@ -109,6 +112,10 @@ private:
     UniquePointer<class Workspace> workspace;
     UniquePointer<class MainWindow> window;
     UniquePointer<class Network> network;
+    UniquePointer<class AnimationClock> animationClock;
+
+    // only exists in the command line batch mode
+    UniquePointer<BatchRunner> batchRunner;
 
 private:
 
@@ -126,7 +133,8 @@ private:
     enum class RunMode
     {
         Normal,
-        PluginCheck
+        PluginCheck,
+        Batch
     };
 
     RunMode runMode = RunMode::Normal;
@@ -25,6 +25,201 @@ struct BuiltInSynthSound final : public SynthesiserSound
     bool appliesToChannel(int midiChannel) override { return true; }
 };
 
+// One period of a sine shared by all voices, with a guard point
+// at the end, so that the interpolation never needs to wrap around
+struct BuiltInSynthSineTable final
+{
+    static constexpr auto size = 2048;
+
+    BuiltInSynthSineTable()
+    {
+        for (int i = 0; i <= size; ++i)
+        {
+            this->values[i] = float(std::sin(MathConstants<double>::twoPi * double(i) / double(size)));
+        }
+    }
+
+    static const BuiltInSynthSineTable &getInstance()
+    {
+        static const BuiltInSynthSineTable table;
+        return table;
+    }
+
+    float values[size + 1];
+};
+
+// A linear ADSR with the same parameters and curves as juce::ADSR,
+// but rendering the whole block at once: each stage is a single ramp
+// or a fill, instead of a state machine switch on every sample
+class BuiltInSynthEnvelope final
+{
+public:
+
+    void setParameters(const ADSR::Parameters &newParameters) noexcept
+    {
+        this->parameters = newParameters;
+        this->recalculateRates();
+    }
+
+    void setSampleRate(double newSampleRate) noexcept
+    {
+        this->sampleRate = newSampleRate;
+        this->recalculateRates();
+    }
+
+    bool isActive() const noexcept
+    {
+        return this->state != State::Idle;
+    }
+
+    float getLevel() const noexcept
+    {
+        return this->level;
+    }
+
+    void noteOn() noexcept
+    {
+        this->state = this->attackRate > 0.f ? State::Attack : State::Decay;
+        if (this->state == State::Decay)
+        {
+            this->level = 1.f;
+        }
+    }
+
+    void noteOff() noexcept
+    {
+        if (this->state == State::Idle || this->state == State::Release)
+        {
+            return;
+        }
+
+        if (this->parameters.release > 0.f && this->level > 0.f)
+        {
+            this->releaseRate = this->level / float(this->parameters.release * this->sampleRate);
+            this->state = State::Release;
+        }
+        else
+        {
+            this->reset();
+        }
+    }
+
+    void reset() noexcept
+    {
+        this->level = 0.f;
+        this->state = State::Idle;
+    }
+
+    void render(float *destination, int numSamples) noexcept
+    {
+        while (numSamples > 0)
+        {
+            switch (this->state)
+            {
+            case State::Idle:
+                FloatVectorOperations::clear(destination, numSamples);
+                return;
+            case State::Attack:
+            {
+                const auto num = this->getRampLength(1.f - this->level, this->attackRate, numSamples);
+                this->level = fillRamp(destination, num, this->level, this->attackRate);
+                if (num == 0 || this->level >= 1.f)
+                {
+                    this->level = 1.f;
+                    this->state = State::Decay;
+                }
+                destination += num;
+                numSamples -= num;
+                break;
+            }
+            case State::Decay:
+            {
+                const auto num = this->getRampLength(this->level - this->parameters.sustain, this->decayRate, numSamples);
+                this->level = fillRamp(destination, num, this->level, -this->decayRate);
+                if (num == 0 || this->level <= this->parameters.sustain)
+                {
+                    this->level = this->parameters.sustain;
+                    this->state = State::Sustain;
+                }
+                destination += num;
+                numSamples -= num;
+                break;
+            }
+            case State::Sustain:
+                FloatVectorOperations::fill(destination, this->level, numSamples);
+                return;
+            case State::Release:
+            {
+                const auto num = this->getRampLength(this->level, this->releaseRate, numSamples);
+                this->level = fillRamp(destination, num, this->level, -this->releaseRate);
+                if (num == 0 || this->level <= 0.f)
+                {
+                    this->reset();
+                }
+                destination += num;
+                numSamples -= num;
+                break;
+            }
+            }
+        }
+    }
+
+private:
+
+    enum class State : int8
+    {
+        Idle,
+        Attack,
+        Decay,
+        Sustain,
+        Release
+    };
+
+    State state = State::Idle;
+
+    ADSR::Parameters parameters;
+    double sampleRate = 44100.0;
+
+    float level = 0.f;
+    float attackRate = 0.f;
+    float decayRate = 0.f;
+    float releaseRate = 0.f;
+
+    void recalculateRates() noexcept
+    {
+        const auto getRate = [this](float distance, float timeInSeconds)
+        {
+            return timeInSeconds > 0.f ? float(distance / (timeInSeconds * this->sampleRate)) : -1.f;
+        };
+
+        this->attackRate = getRate(1.f, this->parameters.attack);
+        this->decayRate = getRate(1.f - this->parameters.sustain, this->parameters.decay);
+    }
+
+    // how many samples of this block the current stage lasts,
+    // zero or negative rate means the stage is instant
+    static int getRampLength(float distance, float rate, int numSamples) noexcept
+    {
+        if (rate <= 0.f || distance <= 0.f)
+        {
+            return 0;
+        }
+
+        return jlimit(1, numSamples, int(std::ceil(distance / rate)));
+    }
+
+    static float fillRamp(float *destination, int numSamples, float start, float delta) noexcept
+    {
+        // not accumulating the level to keep the loop vectorizable
+        for (int i = 0; i < numSamples; ++i)
+        {
+            destination[i] = start + delta * float(i + 1);
+        }
+
+        return start + delta * float(numSamples);
+    }
+};
+
 class BuiltInSynthVoice final : public SynthesiserVoice
 {
 public:
@@ -36,16 +231,7 @@ public:
         ap.decay = 1.0f;
         ap.sustain = 0.2f;
         ap.release = 0.5f;
-        this->adsr.setParameters(ap);
-
-        Reverb::Parameters rp;
-        rp.roomSize = 0.0f;
-        rp.damping = 0.0f;
-        rp.wetLevel = 0.23f;
-        rp.dryLevel = 0.73f;
-        rp.width = 0.0f;
-        rp.freezeMode = 0.4f;
-        this->reverb.setParameters(rp);
+        this->envelope.setParameters(ap);
     }
 
     bool canPlaySound(SynthesiserSound*) override
@@ -57,63 +243,90 @@ public:
     {
         if (sampleRate > 0)
         {
-            this->adsr.setSampleRate(sampleRate);
-            this->reverb.setSampleRate(sampleRate);
+            this->envelope.setSampleRate(sampleRate);
             SynthesiserVoice::setCurrentPlaybackSampleRate(sampleRate);
         }
     }
 
+    // SynthesiserVoice doesn't expose the channel it is playing,
+    // so the synth tells it right before starting a note
+    void setCurrentChannel(int midiChannel) noexcept
+    {
+        this->channel = midiChannel;
+    }
+
+    float getCurrentLevel() const noexcept
+    {
+        return this->level * this->envelope.getLevel();
+    }
+
     void startNote(int midiNoteNumber, float velocity, SynthesiserSound*, int) override
     {
-        const auto channel = this->getCurrentChannel();
         const int realNoteNumber = midiNoteNumber +
-            Globals::twelveToneKeyboardSize * (channel - 1);
+            Globals::twelveToneKeyboardSize * (this->channel - 1);
 
-        this->currentAngle = 0.0;
-        this->level = velocity * 0.15;
+        this->phase = 0.0;
+        this->level = velocity * 0.15f;
 
         const auto cyclesPerSecond = this->getNoteInHertz(realNoteNumber);
         const auto cyclesPerSample = cyclesPerSecond / this->getSampleRate();
 
-        this->angleDelta = cyclesPerSample * MathConstants<double>::twoPi;
+        // anything above Nyquist would alias anyway,
+        // but this keeps the phasor wrapping simple
+        this->phaseDelta = jmin(cyclesPerSample, 0.5);
 
-        this->adsr.noteOn();
+        this->envelope.noteOn();
     }
 
     void stopNote(float, bool allowTailOff) override
     {
         if (allowTailOff)
         {
-            this->adsr.noteOff();
+            this->envelope.noteOff();
         }
         else
         {
             this->clearCurrentNote();
-            this->adsr.reset();
-            this->reverb.reset();
+            this->envelope.reset();
         }
     }
 
     void pitchWheelMoved(int) override {}
     void controllerMoved(int, int) override {}
 
-    void renderNextBlock(AudioBuffer<float>& outputBuffer, int startSample, int numSamples) override
+    void renderNextBlock(AudioBuffer<float> &outputBuffer, int startSample, int numSamples) override
     {
-        if (this->adsr.isActive())
+        if (!this->envelope.isActive())
+        {
+            this->clearCurrentNote();
+            return;
+        }
+
+        float oscillator[BuiltInSynthVoice::maxChunkSize];
+        float amplitude[BuiltInSynthVoice::maxChunkSize];
+
+        while (numSamples > 0)
         {
-            while (--numSamples >= 0)
+            const auto num = jmin(numSamples, BuiltInSynthVoice::maxChunkSize);
+
+            this->envelope.render(amplitude, num);
+            FloatVectorOperations::multiply(amplitude, this->level, num);
+            this->renderOscillator(oscillator, num);
+
+            for (int i = outputBuffer.getNumChannels(); --i >= 0;)
             {
-                const auto amplitude = this->adsr.getNextSample();
-                auto currentSample = (float)(std::sin(currentAngle) * level * amplitude);
-                this->reverb.processMono(&currentSample, 1);
+                FloatVectorOperations::addWithMultiply(outputBuffer.getWritePointer(i, startSample),
+                    oscillator, amplitude, num);
+            }
 
-                for (auto i = outputBuffer.getNumChannels(); --i >= 0;)
-                {
-                    outputBuffer.addSample(i, startSample, currentSample);
-                }
+            startSample += num;
+            numSamples -= num;
 
-                this->currentAngle += this->angleDelta;
-                ++startSample;
+            if (!this->envelope.isActive())
+            {
+                // the release has finished, the voice is free to play another note
+                this->clearCurrentNote();
+                return;
             }
         }
     }
@@ -133,60 +346,392 @@ public:
 
 private:
 
-    double currentAngle = 0.0;
-    double angleDelta = 0.0;
-    double level = 0.0;
+    static constexpr auto maxChunkSize = 64;
+
+    int channel = 1;
+
+    double phase = 0.0; // 0..1
+    double phaseDelta = 0.0;
+    float level = 0.f;
     
     int periodSize = Globals::twelveTonePeriodSize;
     double periodRange = 2.0;
     int middleC = Temperament::periodNumForMiddleC * Globals::twelveTonePeriodSize;
 
-    ADSR adsr;
-    Reverb reverb;
+    BuiltInSynthEnvelope envelope;
 
-    double getNoteInHertz(int noteNumber, double frequencyOfA = 440.0) noexcept
+    void renderOscillator(float *destination, int numSamples) noexcept
     {
-        return frequencyOfA * std::pow(periodRange,
-            (noteNumber - this->middleC) / double(this->periodSize));
-    }
+        const auto *table = BuiltInSynthSineTable::getInstance().values;
+        const auto tableSize = double(BuiltInSynthSineTable::size);
 
-    int getCurrentChannel() const noexcept
-    {
-        // the only way to access channel info in SynthesizerVoice :(
-        for (int i = 1; i < Globals::numChannels; ++i)
+        for (int i = 0; i < numSamples; ++i)
         {
-            if (this->isPlayingChannel(i))
+            const auto position = this->phase * tableSize;
+            const auto index = int(position);
+            const auto fraction = float(position - double(index));
+            destination[i] = table[index] + fraction * (table[index + 1] - table[index]);
+
+            this->phase += this->phaseDelta;
+            if (this->phase >= 1.0)
             {
-                return i;
+                this->phase -= 1.0;
             }
         }
+    }
 
-        jassertfalse;
-        return 1;
+    double getNoteInHertz(int noteNumber, double frequencyOfA = 440.0) noexcept
+    {
+        return frequencyOfA * std::pow(periodRange,
+            (noteNumber - this->middleC) / double(this->periodSize));
     }
+
+    // the synth's bookkeeping, see BuiltInSynth::noteOn
+    int index = 0;
+    int olderVoice = -1;
+    int newerVoice = -1;
+    bool isFree = true;
+
+    friend class BuiltInSynth;
 };
 
 BuiltInSynth::BuiltInSynth()
 {
-    for (int i = BuiltInSynth::numVoices; --i >= 0;)
-    {
-        this->addVoice(new BuiltInSynthVoice());
-    }
-
     this->addSound(new BuiltInSynthSound());
+
+    Reverb::Parameters rp;
+    rp.roomSize = 0.0f;
+    rp.damping = 0.0f;
+    rp.wetLevel = 0.23f;
+    rp.dryLevel = 0.73f;
+    rp.width = 0.0f;
+    rp.freezeMode = 0.4f;
+    this->reverb.setParameters(rp);
+
+    this->bus.setSize(1, BuiltInSynth::maxBusBlockSize);
+
+    this->voicesByKey.allocate(Globals::numChannels * BuiltInSynth::numKeysPerChannel, false);
+    this->setPolyphony(BuiltInSynth::defaultPolyphony);
 }
 
 void BuiltInSynth::setPeriodSizeAndRange(int periodSize, double periodRange)
 {
     //DBG("Setting octave size for the default synth: " + String(periodSize));
+    const ScopedLock sl(this->lock);
+
+    this->periodSize = periodSize;
+    this->periodRange = periodRange;
+
     for (int i = 0; i < this->getNumVoices(); ++i)
     {
-        if (auto *voice = dynamic_cast<BuiltInSynthVoice *>(this->getVoice(i)))
+        auto *voice = this->getBuiltInVoice(i);
+        voice->setPeriodSize(periodSize);
+        voice->setPeriodRange(periodRange);
+    }
+
+    this->resetVoices();
+}
+
+//===----------------------------------------------------------------------===//
+// Polyphony
+//===----------------------------------------------------------------------===//
+
+void BuiltInSynth::setPolyphony(int numVoices)
+{
+    numVoices = jlimit(1, BuiltInSynth::maxPolyphony, numVoices);
+
+    const ScopedLock sl(this->lock);
+
+    if (numVoices == this->getNumVoices())
+    {
+        return;
+    }
+
+    this->voices.removeLast(jmax(0, this->getNumVoices() - numVoices));
+
+    while (this->getNumVoices() < numVoices)
+    {
+        auto *voice = new BuiltInSynthVoice();
+        voice->setPeriodSize(this->periodSize);
+        voice->setPeriodRange(this->periodRange);
+        this->addVoice(voice); // also sets the sample rate
+    }
+
+    this->freeVoices.allocate(numVoices, false);
+    this->resetVoices();
+}
+
+int BuiltInSynth::getPolyphony() const noexcept
+{
+    return this->getNumVoices();
+}
+
+void BuiltInSynth::setVoiceStealing(VoiceStealing policy) noexcept
+{
+    this->voiceStealing = policy;
+}
+
+BuiltInSynth::VoiceStealing BuiltInSynth::getVoiceStealing() const noexcept
+{
+    return this->voiceStealing;
+}
+
+void BuiltInSynth::noteOn(int midiChannel, int midiNoteNumber, float velocity)
+{
+    if (midiChannel <= 0 || midiChannel > Globals::numChannels ||
+        midiNoteNumber < 0 || midiNoteNumber >= BuiltInSynth::numKeysPerChannel)
+    {
+        jassertfalse;
+        return;
+    }
+
+    const ScopedLock sl(this->lock);
+
+    auto *sound = this->sounds.getFirst().get();
+    if (sound == nullptr || this->getNumVoices() == 0)
+    {
+        return;
+    }
+
+    // re-triggering a key that is still playing releases the previous voice,
+    // which keeps fading out while the new one starts
+    if (auto *previousVoice = this->findVoiceForKey(midiChannel, midiNoteNumber))
+    {
+        previousVoice->stopNote(1.f, true);
+    }
+
+    auto *voice = this->takeVoiceToStart();
+    voice->setCurrentChannel(midiChannel);
+    this->startVoice(voice, sound, midiChannel, midiNoteNumber, velocity);
+    this->linkAsNewest(voice);
+
+    this->voicesByKey[(midiChannel - 1) * BuiltInSynth::numKeysPerChannel + midiNoteNumber] = voice->index;
+}
+
+void BuiltInSynth::noteOff(int midiChannel, int midiNoteNumber, float velocity, bool allowTailOff)
+{
+    const ScopedLock sl(this->lock);
+
+    // no pedals here, see handleSustainPedal,
+    // so the voice can be stopped straight away
+    if (auto *voice = this->findVoiceForKey(midiChannel, midiNoteNumber))
+    {
+        voice->stopNote(velocity, allowTailOff);
+    }
+}
+
+BuiltInSynthVoice *BuiltInSynth::getBuiltInVoice(int index) const noexcept
+{
+    return static_cast<BuiltInSynthVoice *>(this->voices.getUnchecked(index));
+}
+
+BuiltInSynthVoice *BuiltInSynth::findVoiceForKey(int midiChannel, int midiNoteNumber) const noexcept
+{
+    if (midiChannel <= 0 || midiChannel > Globals::numChannels ||
+        midiNoteNumber < 0 || midiNoteNumber >= BuiltInSynth::numKeysPerChannel)
+    {
+        return nullptr;
+    }
+
+    const auto index = this->voicesByKey[(midiChannel - 1) * BuiltInSynth::numKeysPerChannel + midiNoteNumber];
+    if (index < 0 || index >= this->getNumVoices())
+    {
+        return nullptr;
+    }
+
+    // the table is never cleaned up, so the entry might be stale
+    auto *voice = this->getBuiltInVoice(index);
+    if (voice->isFree || voice->getCurrentlyPlayingNote() != midiNoteNumber ||
+        !voice->isPlayingChannel(midiChannel))
+    {
+        return nullptr;
+    }
+
+    return voice;
+}
+
+BuiltInSynthVoice *BuiltInSynth::takeVoiceToStart() noexcept
+{
+    if (this->numFreeVoices > 0)
+    {
+        auto *voice = this->getBuiltInVoice(this->freeVoices[--this->numFreeVoices]);
+        jassert(voice->isFree && !voice->isVoiceActive());
+        voice->isFree = false;
+        return voice;
+    }
+
+    auto *voice = this->findVoiceToSteal();
+    jassert(voice != nullptr && !voice->isFree);
+    this->unlink(voice);
+    voice->stopNote(0.f, false);
+    return voice;
+}
+
+BuiltInSynthVoice *BuiltInSynth::findVoiceToSteal() const noexcept
+{
+    if (this->voiceStealing == VoiceStealing::Oldest)
+    {
+        return this->getBuiltInVoice(this->oldestVoice);
+    }
+
+    // only happens when all voices are busy, and there're never too many of them
+    BuiltInSynthVoice *quietestVoice = nullptr;
+    auto quietestLevel = std::numeric_limits<float>::max();
+    for (auto i = this->oldestVoice; i >= 0;)
+    {
+        auto *voice = this->getBuiltInVoice(i);
+        const auto level = voice->getCurrentLevel();
+        if (level < quietestLevel)
+        {
+            quietestLevel = level;
+            quietestVoice = voice;
+        }
+
+        i = voice->newerVoice;
+    }
+
+    return quietestVoice;
+}
+
+void BuiltInSynth::linkAsNewest(BuiltInSynthVoice *voice) noexcept
+{
+    voice->olderVoice = this->newestVoice;
+    voice->newerVoice = -1;
+
+    if (this->newestVoice >= 0)
+    {
+        this->getBuiltInVoice(this->newestVoice)->newerVoice = voice->index;
+    }
+    else
+    {
+        this->oldestVoice = voice->index;
+    }
+
+    this->newestVoice = voice->index;
+}
+
+void BuiltInSynth::unlink(BuiltInSynthVoice *voice) noexcept
+{
+    if (voice->olderVoice >= 0)
+    {
+        this->getBuiltInVoice(voice->olderVoice)->newerVoice = voice->newerVoice;
+    }
+    else
+    {
+        this->oldestVoice = voice->newerVoice;
+    }
+
+    if (voice->newerVoice >= 0)
+    {
+        this->getBuiltInVoice(voice->newerVoice)->olderVoice = voice->olderVoice;
+    }
+    else
+    {
+        this->newestVoice = voice->olderVoice;
+    }
+
+    voice->olderVoice = -1;
+    voice->newerVoice = -1;
+}
+
+void BuiltInSynth::releaseVoice(BuiltInSynthVoice *voice) noexcept
+{
+    jassert(!voice->isFree);
+    this->unlink(voice);
+    voice->isFree = true;
+    this->freeVoices[this->numFreeVoices++] = voice->index;
+}
+
+// stops everything and puts all voices into the free stack
+void BuiltInSynth::resetVoices()
+{
+    const ScopedLock sl(this->lock);
+
+    this->numFreeVoices = 0;
+    this->oldestVoice = -1;
+    this->newestVoice = -1;
+
+    // pushing in the reverse order, so that the first voice gets popped first
+    for (int i = this->getNumVoices(); --i >= 0;)
+    {
+        auto *voice = this->getBuiltInVoice(i);
+        voice->stopNote(1.f, false);
+        voice->index = i;
+        voice->olderVoice = -1;
+        voice->newerVoice = -1;
+        voice->isFree = true;
+        this->freeVoices[this->numFreeVoices++] = i;
+    }
+
+    for (int i = Globals::numChannels * BuiltInSynth::numKeysPerChannel; --i >= 0;)
+    {
+        this->voicesByKey[i] = -1;
+    }
+
+    this->reverb.reset();
+}
+
+//===----------------------------------------------------------------------===//
+// Rendering
+//===----------------------------------------------------------------------===//
+
+void BuiltInSynth::setCurrentPlaybackSampleRate(double sampleRate)
+{
+    Synthesiser::setCurrentPlaybackSampleRate(sampleRate);
+
+    if (sampleRate > 0)
+    {
+        this->reverb.setSampleRate(sampleRate);
+        this->reverbTailSamplesLeft = 0;
+    }
+}
+
+// The voices are mono and the reverb is linear, so instead of running
+// a reverb per voice, all voices are mixed into a mono bus first,
+// which is then processed once and added to all output channels
+void BuiltInSynth::renderVoices(AudioBuffer<float> &outputAudio, int startSample, int numSamples)
+{
+    const auto maxTailSamples = int(this->getSampleRate() * BuiltInSynth::reverbTailSeconds);
+
+    while (numSamples > 0)
+    {
+        const auto num = jmin(numSamples, BuiltInSynth::maxBusBlockSize);
+
+        bool hasActiveVoices = false;
+        this->bus.clear(0, num);
+        for (int i = 0; i < this->getNumVoices(); ++i)
         {
-            voice->stopNote(1.f, false);
-            voice->setPeriodSize(periodSize);
-            voice->setPeriodRange(periodRange);
+            auto *voice = this->getBuiltInVoice(i);
+            if (voice->isVoiceActive())
+            {
+                voice->renderNextBlock(this->bus, 0, num);
+                hasActiveVoices = true;
+            }
+
+            // the voice has finished its release or has been stopped
+            if (!voice->isFree && !voice->isVoiceActive())
+            {
+                this->releaseVoice(voice);
+            }
         }
+
+        // skip the bus entirely when nothing has been played for a while
+        this->reverbTailSamplesLeft = hasActiveVoices ?
+            maxTailSamples : jmax(0, this->reverbTailSamplesLeft - num);
+
+        if (this->reverbTailSamplesLeft > 0)
+        {
+            auto *busData = this->bus.getWritePointer(0);
+            this->reverb.processMono(busData, num);
+
+            for (int i = outputAudio.getNumChannels(); --i >= 0;)
+            {
+                FloatVectorOperations::add(outputAudio.getWritePointer(i, startSample), busData, num);
+            }
+        }
+
+        startSample += num;
+        numSamples -= num;
     }
 }
 
@@ -196,3 +741,159 @@ void BuiltInSynth::handleSustainPedal(int midiChannel, bool isDown) {}
 // seriously, just want to make sure that once I send a note-off event,
 // the BuiltInSynthVoice shuts the fuck up regardless of controller states
 void BuiltInSynth::handleSostenutoPedal(int midiChannel, bool isDown) {}
+
+//===----------------------------------------------------------------------===//
+// Tests
+//===----------------------------------------------------------------------===//
+
+#if JUCE_UNIT_TESTS
+
+class BuiltInSynthTests final : public UnitTest
+{
+public:
+    BuiltInSynthTests() : UnitTest("Built-in synth tests", UnitTestCategories::helio) {}
+
+    void runTest() override
+    {
+        static constexpr auto sampleRate = 44100.0;
+        static constexpr auto blockSize = 512;
+
+        beginTest("Voices are released after the tail-off");
+
+        {
+            BuiltInSynth synth;
+            synth.setCurrentPlaybackSampleRate(sampleRate);
+
+            AudioBuffer<float> buffer(2, blockSize);
+            MidiBuffer midi;
+
+            synth.noteOn(1, 60, 1.f);
+            synth.noteOn(1, 64, 1.f);
+
+            buffer.clear();
+            synth.renderNextBlock(buffer, midi, 0, blockSize);
+            expect(buffer.getMagnitude(0, 0, blockSize) > 0.f);
+            expectEquals(buffer.getMagnitude(0, 0, blockSize), buffer.getMagnitude(1, 0, blockSize));
+            expectEquals(this->countActiveVoices(synth), 2);
+
+            synth.allNotesOff(0, true);
+            for (int i = 0; i < int(sampleRate) / blockSize; ++i)
+            {
+                buffer.clear();
+                synth.renderNextBlock(buffer, midi, 0, blockSize);
+            }
+
+            expectEquals(this->countActiveVoices(synth), 0);
+        }
+
+        beginTest("Voice stealing");
+
+        {
+            BuiltInSynth synth;
+            synth.setPolyphony(2);
+            synth.setCurrentPlaybackSampleRate(sampleRate);
+            expectEquals(synth.getPolyphony(), 2);
+
+            AudioBuffer<float> buffer(2, blockSize);
+            MidiBuffer midi;
+
+            // the oldest note gets cut off
+            synth.noteOn(16, 60, 1.f);
+            synth.noteOn(2, 62, 0.1f);
+            synth.noteOn(3, 64, 1.f);
+            expect(this->isPlaying(synth, 2, 62));
+            expect(this->isPlaying(synth, 3, 64));
+            expect(!this->isPlaying(synth, 16, 60));
+
+            synth.allNotesOff(0, false);
+            synth.renderNextBlock(buffer, midi, 0, blockSize);
+            expectEquals(this->countActiveVoices(synth), 0);
+
+            // the quietest note gets cut off
+            synth.setVoiceStealing(BuiltInSynth::VoiceStealing::Quietest);
+            synth.noteOn(1, 60, 1.f);
+            synth.noteOn(1, 62, 0.1f);
+            synth.renderNextBlock(buffer, midi, 0, blockSize);
+            synth.noteOn(1, 64, 1.f);
+            expect(this->isPlaying(synth, 1, 60));
+            expect(this->isPlaying(synth, 1, 64));
+            expect(!this->isPlaying(synth, 1, 62));
+
+            // note-offs find their voices
+            synth.noteOff(1, 60, 1.f, false);
+            synth.noteOff(1, 64, 1.f, false);
+            expectEquals(this->countActiveVoices(synth), 0);
+
+            synth.setPolyphony(BuiltInSynth::maxPolyphony * 2);
+            expectEquals(synth.getPolyphony(), BuiltInSynth::maxPolyphony);
+        }
+
+        beginTest("Realtime factor");
+
+        for (const auto numVoices : { 16, 64, 128 })
+        {
+            BuiltInSynth synth;
+            synth.setPolyphony(numVoices);
+            synth.setCurrentPlaybackSampleRate(sampleRate);
+
+            for (int i = 0; i < numVoices; ++i)
+            {
+                synth.noteOn(1 + (i % 16), 40 + (i / 16) * 5, 0.75f);
+            }
+
+            AudioBuffer<float> buffer(2, blockSize);
+            MidiBuffer midi;
+
+            static constexpr auto numSeconds = 10;
+            const auto numBlocks = int(sampleRate) * numSeconds / blockSize;
+
+            const auto startMs = Time::getMillisecondCounterHiRes();
+            for (int i = 0; i < numBlocks; ++i)
+            {
+                buffer.clear();
+                synth.renderNextBlock(buffer, midi, 0, blockSize);
+            }
+            const auto renderMs = Time::getMillisecondCounterHiRes() - startMs;
+
+            expectEquals(this->countActiveVoices(synth), numVoices);
+
+            const auto audioMs = double(numBlocks * blockSize) * 1000.0 / sampleRate;
+            logMessage(String(numVoices) + " voices: rendered " + String(audioMs / 1000.0, 1) +
+                " s in " + String(renderMs, 1) + " ms, realtime factor " +
+                String(audioMs / jmax(0.001, renderMs), 1) + "x");
+        }
+    }
+
+private:
+
+    static int countActiveVoices(BuiltInSynth &synth)
+    {
+        int result = 0;
+        for (int i = 0; i < synth.getNumVoices(); ++i)
+        {
+            result += synth.getVoice(i)->isVoiceActive() ? 1 : 0;
+        }
+
+        return result;
+    }
+
+    static bool isPlaying(BuiltInSynth &synth, int midiChannel, int midiNoteNumber)
+    {
+        for (int i = 0; i < synth.getNumVoices(); ++i)
+        {
+            auto *voice = synth.getVoice(i);
+            if (voice->isVoiceActive() &&
+                voice->isPlayingChannel(midiChannel) &&
+                voice->getCurrentlyPlayingNote() == midiNoteNumber)
+            {
+                return true;
+            }
+        }
+
+        return false;
+    }
+};
+
+static BuiltInSynthTests builtInSynthTests;
+
+#endif
@@ -17,6 +17,8 @@
 
 #pragma once
 
+class BuiltInSynthVoice;
+
 class BuiltInSynth final : public Synthesiser
 {
 public:
@@ -35,12 +37,82 @@ public:
     // a better approach, or just get rid of this hack;
     void setPeriodSizeAndRange(int periodSize, double periodRange);
 
+    //===------------------------------------------------------------------===//
+    // Polyphony
+    //===------------------------------------------------------------------===//
+
+    // which voice gets cut off when all of them are busy
+    enum class VoiceStealing : int8
+    {
+        Oldest,
+        Quietest
+    };
+
+    // the voices are owned and managed by the synth,
+    // so don't add or remove them with addVoice/removeVoice,
+    // changing the polyphony stops all voices
+    void setPolyphony(int numVoices);
+    int getPolyphony() const noexcept;
+
+    void setVoiceStealing(VoiceStealing policy) noexcept;
+    VoiceStealing getVoiceStealing() const noexcept;
+
+    static constexpr auto defaultPolyphony = 16;
+    static constexpr auto maxPolyphony = 256;
+
+    //===------------------------------------------------------------------===//
+    // Synthesiser
+    //===------------------------------------------------------------------===//
+
+    void noteOn(int midiChannel, int midiNoteNumber, float velocity) override;
+    void noteOff(int midiChannel, int midiNoteNumber, float velocity, bool allowTailOff) override;
+
+    void setCurrentPlaybackSampleRate(double sampleRate) override;
+
 protected:
 
+    void renderVoices(AudioBuffer<float> &outputAudio, int startSample, int numSamples) override;
+    using Synthesiser::renderVoices;
+
     void handleSustainPedal(int midiChannel, bool isDown) override;
     void handleSostenutoPedal(int midiChannel, bool isDown) override;
 
-    static constexpr auto numVoices = 16;
+private:
+
+    // the reverb shared by all voices, see renderVoices()
+    Reverb reverb;
+    AudioBuffer<float> bus;
+    int reverbTailSamplesLeft = 0;
+
+    static constexpr auto maxBusBlockSize = 512;
+    static constexpr auto reverbTailSeconds = 3.0;
+
+    int periodSize = Globals::twelveTonePeriodSize;
+    double periodRange = 2.0;
+
+    // all voices are either in the free stack or in the list of active
+    // voices ordered by their start time, so that both finding a free voice
+    // and stealing the oldest one are O(1), and the last voice started
+    // for each channel/key pair is kept in a table, so that note-ons
+    // and note-offs don't need to look through all the voices
+    HeapBlock<int> freeVoices;
+    int numFreeVoices = 0;
+    int oldestVoice = -1;
+    int newestVoice = -1;
+    HeapBlock<int> voicesByKey;
+    VoiceStealing voiceStealing = VoiceStealing::Oldest;
+
+    static constexpr auto numKeysPerChannel = 128;
+
+    BuiltInSynthVoice *getBuiltInVoice(int index) const noexcept;
+    BuiltInSynthVoice *findVoiceForKey(int midiChannel, int midiNoteNumber) const noexcept;
+    BuiltInSynthVoice *takeVoiceToStart() noexcept;
+    BuiltInSynthVoice *findVoiceToSteal() const noexcept;
+
+    void linkAsNewest(BuiltInSynthVoice *voice) noexcept;
+    void unlink(BuiltInSynthVoice *voice) noexcept;
+    void releaseVoice(BuiltInSynthVoice *voice) noexcept;
+    void resetVoices();
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(BuiltInSynth)
 };
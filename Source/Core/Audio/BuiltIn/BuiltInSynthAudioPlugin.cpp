@@ -18,6 +18,7 @@
 #include "Common.h"
 #include "BuiltInSynthAudioPlugin.h"
 #include "BuiltInSynthFormat.h"
+#include "SerializationKeys.h"
 
 const String BuiltInSynthAudioPlugin::instrumentId = "<default>";
 const String BuiltInSynthAudioPlugin::instrumentName = "Helio Default";
@@ -29,6 +30,26 @@ BuiltInSynthAudioPlugin::BuiltInSynthAudioPlugin()
         this->getSampleRate(), this->getBlockSize());
 }
 
+void BuiltInSynthAudioPlugin::setPolyphony(int numVoices)
+{
+    this->synth.setPolyphony(numVoices);
+}
+
+int BuiltInSynthAudioPlugin::getPolyphony() const noexcept
+{
+    return this->synth.getPolyphony();
+}
+
+void BuiltInSynthAudioPlugin::setVoiceStealing(BuiltInSynth::VoiceStealing policy) noexcept
+{
+    this->synth.setVoiceStealing(policy);
+}
+
+BuiltInSynth::VoiceStealing BuiltInSynthAudioPlugin::getVoiceStealing() const noexcept
+{
+    return this->synth.getVoiceStealing();
+}
+
 void BuiltInSynthAudioPlugin::fillInPluginDescription(PluginDescription &description) const
 {
     description.name = this->getName();
@@ -111,5 +132,40 @@ const String BuiltInSynthAudioPlugin::getProgramName(int index)
 
 void BuiltInSynthAudioPlugin::changeProgramName(int index, const String &newName) {}
 
-void BuiltInSynthAudioPlugin::getStateInformation(MemoryBlock &destData) {}
-void BuiltInSynthAudioPlugin::setStateInformation(const void *data, int sizeInBytes) {}
+void BuiltInSynthAudioPlugin::getStateInformation(MemoryBlock &destData)
+{
+    using namespace Serialization;
+
+    SerializedData tree(Audio::builtInSynth);
+    tree.setProperty(Audio::builtInSynthPolyphony, this->synth.getPolyphony());
+    tree.setProperty(Audio::builtInSynthVoiceStealing, int(this->synth.getVoiceStealing()));
+
+    MemoryOutputStream out(destData, false);
+    tree.writeToStream(out);
+}
+
+void BuiltInSynthAudioPlugin::setStateInformation(const void *data, int sizeInBytes)
+{
+    using namespace Serialization;
+
+    // older projects have no state saved for the built-in synth
+    if (data == nullptr || sizeInBytes <= 0)
+    {
+        return;
+    }
+
+    const auto tree = SerializedData::readFromData(data, size_t(sizeInBytes));
+    if (!tree.hasType(Audio::builtInSynth))
+    {
+        return;
+    }
+
+    this->synth.setPolyphony(tree.getProperty(Audio::builtInSynthPolyphony,
+        BuiltInSynth::defaultPolyphony));
+
+    const int voiceStealing = tree.getProperty(Audio::builtInSynthVoiceStealing,
+        int(BuiltInSynth::VoiceStealing::Oldest));
+
+    this->synth.setVoiceStealing(voiceStealing == int(BuiltInSynth::VoiceStealing::Quietest) ?
+        BuiltInSynth::VoiceStealing::Quietest : BuiltInSynth::VoiceStealing::Oldest);
+}
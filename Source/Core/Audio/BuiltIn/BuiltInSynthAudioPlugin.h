@@ -34,6 +34,12 @@ public:
         this->synth.setPeriodSizeAndRange(periodSize, periodRange);
     }
 
+    // both are saved in the plugin state
+    void setPolyphony(int numVoices);
+    int getPolyphony() const noexcept;
+    void setVoiceStealing(BuiltInSynth::VoiceStealing policy) noexcept;
+    BuiltInSynth::VoiceStealing getVoiceStealing() const noexcept;
+
     //===------------------------------------------------------------------===//
     // AudioPluginInstance
     //===------------------------------------------------------------------===//
@@ -0,0 +1,140 @@
+/*
+    This file is part of Helio Workstation.
+
+    Helio is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Helio is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Helio. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "Common.h"
+#include "PluginScanCache.h"
+#include "SerializationKeys.h"
+#include "SerializablePluginDescription.h"
+
+bool PluginScanCache::findResults(const String &fileOrIdentifier,
+    Array<PluginDescription> &outResults) const
+{
+    const auto found = this->entries.find(fileOrIdentifier);
+    if (found == this->entries.end())
+    {
+        return false;
+    }
+
+    // not caching the identifiers which are not files,
+    // like the built-in instrument, so it must exist:
+    const File file(fileOrIdentifier);
+    if (!file.exists() ||
+        file.getLastModificationTime().toMilliseconds() != found->second.modificationTimeMs ||
+        file.getSize() != found->second.fileSize)
+    {
+        return false;
+    }
+
+    outResults.addArray(found->second.results);
+    return true;
+}
+
+void PluginScanCache::setResults(const String &fileOrIdentifier,
+    const Array<PluginDescription> &results)
+{
+    if (!File::isAbsolutePath(fileOrIdentifier))
+    {
+        return;
+    }
+
+    const File file(fileOrIdentifier);
+    if (!file.exists())
+    {
+        return;
+    }
+
+    Entry entry;
+    entry.modificationTimeMs = file.getLastModificationTime().toMilliseconds();
+    entry.fileSize = file.getSize();
+    entry.results = results;
+    this->entries[fileOrIdentifier] = entry;
+}
+
+int PluginScanCache::getNumFiles() const noexcept
+{
+    return int(this->entries.size());
+}
+
+//===----------------------------------------------------------------------===//
+// Serializable
+//===----------------------------------------------------------------------===//
+
+SerializedData PluginScanCache::serialize() const
+{
+    using namespace Serialization;
+    SerializedData tree(Audio::pluginScanCache);
+
+    for (const auto &it : this->entries)
+    {
+        SerializedData fileNode(Audio::pluginScanCacheFile);
+        fileNode.setProperty(Audio::pluginScanCachePath, it.first);
+        fileNode.setProperty(Audio::pluginScanCacheModTime, it.second.modificationTimeMs);
+        fileNode.setProperty(Audio::pluginScanCacheSize, it.second.fileSize);
+
+        for (const auto &description : it.second.results)
+        {
+            const SerializablePluginDescription pd(description);
+            fileNode.appendChild(pd.serialize());
+        }
+
+        tree.appendChild(fileNode);
+    }
+
+    return tree;
+}
+
+void PluginScanCache::deserialize(const SerializedData &data)
+{
+    using namespace Serialization;
+
+    this->reset();
+
+    const auto root = data.hasType(Audio::pluginScanCache) ?
+        data : data.getChildWithName(Audio::pluginScanCache);
+
+    if (!root.isValid()) { return; }
+
+    forEachChildWithType(root, fileNode, Audio::pluginScanCacheFile)
+    {
+        const String path = fileNode.getProperty(Audio::pluginScanCachePath);
+        if (path.isEmpty())
+        {
+            continue;
+        }
+
+        Entry entry;
+        entry.modificationTimeMs = fileNode.getProperty(Audio::pluginScanCacheModTime);
+        entry.fileSize = fileNode.getProperty(Audio::pluginScanCacheSize);
+
+        for (const auto &pluginNode : fileNode)
+        {
+            SerializablePluginDescription description;
+            description.deserialize(pluginNode);
+            if (description.isValid())
+            {
+                entry.results.add(description);
+            }
+        }
+
+        this->entries[path] = entry;
+    }
+}
+
+void PluginScanCache::reset()
+{
+    this->entries.clear();
+}
@@ -0,0 +1,60 @@
+/*
+    This file is part of Helio Workstation.
+
+    Helio is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Helio is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Helio. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+// Remembers the results of checking each plugin file, including the files
+// which turned out to be not plugins, or crashed or hung the checker,
+// so that rescans only have to check new files and the files which have
+// changed since then (i.e. have different modification time or size).
+
+class PluginScanCache final : public Serializable
+{
+public:
+
+    PluginScanCache() = default;
+
+    // returns false, if the file is unknown or has changed since it was checked
+    bool findResults(const String &fileOrIdentifier,
+        Array<PluginDescription> &outResults) const;
+
+    void setResults(const String &fileOrIdentifier,
+        const Array<PluginDescription> &results);
+
+    int getNumFiles() const noexcept;
+
+    //===------------------------------------------------------------------===//
+    // Serializable
+    //===------------------------------------------------------------------===//
+
+    SerializedData serialize() const override;
+    void deserialize(const SerializedData &data) override;
+    void reset() override;
+
+private:
+
+    struct Entry final
+    {
+        int64 modificationTimeMs = 0;
+        int64 fileSize = 0;
+        Array<PluginDescription> results;
+    };
+
+    FlatHashMap<String, Entry, StringHash> entries;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(PluginScanCache)
+};
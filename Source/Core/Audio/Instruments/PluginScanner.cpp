@@ -20,6 +20,7 @@
 #include "AudioCore.h"
 #include "DocumentHelpers.h"
 #include "XmlSerializer.h"
+#include "BinarySerializer.h"
 #include "Config.h"
 #include "MainLayout.h"
 #include "SerializationKeys.h"
@@ -174,6 +175,249 @@ void PluginScanner::scanFolderAndAddResults(const File &dir)
     this->signal();
 }
 
+//===----------------------------------------------------------------------===//
+// Checks
+//===----------------------------------------------------------------------===//
+
+#if SAFE_SCAN
+
+// Runs the app itself as a checker, see App::checkPlugin,
+// the file path is passed through the temp file, which the checker
+// deletes right away, and then writes the results into it, if any
+class PluginCheckerProcess final : public PluginScanner::Check
+{
+public:
+
+    PluginCheckerProcess(const String &checkerPath, const String &fileOrIdentifier) :
+        tempFile(DocumentHelpers::getTempSlot(this->tempFileName.toString()))
+    {
+        DBG("Safe scanning: " + fileOrIdentifier);
+        this->tempFile.replaceWithText(fileOrIdentifier, false, false);
+        this->hasStarted = this->process.start(checkerPath + " " + this->tempFileName.toString());
+    }
+
+    ~PluginCheckerProcess() override
+    {
+        this->tempFile.deleteFile();
+    }
+
+    bool isRunning() override
+    {
+        return this->process.isRunning();
+    }
+
+    bool hasFailedToStart() override
+    {
+        return !this->hasStarted;
+    }
+
+    void kill() override
+    {
+        this->process.kill();
+    }
+
+    Array<PluginDescription> getResults() override
+    {
+        Array<PluginDescription> results;
+
+        if (this->tempFile.existsAsFile())
+        {
+            try
+            {
+                const auto tree(DocumentHelpers::load<XmlSerializer>(this->tempFile));
+                forEachChildWithType(tree, e, Serialization::Audio::plugin)
+                {
+                    SerializablePluginDescription pluginDescription;
+                    pluginDescription.deserialize(e);
+                    results.add(pluginDescription);
+                }
+            }
+            catch (...) {}
+        }
+
+        return results;
+    }
+
+private:
+
+    const Uuid tempFileName;
+    const File tempFile;
+    ChildProcess process;
+    bool hasStarted = false;
+};
+
+#else
+
+// On mobile platforms, plugins are checked in-process, one at a time
+class InProcessPluginCheck final : public PluginScanner::Check
+{
+public:
+
+    InProcessPluginCheck(AudioPluginFormatManager &formatManager, const String &fileOrIdentifier)
+    {
+        DBG("Unsafe scanning: " + fileOrIdentifier);
+
+        KnownPluginList knownPluginList;
+        OwnedArray<PluginDescription> typesFound;
+
+        try
+        {
+            for (int i = 0; i < formatManager.getNumFormats(); ++i)
+            {
+                auto *format = formatManager.getFormat(i);
+                knownPluginList.scanAndAddFile(fileOrIdentifier, false, typesFound, *format);
+            }
+        }
+        catch (...) {}
+
+        // at this point we are still alive and plugin haven't crashed the app
+        for (const auto *type : typesFound)
+        {
+            this->results.add(*type);
+        }
+    }
+
+    bool isRunning() override { return false; }
+    void kill() override {}
+    Array<PluginDescription> getResults() override { return this->results; }
+
+private:
+
+    Array<PluginDescription> results;
+};
+
+#endif
+
+PluginScanner::ScanStats PluginScanner::checkFiles(const StringArray &files,
+    PluginScanCache &cache, const CheckFactory &createCheck,
+    int maxConcurrentChecks, int timeoutMs,
+    const Function<bool()> &shouldCancel,
+    const Function<void(const Array<PluginDescription> &)> &onResults)
+{
+    struct RunningCheck final
+    {
+        String fileOrIdentifier;
+        UniquePointer<Check> check;
+        double startTimeMs = 0.0;
+    };
+
+    static constexpr auto pollIntervalMs = 5;
+
+    ScanStats stats;
+    stats.numFiles = files.size();
+
+    const auto scanStartMs = Time::getMillisecondCounterHiRes();
+
+    OwnedArray<RunningCheck> runningChecks;
+    int nextFileIndex = 0;
+
+    while (true)
+    {
+        if (shouldCancel())
+        {
+            DBG("Plugin scanning canceled");
+            for (auto *runningCheck : runningChecks)
+            {
+                runningCheck->check->kill();
+            }
+
+            break;
+        }
+
+        while (runningChecks.size() < maxConcurrentChecks && nextFileIndex < files.size())
+        {
+            const auto &fileOrIdentifier = files.getReference(nextFileIndex++);
+
+            Array<PluginDescription> cachedResults;
+            if (cache.findResults(fileOrIdentifier, cachedResults))
+            {
+                stats.numCachedFiles++;
+                stats.numPluginsFound += cachedResults.size();
+                if (!cachedResults.isEmpty())
+                {
+                    onResults(cachedResults);
+                }
+
+                continue;
+            }
+
+            auto *runningCheck = runningChecks.add(new RunningCheck());
+            runningCheck->fileOrIdentifier = fileOrIdentifier;
+            runningCheck->startTimeMs = Time::getMillisecondCounterHiRes();
+            runningCheck->check = createCheck(fileOrIdentifier);
+        }
+
+        if (runningChecks.isEmpty())
+        {
+            break;
+        }
+
+        bool hasFinishedChecks = false;
+        const auto nowMs = Time::getMillisecondCounterHiRes();
+
+        for (int i = runningChecks.size(); --i >= 0;)
+        {
+            auto *runningCheck = runningChecks.getUnchecked(i);
+            if (runningCheck->check->hasFailedToStart())
+            {
+                // not cached either, the file is to be checked again next time
+                DBG("Plugin check failed to start: " + runningCheck->fileOrIdentifier);
+                stats.numFailedChecks++;
+            }
+            else if (runningCheck->check->isRunning())
+            {
+                if (nowMs - runningCheck->startTimeMs < double(timeoutMs))
+                {
+                    continue;
+                }
+
+                // hung checks are not cached: maybe the system was just too busy
+                DBG("Plugin check timed out: " + runningCheck->fileOrIdentifier);
+                runningCheck->check->kill();
+                stats.numFailedChecks++;
+            }
+            else
+            {
+                const auto results = runningCheck->check->getResults();
+                cache.setResults(runningCheck->fileOrIdentifier, results);
+
+                if (results.isEmpty())
+                {
+                    stats.numFailedChecks++;
+                }
+                else
+                {
+                    stats.numPluginsFound += results.size();
+                    onResults(results);
+                }
+            }
+
+            stats.numCheckedFiles++;
+            runningChecks.remove(i);
+            hasFinishedChecks = true;
+        }
+
+        if (!hasFinishedChecks)
+        {
+            Thread::sleep(pollIntervalMs);
+        }
+    }
+
+    stats.elapsedMs = Time::getMillisecondCounterHiRes() - scanStartMs;
+    return stats;
+}
+
+PluginScanner::ScanStats PluginScanner::getLastScanStats() const noexcept
+{
+    const SpinLock::ScopedLockType lock(this->lastScanStatsLock);
+    return this->lastScanStats;
+}
+
+File PluginScanner::getScanCacheFile()
+{
+    return DocumentHelpers::getConfigSlot("plugins.cache");
+}
+
 //===----------------------------------------------------------------------===//
 // Thread
 //===----------------------------------------------------------------------===//
@@ -189,7 +433,30 @@ void PluginScanner::run()
 
     AudioPluginFormatManager formatManager;
     AudioCore::initAudioFormats(formatManager);
-    
+
+    const auto cacheFile = PluginScanner::getScanCacheFile();
+    if (cacheFile.existsAsFile())
+    {
+        this->scanCache.deserialize(DocumentHelpers::load<BinarySerializer>(cacheFile));
+    }
+
+#if SAFE_SCAN
+    const auto checkerPath(File::getSpecialLocation(File::currentExecutableFile).getFullPathName());
+    const auto numConcurrentChecks = jlimit(1,
+        PluginScanner::maxConcurrentChecks, SystemStats::getNumCpus() - 1);
+
+    const CheckFactory createCheck = [&checkerPath](const String &fileOrIdentifier)
+    {
+        return UniquePointer<Check>(new PluginCheckerProcess(checkerPath, fileOrIdentifier));
+    };
+#else
+    const auto numConcurrentChecks = 1;
+    const CheckFactory createCheck = [&formatManager](const String &fileOrIdentifier)
+    {
+        return UniquePointer<Check>(new InProcessPluginCheck(formatManager, fileOrIdentifier));
+    };
+#endif
+
     while (!this->threadShouldExit())
     {
         this->working = true;
@@ -210,100 +477,36 @@ void PluginScanner::run()
             }
         }
 
+        this->filesToScan.removeDuplicates(false);
+
         try
         {
-            const auto myPath(File::getSpecialLocation(File::currentExecutableFile).getFullPathName());
-
-            for (const auto &pluginPath : this->filesToScan)
-            {
-                if (this->cancelled.get())
+            const auto stats = PluginScanner::checkFiles(this->filesToScan,
+                this->scanCache, createCheck, numConcurrentChecks, PluginScanner::checkTimeoutMs,
+                [this]() { return this->cancelled.get() || this->threadShouldExit(); },
+                [this](const Array<PluginDescription> &results)
                 {
-                    DBG("Plugin scanning canceled");
-                    break;
-                }
-
-#if SAFE_SCAN
-                DBG("Safe scanning: " + pluginPath);
-
-                const Uuid tempFileName;
-                const File tempFile(DocumentHelpers::getTempSlot(tempFileName.toString()));
-                tempFile.appendText(pluginPath, false, false);
-
-                Thread::sleep(50);
-
-                ChildProcess checkerProcess;
-                const String commandLine(myPath + " " + tempFileName.toString());
-                checkerProcess.start(commandLine);
-
-                if (!checkerProcess.waitForProcessToFinish(60000))
-                {
-                    checkerProcess.kill();
-                }
-                else
-                {
-                    if (this->cancelled.get())
+                    for (const auto &description : results)
                     {
-                        DBG("Plugin scanning canceled");
-                        tempFile.deleteFile();
-                        break;
+                        this->pluginsList.addType(description);
                     }
 
-                    Thread::sleep(50);
-
-                    if (tempFile.existsAsFile())
-                    {
-                        try
-                        {
-                            const auto tree(DocumentHelpers::load<XmlSerializer>(tempFile));
-                            if (tree.isValid())
-                            {
-                                forEachChildWithType(tree, e, Serialization::Audio::plugin)
-                                {
-                                    SerializablePluginDescription pluginDescription;
-                                    pluginDescription.deserialize(e);
-                                    this->pluginsList.addType(pluginDescription);
-                                }
-                                    
-                                this->sendChangeMessage();
-                            }
-                        }
-                        catch (...) {}
-                    }
-                }
+                    this->sendChangeMessage();
+                });
 
-                tempFile.deleteFile();
-#else
-                DBG("Unsafe scanning: " + pluginPath);
+            DBG("Scanned " + String(stats.numFiles) + " files in " + String(stats.elapsedMs / 1000.0, 1) +
+                " s (" + String(stats.getFilesPerSecond(), 1) + " files/s): " +
+                String(stats.numCachedFiles) + " cached, " + String(stats.numCheckedFiles) + " checked with " +
+                String(numConcurrentChecks) + " concurrent checkers, " + String(stats.numFailedChecks) +
+                " failed, " + String(stats.numPluginsFound) + " plugins found");
 
-                KnownPluginList knownPluginList;
-                OwnedArray<PluginDescription> typesFound;
-                    
-                try
-                {
-                    for (int j = 0; j < formatManager.getNumFormats(); ++j)
-                    {
-                        AudioPluginFormat *format = formatManager.getFormat(j);
-                        knownPluginList.scanAndAddFile(pluginPath, false, typesFound, *format);
-                    }
-                }
-                catch (...) {}
-                    
-                // at this point we are still alive and plugin haven't crashed the app
-                if (typesFound.size() != 0)
-                {
-                    for (auto *type : typesFound)
-                    {
-                        this->pluginsList.addType(*type);
-                    }
-                }
-                    
-                this->sendChangeMessage();
-                Thread::sleep(150);
-#endif
-            }
+            const SpinLock::ScopedLockType lock(this->lastScanStatsLock);
+            this->lastScanStats = stats;
         }
         catch (...) {}
 
+        DocumentHelpers::save<BinarySerializer>(cacheFile, this->scanCache);
+
         {
             this->cancelled = false;
             this->working = false;
@@ -424,3 +627,166 @@ void PluginScanner::reset()
     this->pluginsList.clear();
     this->sendChangeMessage();
 }
+
+//===----------------------------------------------------------------------===//
+// Tests
+//===----------------------------------------------------------------------===//
+
+#if JUCE_UNIT_TESTS
+
+class PluginScannerTests final : public UnitTest
+{
+public:
+    PluginScannerTests() : UnitTest("Plugin scanner tests", UnitTestCategories::helio) {}
+
+    // pretends to be a checker process which takes a while to load a plugin,
+    // the files named "hang" never finish, "broken" are not plugins,
+    // and "unlaunchable" pretend the checker process couldn't start
+    class StubCheck final : public PluginScanner::Check
+    {
+    public:
+
+        StubCheck(const String &fileOrIdentifier, int durationMs) :
+            file(fileOrIdentifier),
+            finishTimeMs(Time::getMillisecondCounterHiRes() + durationMs) {}
+
+        bool isRunning() override
+        {
+            return !this->killed && (this->file.getFileNameWithoutExtension() == "hang" ||
+                Time::getMillisecondCounterHiRes() < this->finishTimeMs);
+        }
+
+        void kill() override
+        {
+            this->killed = true;
+        }
+
+        bool hasFailedToStart() override
+        {
+            return this->file.getFileNameWithoutExtension() == "unlaunchable";
+        }
+
+        Array<PluginDescription> getResults() override
+        {
+            if (this->killed || this->file.getFileNameWithoutExtension() == "broken")
+            {
+                return {};
+            }
+
+            PluginDescription description;
+            description.name = this->file.getFileNameWithoutExtension();
+            description.pluginFormatName = "Stub";
+            description.fileOrIdentifier = this->file.getFullPathName();
+            return { description };
+        }
+
+    private:
+
+        const File file;
+        const double finishTimeMs;
+        bool killed = false;
+    };
+
+    void runTest() override
+    {
+        static constexpr auto numPlugins = 32;
+        static constexpr auto checkDurationMs = 20;
+        static constexpr auto timeoutMs = 200;
+
+        const auto folder = File::getSpecialLocation(File::tempDirectory)
+            .getNonexistentChildFile("helio-plugin-scanner-test", {}, false);
+        folder.createDirectory();
+
+        StringArray files;
+        for (int i = 0; i < numPlugins; ++i)
+        {
+            const auto file = folder.getChildFile("plugin" + String(i) + ".dummy");
+            file.replaceWithText("dummy plugin " + String(i));
+            files.add(file.getFullPathName());
+        }
+
+        folder.getChildFile("hang.dummy").replaceWithText("hang");
+        folder.getChildFile("broken.dummy").replaceWithText("broken");
+        folder.getChildFile("unlaunchable.dummy").replaceWithText("unlaunchable");
+        files.add(folder.getChildFile("hang.dummy").getFullPathName());
+        files.add(folder.getChildFile("unlaunchable.dummy").getFullPathName());
+        files.add(folder.getChildFile("broken.dummy").getFullPathName());
+
+        int numChecksCreated = 0;
+        const PluginScanner::CheckFactory createCheck = [&numChecksCreated](const String &fileOrIdentifier)
+        {
+            numChecksCreated++;
+            return UniquePointer<PluginScanner::Check>(new StubCheck(fileOrIdentifier, checkDurationMs));
+        };
+
+        Array<PluginDescription> found;
+        const auto addResults = [&found](const Array<PluginDescription> &results)
+        {
+            found.addArray(results);
+        };
+
+        const auto neverCancel = []() { return false; };
+
+        PluginScanCache cache;
+
+        beginTest("Concurrent checks");
+
+        const auto firstScan = PluginScanner::checkFiles(files, cache,
+            createCheck, 8, timeoutMs, neverCancel, addResults);
+
+        expectEquals(numChecksCreated, files.size());
+        expectEquals(firstScan.numCheckedFiles, files.size());
+        expectEquals(firstScan.numCachedFiles, 0);
+        expectEquals(firstScan.numFailedChecks, 3);
+        expectEquals(firstScan.numPluginsFound, numPlugins);
+        expectEquals(found.size(), numPlugins);
+
+        // sequential checks would take at least numPlugins * checkDurationMs + timeoutMs
+        expect(firstScan.elapsedMs < double(numPlugins * checkDurationMs + timeoutMs));
+
+        logMessage("First scan: " + String(firstScan.getFilesPerSecond(), 1) + " files per second");
+
+        beginTest("Rescans only check the changed files");
+
+        numChecksCreated = 0;
+        found.clearQuick();
+
+        // the hung and the unlaunchable checks are not cached, and one file has changed
+        folder.getChildFile("plugin0.dummy").appendText("changed");
+
+        const auto secondScan = PluginScanner::checkFiles(files, cache,
+            createCheck, 8, timeoutMs, neverCancel, addResults);
+
+        expectEquals(numChecksCreated, 3);
+        expectEquals(secondScan.numCheckedFiles, 3);
+        expectEquals(secondScan.numCachedFiles, files.size() - 3);
+        expectEquals(secondScan.numPluginsFound, numPlugins);
+        expectEquals(found.size(), numPlugins);
+
+        logMessage("Second scan: " + String(secondScan.getFilesPerSecond(), 1) + " files per second");
+
+        beginTest("Scan cache serialization");
+
+        PluginScanCache restoredCache;
+        restoredCache.deserialize(cache.serialize());
+        expectEquals(restoredCache.getNumFiles(), cache.getNumFiles());
+
+        Array<PluginDescription> results;
+        expect(restoredCache.findResults(files[1], results));
+        expectEquals(results.size(), 1);
+        expectEquals(results.getFirst().name, String("plugin1"));
+
+        results.clearQuick();
+        expect(restoredCache.findResults(files[files.size() - 1], results));
+        expect(results.isEmpty());
+
+        expect(!restoredCache.findResults(files[files.size() - 2], results));
+        expect(!restoredCache.findResults(files[files.size() - 3], results));
+
+        folder.deleteRecursively();
+    }
+};
+
+static PluginScannerTests pluginScannerTests;
+
+#endif
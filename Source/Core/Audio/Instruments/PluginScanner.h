@@ -17,6 +17,8 @@
 
 #pragma once
 
+#include "PluginScanCache.h"
+
 class PluginScanner final :
     public Serializable,
     private Thread,
@@ -49,6 +51,56 @@ public:
     void scanFolderAndAddResults(const File &dir);
     void cancelRunningScan();
 
+    //===------------------------------------------------------------------===//
+    // Checks
+    //===------------------------------------------------------------------===//
+
+    // a check of a single file, which is normally done in a child process,
+    // so that the broken plugins can't crash the app
+    class Check
+    {
+    public:
+
+        virtual ~Check() = default;
+
+        virtual bool isRunning() = 0;
+        virtual void kill() = 0;
+
+        // the check couldn't even start, e.g. the checker process
+        // failed to launch, so its empty results say nothing about the file
+        virtual bool hasFailedToStart() { return false; }
+
+        // descriptions of all plugins found in the file, if any
+        virtual Array<PluginDescription> getResults() = 0;
+    };
+
+    using CheckFactory = Function<UniquePointer<Check>(const String &fileOrIdentifier)>;
+
+    struct ScanStats final
+    {
+        int numFiles = 0;
+        int numCachedFiles = 0;
+        int numCheckedFiles = 0;
+        int numFailedChecks = 0; // not plugins at all, crashed or hung
+        int numPluginsFound = 0;
+        double elapsedMs = 0.0;
+
+        double getFilesPerSecond() const noexcept
+        {
+            return this->elapsedMs > 0.0 ? double(this->numFiles) * 1000.0 / this->elapsedMs : 0.0;
+        }
+    };
+
+    // runs up to maxConcurrentChecks at once, skips the unchanged files known
+    // to the cache and updates it, then calls onResults for each file
+    // with plugins found, on the calling thread, as soon as they're known
+    static ScanStats checkFiles(const StringArray &files, PluginScanCache &cache,
+        const CheckFactory &createCheck, int maxConcurrentChecks, int timeoutMs,
+        const Function<bool()> &shouldCancel,
+        const Function<void(const Array<PluginDescription> &)> &onResults);
+
+    ScanStats getLastScanStats() const noexcept;
+
     //===------------------------------------------------------------------===//
     // Serializable
     //===------------------------------------------------------------------===//
@@ -74,6 +126,16 @@ private:
     FileSearchPath searchPath;
     StringArray filesToScan;
 
+    // only used by the search thread, stored in a separate file
+    PluginScanCache scanCache;
+    static File getScanCacheFile();
+
+    ScanStats lastScanStats;
+    SpinLock lastScanStatsLock;
+
+    static constexpr auto maxConcurrentChecks = 8;
+    static constexpr auto checkTimeoutMs = 60000;
+
     FileSearchPath getTypicalFolders();
     void scanPossibleSubfolders(const StringArray &possibleSubfolders,
         const File &currentSystemFolder, FileSearchPath &foldersOut);
@@ -59,12 +59,25 @@ private:
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(OversaturationWarningAsyncCallback)
 };
 
-AudioMonitor::AudioMonitor() : fft()
+AudioMonitor::AudioMonitor() :
+    Thread("AudioMonitor"),
+    fifo(AudioMonitor::fifoSize),
+    fft(AudioMonitor::fftOrder)
 {
+    for (auto &buffer : this->fifoBuffers)
+    {
+        buffer.allocate(AudioMonitor::fifoSize, true);
+    }
+
     this->asyncClippingWarning = make<ClippingWarningAsyncCallback>(*this);
     this->asyncOversaturationWarning = make<OversaturationWarningAsyncCallback>(*this);
 }
 
+AudioMonitor::~AudioMonitor()
+{
+    this->stopThread(1000);
+}
+
 //===----------------------------------------------------------------------===//
 // AudioIODeviceCallback
 //===----------------------------------------------------------------------===//
@@ -72,40 +85,144 @@ AudioMonitor::AudioMonitor() : fft()
 void AudioMonitor::audioDeviceAboutToStart(AudioIODevice *device)
 {
     this->sampleRate = device->getCurrentSampleRate();
+    this->startThread(3);
+}
+
+void AudioMonitor::audioDeviceStopped()
+{
+    this->stopThread(1000);
 }
 
 void AudioMonitor::audioDeviceIOCallback(const float **inputChannelData, int numInputChannels,
     float **outputChannelData, int numOutputChannels, int numSamples)
 {
-    const int minNumChannels = jmin(AudioMonitor::numChannels, numOutputChannels);
-    
-    for (int channel = 0; channel < minNumChannels; ++channel)
+    // whatever doesn't fit is dropped, the audio thread never waits
+    int start1, size1, start2, size2;
+    this->fifo.prepareToWrite(numSamples, start1, size1, start2, size2);
+
+    for (int channel = 0; channel < AudioMonitor::numChannels; ++channel)
     {
-        this->fft.computeSpectrum(outputChannelData[channel], 0, numSamples,
-            this->spectrum[channel], AudioMonitor::spectrumSize,
-            channel, numOutputChannels);
+        auto *buffer = this->fifoBuffers[channel].get();
+
+        if (channel < numOutputChannels)
+        {
+            FloatVectorOperations::copy(buffer + start1, outputChannelData[channel], size1);
+            FloatVectorOperations::copy(buffer + start2, outputChannelData[channel] + size1, size2);
+        }
+        else
+        {
+            FloatVectorOperations::clear(buffer + start1, size1);
+            FloatVectorOperations::clear(buffer + start2, size2);
+        }
     }
-    
-    for (int channel = 0; channel < minNumChannels; ++channel)
+
+    this->fifo.finishedWrite(size1 + size2);
+
+    for (int i = 0; i < numOutputChannels; ++i)
     {
-        float pcmSquaresSum = 0.f;
-        float pcmPeak = 0.f;
-        for (int samplePosition = 0; samplePosition < numSamples; ++samplePosition)
+        FloatVectorOperations::clear(outputChannelData[i], numSamples);
+    }
+}
+
+//===----------------------------------------------------------------------===//
+// Thread
+//===----------------------------------------------------------------------===//
+
+void AudioMonitor::run()
+{
+    int numIdleCycles = 0;
+
+    while (!this->threadShouldExit())
+    {
+        this->wait(numIdleCycles < AudioMonitor::numCyclesBeforeIdle ?
+            AudioMonitor::analysisIntervalMs : AudioMonitor::idleIntervalMs);
+
+        numIdleCycles = this->analyzeAvailableSamples() ? 0 : (numIdleCycles + 1);
+    }
+}
+
+// several independent accumulators let the compiler vectorize the loop
+// (FloatVectorOperations don't have a sum of squares, unfortunately):
+static inline float getSumOfSquares(const float *samples, int numSamples) noexcept
+{
+    float sum0 = 0.f, sum1 = 0.f, sum2 = 0.f, sum3 = 0.f;
+
+    int i = 0;
+    for (; i + 3 < numSamples; i += 4)
+    {
+        sum0 += samples[i] * samples[i];
+        sum1 += samples[i + 1] * samples[i + 1];
+        sum2 += samples[i + 2] * samples[i + 2];
+        sum3 += samples[i + 3] * samples[i + 3];
+    }
+
+    for (; i < numSamples; ++i)
+    {
+        sum0 += samples[i] * samples[i];
+    }
+
+    return (sum0 + sum1) + (sum2 + sum3);
+}
+
+bool AudioMonitor::analyzeAvailableSamples()
+{
+    int start1, size1, start2, size2;
+    this->fifo.prepareToRead(this->fifo.getNumReady(), start1, size1, start2, size2);
+
+    const int numSamples = size1 + size2;
+    if (numSamples == 0)
+    {
+        return false;
+    }
+
+    for (int channel = 0; channel < AudioMonitor::numChannels; ++channel)
+    {
+        this->chunkPeak[channel] = 0.f;
+        this->chunkSquaresSum[channel] = 0.0;
+    }
+
+    this->chunkSize = 0;
+    this->analyzeChunk(start1, size1);
+    this->analyzeChunk(start2, size2);
+    this->fifo.finishedRead(numSamples);
+
+    const bool isSilent = std::all_of(std::begin(this->chunkPeak),
+        std::end(this->chunkPeak), [](float p) { return p == 0.f; });
+
+    const bool spectrumIsUpToDate = isSilent && this->numSilentSamples >= AudioMonitor::fftSize;
+    this->numSilentSamples = isSilent ? (this->numSilentSamples + numSamples) : 0;
+
+    if (!spectrumIsUpToDate)
+    {
+        this->computeSpectrum();
+    }
+
+    // publish the results
+    const auto sequence = this->resultsSequence.load(std::memory_order_relaxed);
+    this->resultsSequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    for (int channel = 0; channel < AudioMonitor::numChannels; ++channel)
+    {
+        const auto pcmPeak = this->chunkPeak[channel];
+        const auto rootMeanSquare = float(sqrt(this->chunkSquaresSum[channel] / double(this->chunkSize)));
+
+        this->peak[channel] = pcmPeak;
+        this->rms[channel] = rootMeanSquare;
+
+        if (!spectrumIsUpToDate)
         {
-            const float &pcmData = outputChannelData[channel][samplePosition];
-            pcmSquaresSum += (pcmData * pcmData);
-            pcmPeak = jmax(pcmPeak, pcmData);
+            for (int i = 0; i < AudioMonitor::spectrumSize; ++i)
+            {
+                this->spectrum[channel][i] = this->spectrumResults[channel][i];
+            }
         }
-        
-        const float rootMeanSquare = sqrtf(pcmSquaresSum / numSamples);
-        this->rms[channel] = rootMeanSquare;
-        this->peak[channel] = pcmPeak;
-        
+
         if (pcmPeak > AudioMonitor::clipThreshold)
         {
             this->asyncClippingWarning->triggerAsyncUpdate();
         }
-        
+
         if (pcmPeak > AudioMonitor::oversaturationThreshold &&
             (pcmPeak / rootMeanSquare) > AudioMonitor::oversaturationRate)
         {
@@ -113,33 +230,101 @@ void AudioMonitor::audioDeviceIOCallback(const float **inputChannelData, int num
         }
     }
 
-    for (int i = 0; i < numOutputChannels; ++i)
+    this->resultsSequence.store(sequence + 2, std::memory_order_release);
+    return true;
+}
+
+void AudioMonitor::computeSpectrum()
+{
+    for (int channel = 0; channel < AudioMonitor::numChannels; ++channel)
     {
-        FloatVectorOperations::clear(outputChannelData[i], numSamples);
+        // unwrap the ring buffer, the oldest samples first
+        const auto *channelHistory = this->history[channel];
+        const int numOldest = AudioMonitor::fftSize - this->historyPosition;
+        FloatVectorOperations::copy(this->fftInput, channelHistory + this->historyPosition, numOldest);
+        FloatVectorOperations::copy(this->fftInput + numOldest, channelHistory, this->historyPosition);
+
+        this->fft.computeSpectrum(this->fftInput, this->spectrumResults[channel]);
     }
 }
 
+void AudioMonitor::analyzeChunk(int fifoStart, int numSamples)
+{
+    if (numSamples <= 0)
+    {
+        return;
+    }
+
+    // only the last fftSize samples matter for the spectrum
+    const int numHistorySamples = jmin(numSamples, AudioMonitor::fftSize);
+    const int numFirst = jmin(numHistorySamples, AudioMonitor::fftSize - this->historyPosition);
+
+    for (int channel = 0; channel < AudioMonitor::numChannels; ++channel)
+    {
+        const auto *samples = this->fifoBuffers[channel].get() + fifoStart;
+
+        const auto range = FloatVectorOperations::findMinAndMax(samples, numSamples);
+        this->chunkPeak[channel] = jmax(this->chunkPeak[channel], range.getEnd(), -range.getStart());
+        this->chunkSquaresSum[channel] += double(getSumOfSquares(samples, numSamples));
+
+        const auto *lastSamples = samples + (numSamples - numHistorySamples);
+        auto *channelHistory = this->history[channel];
+        FloatVectorOperations::copy(channelHistory + this->historyPosition, lastSamples, numFirst);
+        FloatVectorOperations::copy(channelHistory, lastSamples + numFirst, numHistorySamples - numFirst);
+    }
+
+    this->historyPosition = (this->historyPosition + numHistorySamples) % AudioMonitor::fftSize;
+    this->chunkSize += numSamples;
+}
 //===----------------------------------------------------------------------===//
 // Spectrum data
 //===----------------------------------------------------------------------===//
 
+// the readers retry if the worker was publishing the new results meanwhile,
+// which is rare and short, since publishing is just a bunch of stores
+template <typename ReaderFn>
+inline auto AudioMonitor::readPublished(ReaderFn reader) const noexcept -> decltype(reader())
+{
+    while (true)
+    {
+        const auto before = this->resultsSequence.load(std::memory_order_acquire);
+        if ((before & 1) == 0)
+        {
+            const auto result = reader();
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (this->resultsSequence.load(std::memory_order_relaxed) == before)
+            {
+                return result;
+            }
+        }
+
+        Thread::yield();
+    }
+}
+
 float AudioMonitor::getInterpolatedSpectrumAtFrequency(float frequency) const
 {
     const float resolution = 
         float(this->sampleRate.get() / 2.f) / float(AudioMonitor::spectrumSize);
     
     const int index1 = roundToInt(frequency / resolution);
-    const int safeIndex1 = jlimit(0, AudioMonitor::spectrumSize, index1);
+    const int safeIndex1 = jlimit(0, AudioMonitor::spectrumSize - 1, index1);
     const float f1 = index1 * resolution;
-    const float y1 = (this->spectrum[0][safeIndex1].get() +
-                      this->spectrum[1][safeIndex1].get()) / 2.f;
-    
+
     const int index2 = index1 + 1;
-    const int safeIndex2 = jlimit(0, AudioMonitor::spectrumSize, index2);
+    const int safeIndex2 = jlimit(0, AudioMonitor::spectrumSize - 1, index2);
     const float f2 = index2 * resolution;
-    const float y2 = (this->spectrum[0][safeIndex2].get() +
-                      this->spectrum[1][safeIndex2].get()) / 2.f;
-    
+
+    const auto values = this->readPublished([this, safeIndex1, safeIndex2]()
+    {
+        return Point<float>(
+            (this->spectrum[0][safeIndex1].get() + this->spectrum[1][safeIndex1].get()) / 2.f,
+            (this->spectrum[0][safeIndex2].get() + this->spectrum[1][safeIndex2].get()) / 2.f);
+    });
+
+    const float y1 = values.getX();
+    const float y2 = values.getY();
+
     return y1 + ((AudioCore::fastLog10(frequency) - AudioCore::fastLog10(f1)) /
                  (AudioCore::fastLog10(f2) - AudioCore::fastLog10(f1))) * (y2 - y1);
 }
@@ -169,10 +354,120 @@ ListenerList<AudioMonitor::ClippingListener> &AudioMonitor::getListeners() noexc
 
 float AudioMonitor::getPeak(int channel) const
 {
-    return this->peak[channel].get();
+    return this->readPublished([this, channel]() { return this->peak[channel].get(); });
 }
 
 float AudioMonitor::getRootMeanSquare(int channel) const
 {
-    return this->rms[channel].get();
+    return this->readPublished([this, channel]() { return this->rms[channel].get(); });
 }
+
+#if JUCE_UNIT_TESTS
+
+class AudioMonitorTests final : public UnitTest
+{
+public:
+    AudioMonitorTests() : UnitTest("Audio monitor tests", UnitTestCategories::helio) {}
+
+    void runTest() override
+    {
+        static constexpr auto numChannels = 2;
+        static constexpr auto blockSize = 512;
+        static constexpr auto sampleRate = 44100.0; // the monitor's default
+
+        AudioBuffer<float> buffer(numChannels, blockSize);
+        int64 sampleCounter = 0;
+
+        const auto fillWithSine = [&](float frequency, float amplitude)
+        {
+            for (int i = 0; i < blockSize; ++i)
+            {
+                const auto phase = MathConstants<double>::twoPi *
+                    double(frequency) * double(sampleCounter + i) / sampleRate;
+                const auto sample = amplitude * float(sin(phase));
+                buffer.setSample(0, i, sample);
+                buffer.setSample(1, i, sample);
+            }
+
+            sampleCounter += blockSize;
+        };
+
+        beginTest("Peak and RMS levels");
+
+        // the worker thread is only started with the audio device,
+        // so here the analysis is run manually after each callback
+        AudioMonitor monitor;
+
+        expect(!monitor.analyzeAvailableSamples());
+
+        buffer.clear();
+        buffer.setSample(0, 100, -0.8f);
+        buffer.setSample(1, 200, 0.3f);
+        monitor.audioDeviceIOCallback(nullptr, 0,
+            buffer.getArrayOfWritePointers(), numChannels, blockSize);
+
+        expect(monitor.analyzeAvailableSamples());
+
+        // negative samples count too
+        expectWithinAbsoluteError(monitor.getPeak(0), 0.8f, 0.0001f);
+        expectWithinAbsoluteError(monitor.getPeak(1), 0.3f, 0.0001f);
+        expectWithinAbsoluteError(monitor.getRootMeanSquare(0),
+            sqrtf(0.64f / float(blockSize)), 0.0001f);
+
+        // the output is consumed
+        expectEquals(buffer.getMagnitude(0, blockSize), 0.f);
+
+        beginTest("Spectrum of a sine wave");
+
+        for (int i = 0; i < 8; ++i)
+        {
+            fillWithSine(1000.f, 0.5f);
+            monitor.audioDeviceIOCallback(nullptr, 0,
+                buffer.getArrayOfWritePointers(), numChannels, blockSize);
+        }
+
+        monitor.analyzeAvailableSamples();
+
+        expectWithinAbsoluteError(monitor.getPeak(0), 0.5f, 0.01f);
+        expectWithinAbsoluteError(monitor.getRootMeanSquare(1), 0.5f / sqrtf(2.f), 0.01f);
+
+        const auto atSignal = monitor.getInterpolatedSpectrumAtFrequency(1000.f);
+        expect(atSignal > 0.1f);
+        expect(atSignal > monitor.getInterpolatedSpectrumAtFrequency(125.f) * 10.f);
+        expect(atSignal > monitor.getInterpolatedSpectrumAtFrequency(5000.f) * 10.f);
+
+        beginTest("Metering performance");
+
+        static constexpr auto numBlocks = 10000;
+        static constexpr auto blocksPerAnalysis = 3; // ~30 ms
+        double callbackMs = 0.0;
+        double analysisMs = 0.0;
+
+        for (int i = 0; i < numBlocks; ++i)
+        {
+            fillWithSine(440.f, 0.25f);
+
+            const auto callbackStartMs = Time::getMillisecondCounterHiRes();
+            monitor.audioDeviceIOCallback(nullptr, 0,
+                buffer.getArrayOfWritePointers(), numChannels, blockSize);
+            callbackMs += Time::getMillisecondCounterHiRes() - callbackStartMs;
+
+            if (i % blocksPerAnalysis == 0)
+            {
+                const auto analysisStartMs = Time::getMillisecondCounterHiRes();
+                monitor.analyzeAvailableSamples();
+                analysisMs += Time::getMillisecondCounterHiRes() - analysisStartMs;
+            }
+        }
+
+        logMessage("Audio thread work per stereo block of " + String(blockSize) + " samples: " +
+            String(callbackMs * 1000.0 / double(numBlocks), 2) + " us on average");
+
+        logMessage("Worker thread analysis per block: " +
+            String(analysisMs * 1000.0 / double(numBlocks), 2) + " us on average");
+    }
+};
+
+static AudioMonitorTests audioMonitorTests;
+
+#endif
@@ -19,11 +19,18 @@
 
 #include "SpectrumAnalyzer.h"
 
-class AudioMonitor final : public AudioIODeviceCallback
+// The audio callback here only copies the output into a lock-free
+// single-producer single-consumer FIFO; all the analysis (peak, RMS,
+// spectrum, clipping detection) is done by a worker thread at the UI rate,
+// which publishes the results under a seqlock, so that the readers
+// always see the values from the same analysis pass.
+
+class AudioMonitor final : public AudioIODeviceCallback, private Thread
 {
 public:
     
     AudioMonitor();
+    ~AudioMonitor() override;
 
     //===------------------------------------------------------------------===//
     // AudioIODeviceCallback
@@ -32,7 +39,7 @@ public:
     void audioDeviceAboutToStart(AudioIODevice *device) override;
     void audioDeviceIOCallback(const float **inputChannelData, int numInputChannels,
         float **outputChannelData, int numOutputChannels, int numSamples) override;
-    void audioDeviceStopped() override {}
+    void audioDeviceStopped() override;
     
     //===------------------------------------------------------------------===//
     // Clipping warnings
@@ -66,19 +73,77 @@ public:
     
 private:
 
-    SpectrumFFT fft;
+    //===------------------------------------------------------------------===//
+    // Thread
+    //===------------------------------------------------------------------===//
+
+    void run() override;
+
+    // returns false if there was nothing to analyze:
+    bool analyzeAvailableSamples();
+    void analyzeChunk(int fifoStart, int numSamples);
+    void computeSpectrum();
+
+    template <typename ReaderFn>
+    inline auto readPublished(ReaderFn reader) const noexcept -> decltype(reader());
 
-    // 256*2 == we just need quite a small resolution on a spectrum
-    static constexpr auto spectrumSize = 256;
+    friend class AudioMonitorTests;
+
+private:
+
+    // 512 samples window gives 256 bins, we just need
+    // quite a small resolution on a spectrum:
+    static constexpr auto fftOrder = 9;
+    static constexpr auto fftSize = 1 << fftOrder;
+    static constexpr auto spectrumSize = fftSize / 2;
     static constexpr auto numChannels = 2;
 
-    static_assert((numChannels * spectrumSize) <= SpectrumFFT::maxSpectrumSize, "Oh no");
+    // the worker wakes up ~30 times a second, which is how often UI
+    // asks for the new data, and backs off if there's nothing coming in:
+    static constexpr auto analysisIntervalMs = 30;
+    static constexpr auto idleIntervalMs = 250;
+    static constexpr auto numCyclesBeforeIdle = 10;
+
+    // ~370 ms at 44.1 kHz, if the worker is late for more than that,
+    // the audio thread will just drop the samples that don't fit:
+    static constexpr auto fifoSize = 16384;
+
+    AbstractFifo fifo;
+    HeapBlock<float> fifoBuffers[numChannels];
+
+    //===------------------------------------------------------------------===//
+    // Worker's state
+    //===------------------------------------------------------------------===//
+
+    SpectrumFFT fft;
+
+    // the analysis window slides over the most recent samples,
+    // which are kept in a ring buffer for each channel
+    float history[numChannels][fftSize] = {};
+    int historyPosition = 0;
+
+    // no need to recompute the spectrum of the silence over and over
+    int numSilentSamples = 0;
+
+    float fftInput[fftSize] = {};
+    float spectrumResults[numChannels][spectrumSize] = {};
+
+    float chunkPeak[numChannels] = {};
+    double chunkSquaresSum[numChannels] = {};
+    int chunkSize = 0;
+
+    //===------------------------------------------------------------------===//
+    // Published results
+    //===------------------------------------------------------------------===//
 
     static constexpr auto defaultSampleRate = 44100;
     static constexpr auto clipThreshold = 0.995f;
     static constexpr auto oversaturationThreshold = 0.5f;
     static constexpr auto oversaturationRate = 4.f;
 
+    // odd while the worker is writing the results
+    std::atomic<uint32> resultsSequence { 0 };
+
     Atomic<float> spectrum[numChannels][spectrumSize];
     Atomic<float> peak[numChannels];
     Atomic<float> rms[numChannels];
@@ -18,141 +18,96 @@
 #include "Common.h"
 #include "SpectrumAnalyzer.h"
 
-SpectrumFFT::SpectrumFFT()
+SpectrumFFT::SpectrumFFT(int order) :
+    order(order),
+    size(1 << order)
 {
-    for (int count = 0; count < SpectrumFFT::cosTableSize; count++)
-    {
-        this->costab[count] = cosf(MathConstants<float>::halfPi *
-            static_cast<float>(count) / static_cast<float>(SpectrumFFT::cosTableSize));
-    }
-}
+    jassert(order > 1);
 
-inline float SpectrumFFT::cosine(float x) const noexcept
-{
-    int y;
-    
-    x *= SpectrumFFT::tableRange;
-    y = static_cast<int>(x);
-    if (y < 0)
+    this->window.allocate(this->size, true);
+    this->cosTable.allocate(this->size / 2, true);
+    this->sinTable.allocate(this->size / 2, true);
+    this->bitReversed.allocate(this->size, true);
+    this->re.allocate(this->size, true);
+    this->im.allocate(this->size, true);
+
+    const auto n = double(this->size);
+
+    for (int i = 0; i < this->size; ++i)
     {
-        y = -y;
+        // Hann window, also normalized by the FFT size
+        const auto w = 0.5 * (1.0 - cos(MathConstants<double>::twoPi * double(i) / n));
+        this->window[i] = float(w / n);
+
+        int reversed = 0;
+        for (int bit = 0; bit < this->order; ++bit)
+        {
+            reversed |= ((i >> bit) & 1) << (this->order - 1 - bit);
+        }
+
+        this->bitReversed[i] = reversed;
     }
 
-    y &= SpectrumFFT::tableMask;
-    switch (y >> SpectrumFFT::cosTableBits)
+    for (int i = 0; i < this->size / 2; ++i)
     {
-        case 0 : return  this->costab[y];
-        case 1 : return -this->costab[(SpectrumFFT::cosTableSize - 1) - (y - (SpectrumFFT::cosTableSize * 1))];
-        case 2 : return -this->costab[                                  (y - (SpectrumFFT::cosTableSize * 2))];
-        case 3 : return  this->costab[(SpectrumFFT::cosTableSize - 1) - (y - (SpectrumFFT::cosTableSize * 3))];
+        const auto phase = MathConstants<double>::twoPi * double(i) / n;
+        this->cosTable[i] = float(cos(phase));
+        this->sinTable[i] = float(sin(phase));
     }
-    
-    return 0.f;
 }
 
-inline float SpectrumFFT::sine(float x) const noexcept
+void SpectrumFFT::computeSpectrum(const float *samples, float *outMagnitudes) noexcept
 {
-    return this->cosine(x - 0.25f);
-}
+    float *re = this->re.get();
+    float *im = this->im.get();
 
-inline unsigned int SpectrumFFT::reverse(unsigned int val, int bits) const noexcept
-{
-    unsigned int retn = 0;
-    
-    while (bits--)
+    // windowed samples go in the bit-reversed order,
+    // so that the output comes out in the natural order
+    for (int i = 0; i < this->size; ++i)
     {
-        retn <<= 1;
-        retn |= (val & 1);
-        val >>= 1;
+        re[this->bitReversed[i]] = samples[i] * this->window[i];
     }
-    
-    return (retn);
-}
 
-inline void SpectrumFFT::process(int bits)
-{
-    int count, count2, count3;
-    int fftlen = 1 << bits;
-    unsigned i1 = fftlen / 2;
-    int i2 = 1, i3, i4, y;
-    float a1, a2, b1, b2, z1, z2;
-    float oneOverN = 1.0f / fftlen;
-    
-    for (count = 0; count < bits; count++)
+    FloatVectorOperations::clear(im, this->size);
+
+    for (int halfSize = 1, tableStep = this->size / 2;
+        halfSize < this->size; halfSize <<= 1, tableStep >>= 1)
     {
-        i3 = 0;
-        i4 = i1;
-        
-        for (count2 = 0; count2 < i2; count2++)
+        for (int start = 0; start < this->size; start += (halfSize << 1))
         {
-            y  = this->reverse(i3 / static_cast<int>(i1), bits);
-            z1 = this->cosine(static_cast<float>(y) * oneOverN);
-            z2 = -this->sine(static_cast<float>(y) * oneOverN);
+            float *re1 = re + start;
+            float *im1 = im + start;
+            float *re2 = re1 + halfSize;
+            float *im2 = im1 + halfSize;
 
-            for (count3 = i3; count3 < i4; count3++)
+            for (int k = 0; k < halfSize; ++k)
             {
-                a1 = this->buffer[count3].re;
-                a2 = this->buffer[count3].im;
-                
-                b1 = (z1 * this->buffer[count3 + i1].re) - (z2 * this->buffer[count3 + i1].im);
-                b2 = (z2 * this->buffer[count3 + i1].re) + (z1 * this->buffer[count3 + i1].im);
-                
-                this->buffer[count3].re = a1 + b1;
-                this->buffer[count3].im = a2 + b2;
-                
-                this->buffer[count3 + i1].re = a1 - b1;
-                this->buffer[count3 + i1].im = a2 - b2;
+                const float c = this->cosTable[k * tableStep];
+                const float s = this->sinTable[k * tableStep];
+
+                // multiplied by e^(-i * phase)
+                const float tr = c * re2[k] + s * im2[k];
+                const float ti = c * im2[k] - s * re2[k];
+
+                re2[k] = re1[k] - tr;
+                im2[k] = im1[k] - ti;
+                re1[k] += tr;
+                im1[k] += ti;
             }
-            
-            i3 += (i1 << 1);
-            i4 += (i1 << 1);
         }
-        
-        i1 >>= 1;
-        i2 <<= 1;
     }
-}
 
-void SpectrumFFT::computeSpectrum(float *pcmBuffer,
-    unsigned int pcmPosition, unsigned int pcmLength,
-    Atomic<float> *spectrum, int length,
-    int channel, int numchannels)
-{
-    int count, bits, bitslength, nyquist;
-    
-    bitslength = length;
-    bits = 0;
-    while (bitslength > 1)
-    {
-        bitslength >>= 1;
-        bits++;
-    }
-    
-    // Apply Hanning window
-    for (count = 0; count < length; count++)
+    // the same scale that the older spectrum monitor had
+    static constexpr auto magnitudeScale = 2.5f;
+
+    const int numBins = this->size / 2;
+    for (int i = 0; i < numBins; ++i)
     {
-        const float percent = static_cast<float>(count) / static_cast<float>(length);
-        const float window = 0.5f * (1.0f  - this->cosine(percent));
-        
-        this->buffer[count].re = pcmBuffer[pcmPosition] * window;
-        this->buffer[count].re /= static_cast<float>(length);
-        this->buffer[count].im = 0.00000001f;
-        
-        pcmPosition++;
-        if (pcmPosition >= pcmLength)
-        {
-            pcmPosition = 0;
-        }
+        outMagnitudes[i] = re[i] * re[i] + im[i] * im[i];
     }
 
-    this->process(bits);
-
-    nyquist = (length / 2);
-    for (count = 0; count < (nyquist - 1); ++count)
+    for (int i = 0; i < numBins; ++i)
     {
-        const auto n = this->reverse(count, bits);
-        spectrum[count] = jmin(1.0f, 2.5f *
-            (sqrtf((this->buffer[n].re * this->buffer[n].re)
-                + (this->buffer[n].im * this->buffer[n].im))));
+        outMagnitudes[i] = jmin(1.f, magnitudeScale * sqrtf(outMagnitudes[i]));
     }
 }
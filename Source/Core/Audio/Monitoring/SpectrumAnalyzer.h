@@ -17,40 +17,36 @@
 
 #pragma once
 
+// A radix-2 FFT for the spectrum monitoring: all the tables
+// (the window, the twiddle factors and the bit-reversal permutation)
+// are computed once in the constructor, and the butterflies run
+// on split real/imaginary arrays, which compilers vectorize well;
+// no allocations here after the construction, safe for the audio thread.
+
 class SpectrumFFT final
 {
 public:
     
-    SpectrumFFT();
-    
-    void computeSpectrum(float *pcmBuffer,
-        unsigned int pcmPosition, unsigned int pcmLength,
-        Atomic<float> *spectrum, int length,
-        int channel, int numchannels);
+    explicit SpectrumFFT(int order);
 
-    // please make sure no consumer ever asks for a spectrum larger than that:
-    static constexpr auto maxSpectrumSize = 512;
+    // takes exactly getSize() samples, applies the Hann window,
+    // and writes getSize() / 2 normalized magnitudes to the output
+    void computeSpectrum(const float *samples, float *outMagnitudes) noexcept;
+
+    inline int getSize() const noexcept { return this->size; }
 
 private:
 
-    static constexpr auto cosTableBits = 13;
-    static constexpr auto cosTableSize = 1 << cosTableBits;
-    static constexpr auto tableRange = cosTableSize * 4;
-    static constexpr auto tableMask = tableRange - 1;
+    const int order;
+    const int size;
+
+    HeapBlock<float> window; // pre-scaled by 1 / size
+    HeapBlock<float> cosTable;
+    HeapBlock<float> sinTable;
+    HeapBlock<int> bitReversed;
+
+    HeapBlock<float> re;
+    HeapBlock<float> im;
 
-    struct FftComplex final
-    {
-        float re = 0.f;
-        float im = 0.f;
-    };
-    
-    FftComplex buffer[maxSpectrumSize];
-    float costab[cosTableSize];
-    
-    inline float cosine(float x) const noexcept;
-    inline float sine(float x) const noexcept;
-    inline unsigned int reverse(unsigned int val, int bits) const noexcept;
-    inline void process(int bits);
-    
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SpectrumFFT);
 };
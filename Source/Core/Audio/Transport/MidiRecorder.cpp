@@ -24,21 +24,25 @@
 #include "MidiTrack.h"
 #include "PianoTrackNode.h"
 #include "PianoSequence.h"
+#include "AutomationTrackNode.h"
+#include "AutomationSequence.h"
 
 #include "PatternRoll.h"
 #include "SequencerOperations.h"
 #include "PianoTrackActions.h"
+#include "AutomationTrackActions.h"
 #include "UndoStack.h"
 
 #include "Workspace.h"
 #include "AudioCore.h"
 #include "ColourIDs.h"
 
-// todo for the future: handle pedal and more automation events
-
 MidiRecorder::MidiRecorder(ProjectNode &project) :
-    project(project)
+    project(project),
+    incomingEventsFifo(MidiRecorder::fifoSize)
 {
+    this->incomingEvents.allocate(MidiRecorder::fifoSize, true);
+
     this->lastUpdateTime = Time::getMillisecondCounterHiRes();
     this->lastCorrectPosition = this->getTransport().getSeekBeat();
 
@@ -47,6 +51,7 @@ MidiRecorder::MidiRecorder(ProjectNode &project) :
 
 MidiRecorder::~MidiRecorder()
 {
+    this->stopUpdatingHoldingNotes();
     this->getTransport().removeTransportListener(this);
 }
 
@@ -66,6 +71,9 @@ void MidiRecorder::setTargetScope(const Clip *clip, const String &instrumentId)
             this->finaliseAllHoldingNotes();
         }
 
+        // the automation tracks are bound to the active track's instrument
+        this->finaliseAllAutomationTakes();
+
         this->activeTrack = track;
         this->activeClip = clip;
         this->shouldCheckpoint = true;
@@ -85,6 +93,7 @@ void MidiRecorder::onSeek(float beatPosition, double, double) noexcept
         jassert(mml.lockWasGained());
 
         this->finaliseAllHoldingNotes();
+        this->finaliseAllAutomationTakes();
     }
 
     this->lastCorrectPosition = beatPosition;
@@ -111,7 +120,7 @@ void MidiRecorder::onRecord()
 
         if (this->isPlaying.get())
         {
-            this->startTimerHz(MidiRecorder::updateTimeHz);
+            this->startUpdatingHoldingNotes();
         }
     }
 }
@@ -125,7 +134,7 @@ void MidiRecorder::onPlay() noexcept
 
         if (this->isRecording.get())
         {
-            this->startTimerHz(MidiRecorder::updateTimeHz);
+            this->startUpdatingHoldingNotes();
         }
     }
 }
@@ -134,17 +143,17 @@ void MidiRecorder::onStop()
 {
     if (this->isRecording.get())
     {
-        this->stopTimer();
+        this->stopUpdatingHoldingNotes();
 
         auto &audioCore = App::Workspace().getAudioCore();
         audioCore.removeFilteredMidiInputCallback(this);
 
-        this->isRecording = false;
-
-        // fixme handle buffers?
-        jassert(this->noteOnsBuffer.isEmpty());
-        jassert(this->noteOffsBuffer.isEmpty());
+        // the midi thread won't write anything after that,
+        // so insert whatever has been received so far
+        this->handleUpdateNowIfNeeded();
+        this->finaliseAllAutomationTakes();
 
+        this->isRecording = false;
         this->holdingNotes.clear();
     }
 
@@ -172,13 +181,28 @@ static SerializedData createPianoTrackTemplate(const String &name,
     return newNode->serialize();
 }
 
+static SerializedData createRecordedAutomationTrackTemplate(const String &name,
+    int controllerNumber, const String &instrumentId, String &outTrackId)
+{
+    auto newNode = make<AutomationTrackNode>(name);
+
+    const Clip clip(newNode->getPattern());
+    newNode->getPattern()->insert(clip, false);
+
+    newNode->setTrackControllerNumber(controllerNumber, false);
+    newNode->setTrackInstrumentId(instrumentId, false);
+    newNode->setTrackColour(Colours::royalblue, dontSendNotification);
+
+    outTrackId = newNode->getTrackId();
+    return newNode->serialize();
+}
+
 // called from the message thread, so we can insert new midi events
 // (note that the track selection may change during recording);
 // the main recording logic goes here:
 void MidiRecorder::handleAsyncUpdate()
 {
-    if (this->noteOnsBuffer.isEmpty() &&
-        this->noteOffsBuffer.isEmpty())
+    if (this->incomingEventsFifo.getNumReady() == 0)
     {
         // nothing to do
         return;
@@ -193,9 +217,6 @@ void MidiRecorder::handleAsyncUpdate()
         this->getTransport().startPlayback();
     }
 
-    // if no track is selected, must checkpoint anyway
-    jassert(this->activeTrack != nullptr || this->shouldCheckpoint.get());
-
     // at this point we surely have some actions to perform,
     // so first, let's manage undo actions properly;
     // we'll checkpoint every time the active track changes:
@@ -206,10 +227,27 @@ void MidiRecorder::handleAsyncUpdate()
         this->shouldCheckpoint = false;
     }
 
+    int start1, size1, start2, size2;
+    this->incomingEventsFifo.prepareToRead(this->incomingEventsFifo.getNumReady(),
+        start1, size1, start2, size2);
+
+    const auto getIncomingEvent = [&](int i) -> const IncomingEvent &
+    {
+        return this->incomingEvents[i < size1 ? (start1 + i) : (start2 + i - size1)];
+    };
+
+    // controllers go to the automation tracks anyway,
+    // so a piano track only makes sense if there are notes to insert
+    bool hasIncomingNotes = false;
+    for (int i = 0; i < size1 + size2 && !hasIncomingNotes; ++i)
+    {
+        hasIncomingNotes = getIncomingEvent(i).type == IncomingEvent::Type::NoteOn;
+    }
+
     // if something is selected (can be both rolls), simply insert messages,
     // if nothing is selected (pattern roll), first create a new track and select it
     // if multiple tracks are selected (also pattern roll) - same as ^
-    if (this->activeTrack == nullptr)
+    if (this->activeTrack == nullptr && hasIncomingNotes)
     {
         const auto newName =
             SequencerOperations::generateNextNameForNewTrack("Recording",
@@ -238,78 +276,139 @@ void MidiRecorder::handleAsyncUpdate()
         this->shouldCheckpoint = false;
     }
     
-    // handle note offs and fill unhandledNoteOffs
-    while (!this->noteOffsBuffer.isEmpty())
+    // events are handled in the order of arrival, so that a quick note-on/note-off
+    // pair received within one update still makes a note, the one which is only
+    // to be inserted, so all the changes are applied at once in the end:
+    PendingChanges changes;
+
+    for (int i = 0; i < size1 + size2; ++i)
     {
-        const auto last = this->noteOffsBuffer.size() - 1;
-        const auto i = this->noteOffsBuffer.removeAndReturn(last);
-        const bool wasHandled = this->finaliseHoldingNote(i.getNoteNumber());
-        if (!wasHandled)
+        const auto &event = getIncomingEvent(i);
+        switch (event.type)
         {
-            this->unhandledNoteOffs.add(i);
+        case IncomingEvent::Type::NoteOn:
+            this->startHoldingNote(event, changes);
+            break;
+        case IncomingEvent::Type::NoteOff:
+            this->finaliseHoldingNote(event.number, event.beat, changes);
+            break;
+        case IncomingEvent::Type::Controller:
+            this->recordControllerValue(event);
+            break;
         }
     }
 
-    // handle note ons
-    while (!this->noteOnsBuffer.isEmpty())
+    this->incomingEventsFifo.finishedRead(size1 + size2);
+
+    if (!changes.notesBefore.isEmpty())
     {
-        const auto last = this->noteOnsBuffer.size() - 1;
-        const auto i = this->noteOnsBuffer.removeAndReturn(last);
-        this->startHoldingNote(i);
+        this->getPianoSequence()->changeGroup(changes.notesBefore, changes.notesAfter, true);
     }
 
-    // handle unhandledNoteOffs and clean
-    for (const auto &i : this->unhandledNoteOffs)
+    if (!changes.notesToInsert.isEmpty())
     {
-        this->finaliseHoldingNote(i.getNoteNumber());
+        this->getPianoSequence()->insertGroup(changes.notesToInsert, true);
     }
 
-    this->unhandledNoteOffs.clearQuick();
-}
-
-struct SortMidiMessagesByTimestamp final
-{
-    static int compareElements(const MidiMessage &first, const MidiMessage &second)
+    for (auto it = this->automationTakes.begin(); it != this->automationTakes.end(); ++it)
     {
-        return int(first.getTimeStamp() - second.getTimeStamp());
+        this->flushAutomationTake(it.value(), false);
     }
-};
-
-static SortMidiMessagesByTimestamp tsSort;
+}
 
 // called from the high-priority system thread:
 void MidiRecorder::handleIncomingMidiMessage(MidiInput *, const MidiMessage &message)
 {
+    // before doing anything else, so that the position is as precise as it gets
+    const auto arrivalTimeMs = Time::getMillisecondCounterHiRes();
+
+    IncomingEvent event;
+
     if (message.isNoteOn())
     {
-        this->noteOnsBuffer.addSorted(tsSort,
-            message.withTimeStamp(this->getEstimatedPosition()));
+        event.type = IncomingEvent::Type::NoteOn;
+        event.number = message.getNoteNumber();
+        event.value = float(message.getVelocity()) / 128.f;
     }
     else if (message.isNoteOff())
     {
-        this->noteOffsBuffer.addSorted(tsSort,
-            message.withTimeStamp(this->getEstimatedPosition()));
+        event.type = IncomingEvent::Type::NoteOff;
+        event.number = message.getNoteNumber();
+    }
+    else if (!this->isPlaying.get())
+    {
+        // unlike the notes, controllers don't start the playback,
+        // so that touching a knob doesn't start recording
+        return;
+    }
+    else if (message.isController())
+    {
+        // channel mode messages and the tempo hack are not recorded
+        if (message.getControllerNumber() >= 120 ||
+            message.getControllerNumber() == MidiTrack::tempoController)
+        {
+            return;
+        }
+
+        event.type = IncomingEvent::Type::Controller;
+        event.number = message.getControllerNumber();
+        event.value = float(message.getControllerValue()) / 127.f;
+    }
+    else if (message.isPitchWheel())
+    {
+        event.type = IncomingEvent::Type::Controller;
+        event.number = MidiTrack::pitchBendController;
+        event.value = float(message.getPitchWheelValue()) / 16383.f;
+    }
+    else if (message.isChannelPressure())
+    {
+        event.type = IncomingEvent::Type::Controller;
+        event.number = MidiTrack::channelPressureController;
+        event.value = float(message.getChannelPressureValue()) / 127.f;
+    }
+    else
+    {
+        return;
+    }
+
+    int start1, size1, start2, size2;
+    this->incomingEventsFifo.prepareToWrite(1, start1, size1, start2, size2);
+
+    if (size1 == 0)
+    {
+        jassertfalse; // the message thread is stuck?
+        return;
     }
 
+    event.beat = this->getEstimatedPositionAt(arrivalTimeMs);
+    this->incomingEvents[start1] = event;
+    this->incomingEventsFifo.finishedWrite(1);
+
+    // only posts a message if the previous update has been handled
     this->triggerAsyncUpdate();
 }
 
 // current beat, estimated since the last known
 // midi event, including the tempo change events:
 double MidiRecorder::getEstimatedPosition() const
+{
+    return this->getEstimatedPositionAt(Time::getMillisecondCounterHiRes());
+}
+
+double MidiRecorder::getEstimatedPositionAt(double timeMs) const
 {
     if (!this->isPlaying.get())
     {
         return this->lastCorrectPosition.get();
     }
 
-    const double timeOffsetMs = Time::getMillisecondCounterHiRes() - this->lastUpdateTime.get();
+    const double timeOffsetMs = timeMs - this->lastUpdateTime.get();
     const double positionOffset = timeOffsetMs / this->msPerQuarterNote.get();
     const double estimatedPosition = this->lastCorrectPosition.get() + positionOffset;
     return estimatedPosition;
 }
 
-void MidiRecorder::timerCallback()
+void MidiRecorder::onAnimationFrame(double timeMs)
 {
     if (this->activeTrack != nullptr)
     {
@@ -317,33 +416,88 @@ void MidiRecorder::timerCallback()
     }
 }
 
+// no need for updating too often, I guess, so the low priority
+// updates at 15 Hz are fine; transport callbacks are called
+// with the message manager locked, so it's safe to subscribe here:
+void MidiRecorder::startUpdatingHoldingNotes()
+{
+    if (!this->isUpdatingHoldingNotes)
+    {
+        this->isUpdatingHoldingNotes = true;
+        App::AnimationClock().addListener(this, AnimationClock::Priority::Low);
+    }
+}
+
+void MidiRecorder::stopUpdatingHoldingNotes()
+{
+    if (this->isUpdatingHoldingNotes)
+    {
+        this->isUpdatingHoldingNotes = false;
+        App::AnimationClock().removeListener(this);
+    }
+}
+
 //===----------------------------------------------------------------------===//
 // Helpers
 //===----------------------------------------------------------------------===//
 
-void MidiRecorder::startHoldingNote(MidiMessage message)
+void MidiRecorder::startHoldingNote(const IncomingEvent &event, PendingChanges &changes)
 {
     jassert(this->activeClip != nullptr);
     jassert(this->activeTrack != nullptr);
 
-    const auto key = message.getNoteNumber();
+    const auto key = event.number;
     
     if (this->holdingNotes.contains(key))
     {
         DBG("Found weird note-on/note-off order");
-        this->finaliseHoldingNote(key);
+        this->finaliseHoldingNote(key, event.beat, changes);
     }
 
     const Note noteParams(this->activeTrack->getSequence(),
         key - this->activeClip->getKey(),
-        roundBeat(float(message.getTimeStamp()) - this->activeClip->getBeat()),
+        roundBeat(float(event.beat) - this->activeClip->getBeat()),
         Globals::minNoteLength,
-        float(message.getVelocity()) / 128.f);
+        event.value);
 
-    this->getPianoSequence()->insert(noteParams, true);
+    changes.insertedNotesByKey[key] = changes.notesToInsert.size();
+    changes.notesToInsert.add(noteParams);
     this->holdingNotes[key] = noteParams;
 }
 
+void MidiRecorder::finaliseHoldingNote(int key, double beat, PendingChanges &changes)
+{
+    // note-offs may come without the active track, if only controllers were recorded
+    const auto holdingNote = this->holdingNotes.find(key);
+    if (holdingNote == this->holdingNotes.end())
+    {
+        return;
+    }
+
+    jassert(this->activeClip != nullptr);
+    jassert(this->activeTrack != nullptr);
+
+    const auto &note = holdingNote->second;
+    const auto clipBeat = float(beat) - this->activeClip->getBeat();
+    const auto newLength = jmax(Globals::minNoteLength, roundBeat(clipBeat - note.getBeat()));
+
+    // the note might be not even inserted yet
+    const auto pendingNote = changes.insertedNotesByKey.find(key);
+    if (pendingNote != changes.insertedNotesByKey.end())
+    {
+        auto &noteToInsert = changes.notesToInsert.getReference(pendingNote->second);
+        noteToInsert = noteToInsert.withLength(newLength);
+        changes.insertedNotesByKey.erase(pendingNote);
+    }
+    else
+    {
+        changes.notesBefore.add(note);
+        changes.notesAfter.add(note.withLength(newLength));
+    }
+
+    this->holdingNotes.erase(holdingNote);
+}
+
 void MidiRecorder::updateLengthsOfHoldingNotes() const
 {
     jassert(this->activeClip != nullptr);
@@ -387,24 +541,249 @@ void MidiRecorder::finaliseAllHoldingNotes()
     this->holdingNotes.clear();
 }
 
-bool MidiRecorder::finaliseHoldingNote(int key)
+//===----------------------------------------------------------------------===//
+// Automation recording
+//===----------------------------------------------------------------------===//
+
+void MidiRecorder::setAutomationTolerance(float tolerance) noexcept
 {
-    jassert(this->activeClip != nullptr);
-    jassert(this->activeTrack != nullptr);
+    this->automationTolerance = jmax(0.f, tolerance);
+}
 
-    const auto currentBeat =
-        float(this->getEstimatedPosition() - this->activeClip->getBeat());
+float MidiRecorder::getAutomationTolerance() const noexcept
+{
+    return this->automationTolerance;
+}
 
-    if (this->holdingNotes.contains(key))
+MidiRecorder::AutomationStats MidiRecorder::getLastAutomationStats() const noexcept
+{
+    return this->lastAutomationStats;
+}
+
+// Ramer-Douglas-Peucker without recursion, measuring the vertical distance
+// from the curve between two kept points, since the time and the value axes
+// have nothing in common; the curve is the same one the playback and the UI
+// will interpolate with, given the curvature of the inserted events;
+// the first and the last points are always kept
+template <typename Point>
+static Array<Point> decimateRecordedAutomation(const Array<Point> &points,
+    float tolerance, float curvature)
+{
+    const auto numPoints = points.size();
+    if (numPoints <= 2 || tolerance <= 0.f)
+    {
+        return points;
+    }
+
+    Array<bool> shouldKeep;
+    shouldKeep.insertMultiple(0, false, numPoints);
+    shouldKeep.set(0, true);
+    shouldKeep.set(numPoints - 1, true);
+
+    Array<Range<int>> rangesToCheck;
+    rangesToCheck.add({ 0, numPoints - 1 });
+
+    while (!rangesToCheck.isEmpty())
+    {
+        const auto range = rangesToCheck.removeAndReturn(rangesToCheck.size() - 1);
+        const auto &first = points.getReference(range.getStart());
+        const auto &last = points.getReference(range.getEnd());
+        const auto beatRange = last.beat - first.beat;
+
+        auto maxDistance = 0.f;
+        auto maxDistanceIndex = -1;
+
+        for (int i = range.getStart() + 1; i < range.getEnd(); ++i)
+        {
+            const auto &point = points.getReference(i);
+            const auto interpolatedValue = beatRange > 0.f ?
+                AutomationEvent::interpolateEvents(first.value, last.value,
+                    (point.beat - first.beat) / beatRange, curvature) :
+                first.value;
+
+            const auto distance = std::abs(point.value - interpolatedValue);
+            if (distance > maxDistance)
+            {
+                maxDistance = distance;
+                maxDistanceIndex = i;
+            }
+        }
+
+        if (maxDistance > tolerance)
+        {
+            shouldKeep.set(maxDistanceIndex, true);
+            rangesToCheck.add({ range.getStart(), maxDistanceIndex });
+            rangesToCheck.add({ maxDistanceIndex, range.getEnd() });
+        }
+    }
+
+    Array<Point> result;
+    for (int i = 0; i < numPoints; ++i)
+    {
+        if (shouldKeep.getUnchecked(i))
+        {
+            result.add(points.getReference(i));
+        }
+    }
+
+    return result;
+}
+
+void MidiRecorder::recordControllerValue(const IncomingEvent &event)
+{
+    auto &take = this->automationTakes[event.number];
+
+    if (take.track == nullptr)
+    {
+        take = {};
+        take.track = this->findOrCreateAutomationTrack(event.number);
+        take.startBeat = float(event.beat);
+
+        if (take.track == nullptr)
+        {
+            jassertfalse;
+            this->automationTakes.erase(event.number);
+            return;
+        }
+    }
+
+    const auto beat = float(event.beat);
+    take.stats.numCapturedEvents++;
+    take.stats.lengthInBeats = jmax(take.stats.lengthInBeats, beat - take.startBeat);
+
+    // for pedals and switches, only the state changes matter
+    if (take.track->isOnOffAutomationTrack())
+    {
+        const auto value = event.value >= 0.5f ? 1.f : 0.f;
+        if (take.points.isEmpty() || take.points.getLast().value != value)
+        {
+            take.points.add({ beat, value });
+        }
+
+        return;
+    }
+
+    take.points.add({ beat, event.value });
+}
+
+void MidiRecorder::flushAutomationTake(AutomationTake &take, bool isTakeFinished)
+{
+    const auto numNewPoints = take.points.size() - (take.hasInsertedAnchor ? 1 : 0);
+    if (take.track == nullptr || numNewPoints <= 0)
+    {
+        return;
+    }
+
+    if (!isTakeFinished && take.points.getLast().beat - take.points.getFirst().beat <
+        MidiRecorder::automationChunkBeats)
+    {
+        return;
+    }
+
+    auto *sequence = static_cast<AutomationSequence *>(take.track->getSequence());
+    const auto clipBeat = take.track->getPattern()->getUnchecked(0)->getBeat();
+
+    static constexpr auto curvature = Globals::Defaults::automationControllerCurve;
+    const auto pointsToInsert = take.track->isOnOffAutomationTrack() ? take.points :
+        decimateRecordedAutomation(take.points, this->automationTolerance, curvature);
+
+    Array<AutomationEvent> events;
+    for (int i = take.hasInsertedAnchor ? 1 : 0; i < pointsToInsert.size(); ++i)
     {
-        const auto &note = this->holdingNotes[key];
-        const auto newLength = roundBeat(currentBeat - note.getBeat());
-        this->getPianoSequence()->change(note, note.withLength(newLength), true);
-        this->holdingNotes.erase(key);
-        return true;
+        const auto &point = pointsToInsert.getReference(i);
+        const auto beat = roundBeat(point.beat - clipBeat);
+
+        // within the same tick, the latest value wins
+        if (!events.isEmpty() && events.getLast().getBeat() == beat)
+        {
+            events.removeLast();
+        }
+
+        events.add(AutomationEvent(sequence, beat, point.value).withCurvature(curvature));
     }
 
-    return false;
+    sequence->insertGroup(events, true);
+    take.stats.numInsertedEvents += events.size();
+
+    const auto lastPoint = take.points.getLast();
+    take.points.clearQuick();
+    take.hasInsertedAnchor = !isTakeFinished;
+
+    if (!isTakeFinished)
+    {
+        take.points.add(lastPoint);
+    }
+}
+
+void MidiRecorder::finaliseAllAutomationTakes()
+{
+    if (this->automationTakes.empty())
+    {
+        return;
+    }
+
+    AutomationStats totalStats;
+
+    for (auto it = this->automationTakes.begin(); it != this->automationTakes.end(); ++it)
+    {
+        auto &take = it.value();
+        this->flushAutomationTake(take, true);
+
+        DBG("Recorded controller " + String(it->first) + ": " +
+            String(take.stats.numCapturedEvents) + " events, " +
+            String(take.stats.getEventsPerBeat(), 1) + " per beat, " +
+            String(take.stats.numInsertedEvents) + " inserted, reduced " +
+            String(take.stats.getReductionRatio(), 1) + "x");
+
+        totalStats.numCapturedEvents += take.stats.numCapturedEvents;
+        totalStats.numInsertedEvents += take.stats.numInsertedEvents;
+        totalStats.lengthInBeats = jmax(totalStats.lengthInBeats, take.stats.lengthInBeats);
+    }
+
+    this->lastAutomationStats = totalStats;
+    this->automationTakes.clear();
+}
+
+MidiTrack *MidiRecorder::findOrCreateAutomationTrack(int controllerNumber)
+{
+    const auto instrumentId = this->activeTrack != nullptr ?
+        this->activeTrack->getTrackInstrumentId() : this->lastValidInstrumentId;
+
+    for (auto *track : this->project.getAutomationTracks())
+    {
+        if (track->getTrackControllerNumber() == controllerNumber &&
+            track->getTrackInstrumentId() == instrumentId)
+        {
+            return track;
+        }
+    }
+
+    String controllerName;
+    switch (controllerNumber)
+    {
+    case MidiTrack::pitchBendController:
+        controllerName = "Pitch bend";
+        break;
+    case MidiTrack::channelPressureController:
+        controllerName = "Channel pressure";
+        break;
+    default:
+        controllerName = MidiMessage::getControllerName(controllerNumber);
+        break;
+    }
+
+    const auto trackName = TreeNode::createSafeName(controllerName.isNotEmpty() ?
+        controllerName : ("CC " + String(controllerNumber)));
+
+    String outTrackId;
+    const auto trackTemplate = createRecordedAutomationTrackTemplate(trackName,
+        controllerNumber, instrumentId, outTrackId);
+
+    this->project.getUndoStack()->perform(
+        new AutomationTrackInsertAction(this->project,
+            &this->project, trackTemplate, trackName));
+
+    return this->project.findTrackById<AutomationTrackNode>(outTrackId);
 }
 
 PianoSequence *MidiRecorder::getPianoSequence() const
@@ -416,3 +795,86 @@ Transport &MidiRecorder::getTransport() const noexcept
 {
     return this->project.getTransport();
 }
+
+//===----------------------------------------------------------------------===//
+// Tests
+//===----------------------------------------------------------------------===//
+
+#if JUCE_UNIT_TESTS
+
+class MidiRecorderTests final : public UnitTest
+{
+public:
+    MidiRecorderTests() : UnitTest("MIDI recorder tests", UnitTestCategories::helio) {}
+
+    struct TestPoint final
+    {
+        float beat = 0.f;
+        float value = 0.f;
+    };
+
+    void runTest() override
+    {
+        beginTest("Automation decimation");
+
+        static constexpr auto curvature = Globals::Defaults::automationControllerCurve;
+
+        // a single segment of the automation curve reduces to its ends
+        Array<TestPoint> curve;
+        for (int i = 0; i < 1000; ++i)
+        {
+            curve.add({ float(i) * 0.01f,
+                AutomationEvent::interpolateEvents(0.f, 1.f, float(i) / 999.f, curvature) });
+        }
+
+        expectEquals(decimateRecordedAutomation(curve, 0.01f, curvature).size(), 2);
+        expectEquals(decimateRecordedAutomation(curve, 0.f, curvature).size(), curve.size());
+
+        // while a straight line doesn't, since it's not how the events are interpolated
+        Array<TestPoint> line;
+        for (int i = 0; i < 1000; ++i)
+        {
+            line.add({ float(i) * 0.01f, float(i) / 1000.f });
+        }
+
+        expect(decimateRecordedAutomation(line, 0.01f, curvature).size() > 2);
+
+        // a dense modulation wheel wobble, 4 beats long, 250 events per beat
+        Array<TestPoint> wobble;
+        for (int i = 0; i < 1000; ++i)
+        {
+            const auto beat = float(i) * 0.004f;
+            wobble.add({ beat, 0.5f + 0.4f * std::sin(beat * MathConstants<float>::twoPi) });
+        }
+
+        static constexpr auto tolerance = 0.01f;
+        const auto decimated = decimateRecordedAutomation(wobble, tolerance, curvature);
+
+        expect(decimated.size() > 2);
+        expect(decimated.size() * 5 < wobble.size());
+        expectEquals(decimated.getFirst().beat, wobble.getFirst().beat);
+        expectEquals(decimated.getLast().beat, wobble.getLast().beat);
+
+        // no original point is further from the curve played back than the tolerance
+        int segment = 0;
+        for (const auto &point : wobble)
+        {
+            while (decimated.getReference(segment + 1).beat < point.beat)
+            {
+                segment++;
+            }
+
+            const auto &a = decimated.getReference(segment);
+            const auto &b = decimated.getReference(segment + 1);
+            const auto interpolated = AutomationEvent::interpolateEvents(a.value, b.value,
+                (point.beat - a.beat) / (b.beat - a.beat), curvature);
+            expect(std::abs(point.value - interpolated) <= tolerance);
+        }
+
+        logMessage("Decimated " + String(wobble.size()) + " points into " + String(decimated.size()));
+    }
+};
+
+static MidiRecorderTests midiRecorderTests;
+
+#endif
@@ -25,11 +25,12 @@ class Transport;
 #include "Clip.h"
 #include "Note.h"
 #include "TransportListener.h"
+#include "AnimationClock.h"
 
 class MidiRecorder final : public MidiInputCallback,
                            public TransportListener,
                            private AsyncUpdater,
-                           private Timer
+                           private AnimationClock::Listener
 {
 public:
 
@@ -39,6 +40,43 @@ public:
 
     void setTargetScope(const Clip *clip, const String &instrumentId);
 
+    //===------------------------------------------------------------------===//
+    // Automation recording
+    //===------------------------------------------------------------------===//
+
+    // controllers, pitch bend and channel pressure are recorded into
+    // the automation tracks of the recorded instrument, and the dense
+    // streams are thinned out with the Ramer-Douglas-Peucker algorithm:
+    // the tolerance is the max deviation of the controller value (0..1)
+    // from the resulting curve, zero means keeping every single event
+    void setAutomationTolerance(float tolerance) noexcept;
+    float getAutomationTolerance() const noexcept;
+
+    static constexpr auto defaultAutomationTolerance = 0.01f;
+
+    struct AutomationStats final
+    {
+        int numCapturedEvents = 0;
+        int numInsertedEvents = 0;
+        float lengthInBeats = 0.f;
+
+        float getEventsPerBeat() const noexcept
+        {
+            return this->lengthInBeats > 0.f ?
+                float(this->numCapturedEvents) / this->lengthInBeats : 0.f;
+        }
+
+        float getReductionRatio() const noexcept
+        {
+            return this->numInsertedEvents > 0 ?
+                float(this->numCapturedEvents) / float(this->numInsertedEvents) : 0.f;
+        }
+    };
+
+    // the stats of all controllers from the last finished take,
+    // also logged for each controller when the take is finished
+    AutomationStats getLastAutomationStats() const noexcept;
+
 private:
 
     //===------------------------------------------------------------------===//
@@ -68,10 +106,14 @@ private:
     void handleAsyncUpdate() override;
 
     //===------------------------------------------------------------------===//
-    // Timer
+    // AnimationClock::Listener
     //===------------------------------------------------------------------===//
 
-    void timerCallback() override;
+    void onAnimationFrame(double timeMs) override;
+
+    void startUpdatingHoldingNotes();
+    void stopUpdatingHoldingNotes();
+    bool isUpdatingHoldingNotes = false;
 
 private:
 
@@ -84,20 +126,79 @@ private:
 
     PianoSequence *getPianoSequence() const;
 
-    Array<MidiMessage, CriticalSection> noteOnsBuffer;
-    Array<MidiMessage, CriticalSection> noteOffsBuffer;
-    Array<MidiMessage> unhandledNoteOffs;
+    // the events coming from the midi thread, in the order of arrival,
+    // with the beat estimated at the moment they've arrived; the midi thread
+    // is the only writer, and the message thread is the only reader
+    struct IncomingEvent final
+    {
+        enum class Type : int8
+        {
+            NoteOn,
+            NoteOff,
+            Controller
+        };
+
+        double beat = 0.0;
+        int number = 0; // the key for notes, the controller number for controllers
+        float value = 0.f; // the velocity for notes, 0..1 for controllers
+        Type type = Type::NoteOn;
+    };
+
+    // way more than any controller can send between two async updates,
+    // whatever doesn't fit is dropped, the midi thread never waits
+    static constexpr auto fifoSize = 4096;
+
+    AbstractFifo incomingEventsFifo;
+    HeapBlock<IncomingEvent> incomingEvents;
+
+    // all note-ons and note-offs drained at once
+    // result in a single group insertion and a single group change
+    struct PendingChanges final
+    {
+        Array<Note> notesToInsert;
+        FlatHashMap<int, int> insertedNotesByKey;
+        Array<Note> notesBefore;
+        Array<Note> notesAfter;
+    };
 
     FlatHashMap<int, Note> holdingNotes;
-    void startHoldingNote(MidiMessage message);
+    void startHoldingNote(const IncomingEvent &event, PendingChanges &changes);
+    void finaliseHoldingNote(int key, double beat, PendingChanges &changes);
     void updateLengthsOfHoldingNotes() const;
     void finaliseAllHoldingNotes();
-    bool finaliseHoldingNote(int key);
 
-    double getEstimatedPosition() const;
+    // the recorded controller values are buffered and then decimated
+    // and inserted in chunks, the last inserted point of each chunk
+    // is kept as the anchor for the next one
+    struct AutomationPoint final
+    {
+        float beat = 0.f;
+        float value = 0.f;
+    };
+
+    struct AutomationTake final
+    {
+        WeakReference<MidiTrack> track;
+        Array<AutomationPoint> points;
+        bool hasInsertedAnchor = false;
+        AutomationStats stats;
+        float startBeat = 0.f;
+    };
+
+    FlatHashMap<int, AutomationTake> automationTakes;
+    AutomationStats lastAutomationStats;
+    float automationTolerance = MidiRecorder::defaultAutomationTolerance;
+
+    // flush at least once per beat so that the recorded curve shows up
+    static constexpr auto automationChunkBeats = 1.f;
+
+    void recordControllerValue(const IncomingEvent &event);
+    void flushAutomationTake(AutomationTake &take, bool isTakeFinished);
+    void finaliseAllAutomationTakes();
+    MidiTrack *findOrCreateAutomationTrack(int controllerNumber);
 
-    // no need for updating too often, I guess:
-    static constexpr auto updateTimeHz = 15;
+    double getEstimatedPosition() const;
+    double getEstimatedPositionAt(double timeMs) const;
 
     Atomic<float> lastCorrectPosition = 0.f;
     Atomic<double> lastUpdateTime = 0.0;
@@ -0,0 +1,85 @@
+/*
+    This file is part of Helio Workstation.
+
+    Helio is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Helio is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Helio. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+// Runs the same work function on the calling thread and on a number
+// of helper jobs in the given thread pool at once, and waits for all of them;
+// the work function is expected to take its work items one by one through
+// a shared atomic counter, so that whichever thread is free takes the next one.
+// The helper jobs are reused, so run() can be called repeatedly.
+
+class ParallelWorkers final
+{
+public:
+
+    ParallelWorkers(ThreadPool *pool, int numHelperJobs,
+        const std::function<void()> &work) :
+        pool(pool),
+        work(work)
+    {
+        jassert(pool != nullptr || numHelperJobs <= 0);
+
+        for (int i = 0; this->pool != nullptr && i < numHelperJobs; ++i)
+        {
+            this->helperJobs.add(new HelperJob(work));
+        }
+    }
+
+    void run()
+    {
+        for (auto *job : this->helperJobs)
+        {
+            this->pool->addJob(job, false);
+        }
+
+        this->work();
+
+        for (auto *job : this->helperJobs)
+        {
+            this->pool->waitForJobToFinish(job, -1);
+        }
+    }
+
+private:
+
+    class HelperJob final : public ThreadPoolJob
+    {
+    public:
+
+        explicit HelperJob(const std::function<void()> &work) :
+            ThreadPoolJob("Parallel worker"), work(work) {}
+
+        JobStatus runJob() override
+        {
+            this->work();
+            return jobHasFinished;
+        }
+
+    private:
+
+        const std::function<void()> &work;
+
+        JUCE_DECLARE_NON_COPYABLE(HelperJob)
+    };
+
+    ThreadPool *const pool;
+    const std::function<void()> &work;
+    OwnedArray<HelperJob> helperJobs;
+
+    JUCE_DECLARE_NON_COPYABLE(ParallelWorkers)
+};
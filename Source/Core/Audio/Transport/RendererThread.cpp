@@ -17,8 +17,10 @@
 
 #include "Common.h"
 #include "RendererThread.h"
+#include "ParallelWorkers.h"
 #include "Workspace.h"
 #include "AudioCore.h"
+#include "BuiltInSynthAudioPlugin.h"
 
 RendererThread::RendererThread(Transport &parentTransport) :
     Thread("RendererThread"),
@@ -42,6 +44,18 @@ bool RendererThread::startRendering(const URL &target, RenderFormat format,
     this->format = format;
     this->context = playbackContext;
 
+    // with no audio device opened (e.g. in the command line batch mode),
+    // the instruments are not configured yet, so fall back to the defaults:
+    if (this->context->sampleRate <= 0.0)
+    {
+        this->context->sampleRate = RendererThread::defaultSampleRate;
+    }
+
+    if (this->context->numOutputChannels <= 0)
+    {
+        this->context->numOutputChannels = RendererThread::defaultNumOutputChannels;
+    }
+
     // keep the url copy alive while rendering,
     // since on iOS it contains a security bookmark:
     this->renderTarget = target;
@@ -116,21 +130,69 @@ bool RendererThread::isRendering() const
 struct RenderBuffer final
 {
     Instrument *instrument;
+    // not null, if the instrument is rendered directly, bypassing its graph
+    BuiltInSynthAudioPlugin *synth = nullptr;
     AudioBuffer<float> sampleBuffer;
     MidiBuffer midiBuffer;
 };
 
+// returns the built-in synth, if the instrument is nothing more than
+// a midi input -> synth -> audio outputs chain, so that the synth
+// can be rendered directly without the processor graph machinery
+static BuiltInSynthAudioPlugin *findDirectlyRenderableSynth(const Instrument *instrument, int numOutChannels)
+{
+    const auto mainNode = instrument->findMainPluginNode();
+    if (mainNode == nullptr)
+    {
+        return nullptr;
+    }
+
+    auto *synth = dynamic_cast<BuiltInSynthAudioPlugin *>(mainNode->getProcessor());
+    if (synth == nullptr)
+    {
+        return nullptr;
+    }
+
+    bool hasMidiInput = false;
+    BigInteger connectedOutputs;
+
+    for (const auto &connection : instrument->getConnections())
+    {
+        if (connection.destination.nodeID == mainNode->nodeID &&
+            connection.destination.channelIndex == Instrument::midiChannelNumber)
+        {
+            hasMidiInput = true;
+        }
+        else if (connection.source.nodeID == mainNode->nodeID &&
+            connection.source.channelIndex == connection.destination.channelIndex)
+        {
+            connectedOutputs.setBit(connection.destination.channelIndex);
+        }
+    }
+
+    // the synth writes the same signal into all channels of the buffer,
+    // so the graph should pass all of them through to give the same result
+    for (int i = 0; i < numOutChannels; ++i)
+    {
+        if (!connectedOutputs[i])
+        {
+            return nullptr;
+        }
+    }
+
+    return hasMidiInput ? synth : nullptr;
+}
+
 void RendererThread::run()
 {
     // step 0. init.
     this->transport.recacheIfNeeded();
     auto sequences = this->transport.getPlaybackCache();
-    constexpr auto bufferSize = 512;
 
     // assuming that number of channels and sample rate is equal for all instruments
-    const int numOutChannels = sequences.getNumOutputChannels();
+    const int numOutChannels = this->context->numOutputChannels;
     const int numInChannels = sequences.getNumInputChannels();
-    const double sampleRate = sequences.getSampleRate();
+    const double sampleRate = this->context->sampleRate;
     const double totalTimeMs = this->context->totalTimeMs;
     const double msPerQuarter = this->context->startBeatTempo;
     double secPerQuarter = msPerQuarter / 1000.0;
@@ -138,23 +200,54 @@ void RendererThread::run()
     double currentFrame = 0.0;
     const double lastFrame = totalTimeMs / 1000.0 * sampleRate;
 
-    // step 1. create a list of unique instruments with audio buffers for them.
+    // step 1. create a list of unique instruments with audio buffers for them,
+    // and see which of them can be rendered directly: the built-in synths
+    // can process large blocks, and since they don't share any state,
+    // all of them can be rendered concurrently.
     OwnedArray<RenderBuffer> subBuffers;
+    Array<RenderBuffer *> synthBuffers;
+    Array<RenderBuffer *> graphBuffers;
     Array<Instrument *> uniqueInstruments;
     uniqueInstruments.addArray(sequences.getUniqueInstruments());
 
-    for (int i = 0; i < uniqueInstruments.size(); ++i)
+    for (auto *instrument : uniqueInstruments)
     {
-        Instrument *instrument = uniqueInstruments[i];
-        auto *subBuffer = new RenderBuffer();
+        auto *subBuffer = subBuffers.add(new RenderBuffer());
         subBuffer->instrument = instrument;
-        subBuffer->sampleBuffer = AudioBuffer<float>(numOutChannels, bufferSize);
-        subBuffers.add(subBuffer);
+        subBuffer->synth = findDirectlyRenderableSynth(instrument, numOutChannels);
+
+        if (subBuffer->synth != nullptr)
+        {
+            synthBuffers.add(subBuffer);
+        }
+        else
+        {
+            graphBuffers.add(subBuffer);
+        }
+
         //DBG("Adding instrument: " + String(instrument->getName()));
     }
 
-    // step 2. release resources, prepare to play, etc.
+    const int bufferSize = graphBuffers.isEmpty() ?
+        int(RendererThread::directRenderBlockSize) : int(RendererThread::graphRenderBlockSize);
+
     for (auto *subBuffer : subBuffers)
+    {
+        subBuffer->sampleBuffer = AudioBuffer<float>(numOutChannels, bufferSize);
+    }
+
+    // step 2. release resources, prepare to play, etc.
+    for (auto *subBuffer : synthBuffers)
+    {
+        // the synth is still in the graph, which may be playing,
+        // so don't re-prepare it in the middle of its callback
+        const ScopedLock lock(subBuffer->instrument->getProcessorGraph()->getCallbackLock());
+        subBuffer->synth->setNonRealtime(true);
+        subBuffer->synth->prepareToPlay(sampleRate, bufferSize);
+        subBuffer->synth->reset();
+    }
+
+    for (auto *subBuffer : graphBuffers)
     {
         AudioProcessorGraph *graph = subBuffer->instrument->getProcessorGraph();
         graph->setPlayConfigDetails(numInChannels, numOutChannels, sampleRate, bufferSize);
@@ -164,8 +257,36 @@ void RendererThread::run()
         graph->setNonRealtime(true);
     }
 
-    // let the processor graphs handle their async updates
-    Thread::sleep(200);
+    if (!graphBuffers.isEmpty())
+    {
+        // let the processor graphs handle their async updates
+        Thread::sleep(200);
+    }
+
+    std::atomic<int> nextSynthIndex(0);
+    const std::function<void()> renderRemainingSynths = [&]()
+    {
+        for (int i = nextSynthIndex++; i < synthBuffers.size(); i = nextSynthIndex++)
+        {
+            auto *subBuffer = synthBuffers.getUnchecked(i);
+            const ScopedLock lock(subBuffer->instrument->getProcessorGraph()->getCallbackLock());
+            subBuffer->synth->processBlock(subBuffer->sampleBuffer, subBuffer->midiBuffer);
+            subBuffer->midiBuffer.clear();
+        }
+    };
+
+    const auto numHelperJobs = jmin(SystemStats::getNumCpus(), synthBuffers.size()) - 1;
+
+    UniquePointer<ThreadPool> renderThreadPool;
+    if (numHelperJobs > 0)
+    {
+        renderThreadPool = make<ThreadPool>(numHelperJobs);
+    }
+
+    ParallelWorkers synthRenderers(renderThreadPool.get(),
+        numHelperJobs, renderRemainingSynths);
+
+    const auto renderStartMs = Time::getMillisecondCounterHiRes();
 
     // step 3. render loop itself.
     sequences.seekToTime(0.0);
@@ -234,8 +355,13 @@ void RendererThread::run()
             nextEventTick = lastEventTick + nextEventTickDelta;
         }
 
-        // step 3b. call processBlock for every instrument.
-        for (auto *subBuffer : subBuffers)
+        // step 3b. call processBlock for every instrument:
+        // the synths are shared between the helper jobs and this thread,
+        // and then the graphs are processed one by one.
+        nextSynthIndex = 0;
+        synthRenderers.run();
+
+        for (auto *subBuffer : graphBuffers)
         {
             auto *graph = subBuffer->instrument->getProcessorGraph();
             {
@@ -282,8 +408,26 @@ void RendererThread::run()
         //DBG("this->percentsDone : " + String(this->percentsDone));
     }
 
+    DBG("Rendered " + String(currentFrame / sampleRate, 1) + " seconds in " +
+        String((Time::getMillisecondCounterHiRes() - renderStartMs) / 1000.0, 1) + " seconds, " +
+        String(synthBuffers.size()) + " synths rendered directly, " +
+        String(graphBuffers.size()) + " graphs processed");
+
     // step 4. setNonRealtime false.
-    for (auto *subBuffer : subBuffers)
+    for (auto *subBuffer : synthBuffers)
+    {
+        // restore the synth's settings for the realtime playback
+        const auto *graph = subBuffer->instrument->getProcessorGraph();
+        const ScopedLock lock(graph->getCallbackLock());
+        subBuffer->synth->setNonRealtime(false);
+        subBuffer->synth->reset();
+        if (graph->getSampleRate() > 0.0)
+        {
+            subBuffer->synth->prepareToPlay(graph->getSampleRate(), graph->getBlockSize());
+        }
+    }
+
+    for (auto *subBuffer : graphBuffers)
     {
         auto *graph = subBuffer->instrument->getProcessorGraph();
         graph->setNonRealtime(false);
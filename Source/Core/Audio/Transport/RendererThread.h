@@ -57,5 +57,13 @@ private:
 
     Atomic<float> percentsDone = 0.f;
 
+    static constexpr auto defaultSampleRate = 44100.0;
+    static constexpr auto defaultNumOutputChannels = 2;
+
+    // the built-in synths are rendered in larger blocks, but only
+    // when none of the instruments needs the processor graph
+    static constexpr auto graphRenderBlockSize = 512;
+    static constexpr auto directRenderBlockSize = 4096;
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(RendererThread)
 };
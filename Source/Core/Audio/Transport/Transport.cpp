@@ -21,6 +21,7 @@
 #include "RendererThread.h"
 #include "PlayerThread.h"
 #include "PlayerThreadPool.h"
+#include "ParallelWorkers.h"
 #include "MidiSequence.h"
 #include "MidiTrack.h"
 #include "Pattern.h"
@@ -39,12 +40,14 @@ Transport::Transport(OrchestraPit &orchestraPit, SleepTimer &sleepTimer) :
 {
     this->player = make<PlayerThreadPool>(*this);
     this->renderer = make<RendererThread>(*this);
+    this->exportThreadPool = make<ThreadPool>(jmax(1, SystemStats::getNumCpus() - 1));
     this->orchestra.addOrchestraListener(this);
 }
 
 Transport::~Transport()
 {
     this->orchestra.removeOrchestraListener(this);
+    this->exportThreadPool = nullptr;
     this->renderer = nullptr;
     this->player = nullptr;
     this->transportListeners.clear();
@@ -404,9 +407,9 @@ Transport::NotePreviewTimer::~NotePreviewTimer()
 
 void Transport::NotePreviewTimer::cancelAllPendingPreviews(bool sendRemainingNoteOffs)
 {
-    if (this->isTimerRunning())
+    if (this->isTicking)
     {
-        this->stopTimer();
+        this->stopTicking();
         for (int key = 0; key < NotePreviewTimer::numPreviewedKeys; ++key)
         {
             auto &preview = this->previews[key];
@@ -451,18 +454,37 @@ void Transport::NotePreviewTimer::previewNote(WeakReference<Instrument> instrume
     }
 
     preview.volume = volume;
-    preview.noteOnTimeoutMs = NotePreviewTimer::timerTickMs;
+    preview.noteOnTimeoutMs = NotePreviewTimer::noteOnDelayMs;
     preview.noteOffTimeoutMs = noteOffTimeoutMs;
     preview.instrument = instrument;
 
-    if (!this->isTimerRunning())
+    this->startTicking();
+}
+
+void Transport::NotePreviewTimer::startTicking()
+{
+    if (!this->isTicking)
+    {
+        this->isTicking = true;
+        this->lastTickTimeMs = Time::getMillisecondCounterHiRes();
+        App::AnimationClock().addListener(this, AnimationClock::Priority::Low);
+    }
+}
+
+void Transport::NotePreviewTimer::stopTicking()
+{
+    if (this->isTicking)
     {
-        this->startTimer(NotePreviewTimer::timerTickMs);
+        this->isTicking = false;
+        App::AnimationClock().removeListener(this);
     }
 }
 
-void Transport::NotePreviewTimer::timerCallback()
+void Transport::NotePreviewTimer::onAnimationFrame(double timeMs)
 {
+    const auto elapsedMs = int16(jlimit(0.0, 1000.0, timeMs - this->lastTickTimeMs));
+    this->lastTickTimeMs = timeMs;
+
 #if PLATFORM_MOBILE
     // iSEM tends to hang >_< if too many messages are send simultaniously
     const auto time = TIME_NOW + float(rand() % 50) * 0.01;
@@ -477,7 +499,7 @@ void Transport::NotePreviewTimer::timerCallback()
         if (preview.noteOnTimeoutMs > 0)
         {
             canStop = false;
-            preview.noteOnTimeoutMs -= NotePreviewTimer::timerTickMs;
+            preview.noteOnTimeoutMs -= elapsedMs;
 
             if (preview.noteOnTimeoutMs <= 0 && preview.instrument != nullptr)
             {
@@ -492,7 +514,7 @@ void Transport::NotePreviewTimer::timerCallback()
         else if (preview.noteOffTimeoutMs > 0)
         {
             canStop = false;
-            preview.noteOffTimeoutMs -= NotePreviewTimer::timerTickMs;
+            preview.noteOffTimeoutMs -= elapsedMs;
 
             if (preview.noteOffTimeoutMs <= 0 && preview.instrument != nullptr)
             {
@@ -508,7 +530,7 @@ void Transport::NotePreviewTimer::timerCallback()
 
     if (canStop)
     {
-        this->stopTimer();
+        this->stopTicking();
     }
 }
 
@@ -929,6 +951,88 @@ Transport::PlaybackContext::Ptr Transport::fillPlaybackContextAt(float beat) con
 // Playback cache management
 //===----------------------------------------------------------------------===//
 
+// Exporting clips one by one into the same sequence would mean a sorted
+// insertion for each message and re-matching all note pairs for each clip,
+// which gets really slow for the clip-heavy tracks; instead, all clips are
+// exported into a flat buffer, which is sorted once (stable sort keeps
+// the order of simultaneous events the same as the sorted insertion did),
+// and the note-offs are matched in a single pass while building the sequence
+static void exportTrackForPlayback(MidiMessageSequence &outSequence,
+    const MidiTrack *track, const KeyboardMapping &keyMap,
+    const Clip &noTransform, bool hasSoloClips, double offset)
+{
+    const auto *sequence = track->getSequence();
+
+    Array<MidiMessage> messages;
+    MidiMessageSequence clipSequence;
+
+    const auto exportClip = [&](const Clip &clip)
+    {
+        clipSequence.clear();
+        sequence->exportMidi(clipSequence, clip, keyMap, hasSoloClips, offset, 1.0);
+        for (const auto *holder : clipSequence)
+        {
+            messages.add(holder->message);
+        }
+    };
+
+    if (track->getPattern() != nullptr)
+    {
+        for (const auto *clip : track->getPattern()->getClips())
+        {
+            exportClip(*clip);
+        }
+    }
+    else
+    {
+        exportClip(noTransform);
+    }
+
+    std::stable_sort(messages.begin(), messages.end(),
+        [](const MidiMessage &a, const MidiMessage &b)
+        {
+            return a.getTimeStamp() < b.getTimeStamp();
+        });
+
+    // the same rules as in MidiMessageSequence::updateMatchedPairs:
+    // a note-on with no note-off before the next note-on
+    // of the same key gets a note-off inserted right before that
+    using Holder = MidiMessageSequence::MidiEventHolder;
+    Holder *pendingNoteOns[16][128] = {};
+
+    // the messages are sorted, so each addEvent is just an append
+    for (const auto &message : messages)
+    {
+        if (message.isNoteOn())
+        {
+            auto *&pending = pendingNoteOns[message.getChannel() - 1][message.getNoteNumber()];
+            if (pending != nullptr)
+            {
+                auto *noteOff = outSequence.addEvent(MidiMessage::noteOff(message.getChannel(),
+                    message.getNoteNumber()).withTimeStamp(message.getTimeStamp()));
+                pending->noteOffObject = noteOff;
+            }
+
+            pending = outSequence.addEvent(message);
+            pending->noteOffObject = nullptr;
+        }
+        else if (message.isNoteOff())
+        {
+            auto *&pending = pendingNoteOns[message.getChannel() - 1][message.getNoteNumber()];
+            auto *noteOff = outSequence.addEvent(message);
+            if (pending != nullptr)
+            {
+                pending->noteOffObject = noteOff;
+                pending = nullptr;
+            }
+        }
+        else
+        {
+            outSequence.addEvent(message);
+        }
+    }
+}
+
 void Transport::recacheIfNeeded() const
 {
     if (this->playbackCacheIsOutdated.get())
@@ -950,30 +1054,39 @@ void Transport::recacheIfNeeded() const
             }
         }
 
+        // instrument lookups are done here, so that export jobs
+        // only read the tracks and write into their own sequences
+        ReferenceCountedArray<CachedMidiSequence> exported;
+        exported.ensureStorageAllocated(this->tracksCache.size());
         for (const auto *track : this->tracksCache)
         {
             const auto instrument = this->linksCache[track->getTrackId()];
-            const auto &keyMap = *instrument->getKeyboardMapping();
-
-            auto cached = CachedMidiSequence::createFrom(instrument, track->getSequence());
+            exported.add(CachedMidiSequence::createFrom(instrument, track->getSequence()));
+        }
 
-            if (track->getPattern() != nullptr)
-            {
-                for (const auto *clip : track->getPattern()->getClips())
-                {
-                    cached->track->exportMidi(cached->midiMessages, *clip,
-                        keyMap, hasSoloClips, offset, 1.0);
-                }
-            }
-            else
+        std::atomic<int> nextTrackIndex(0);
+        const std::function<void()> exportRemainingTracks = [&]()
+        {
+            for (int i = nextTrackIndex++; i < exported.size(); i = nextTrackIndex++)
             {
-                cached->track->exportMidi(cached->midiMessages, noTransform,
-                    keyMap, hasSoloClips, offset, 1.0);
+                auto *cached = exported.getObjectPointerUnchecked(i);
+                exportTrackForPlayback(cached->midiMessages, this->tracksCache.getUnchecked(i),
+                    *cached->instrument->getKeyboardMapping(), noTransform, hasSoloClips, offset);
             }
+        };
+
+        const auto numHelperJobs = exported.size() < Transport::minTracksForParallelExport ? 0 :
+            jmin(this->exportThreadPool->getNumThreads(), exported.size() - 1);
+
+        ParallelWorkers(this->exportThreadPool.get(),
+            numHelperJobs, exportRemainingTracks).run();
 
+        // keep the track order, as it was before
+        for (auto *cached : exported)
+        {
             this->playbackCache.addWrapper(cached);
         }
-        
+
         this->playbackCacheIsOutdated = false;
     }
 }
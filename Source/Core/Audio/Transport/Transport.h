@@ -29,6 +29,7 @@ class RendererThread;
 #include "ProjectListener.h"
 #include "RenderFormat.h"
 #include "Instrument.h"
+#include "AnimationClock.h"
 
 class Transport final : public Serializable,
                         public ProjectListener,
@@ -231,6 +232,11 @@ private:
     mutable Atomic<bool> playbackCacheIsOutdated = true;
     void recacheIfNeeded() const;
 
+    // tracks are exported independently, so the recache
+    // splits the work between the calling thread and this pool:
+    UniquePointer<ThreadPool> exportThreadPool;
+    static constexpr auto minTracksForParallelExport = 4;
+
     // linksCache is <track id : instrument>
     mutable Array<const MidiTrack *> tracksCache;
     mutable FlatHashMap<String, WeakReference<Instrument>, StringHash> linksCache;
@@ -243,7 +249,9 @@ private:
 
 private:
 
-    class NotePreviewTimer final : private Timer
+    // previews are scheduled with the shared clock's low priority updates,
+    // which are not suspended when the app goes to background:
+    class NotePreviewTimer final : private AnimationClock::Listener
     {
     public:
 
@@ -256,7 +264,12 @@ private:
 
     private:
 
-        void timerCallback() override;
+        void onAnimationFrame(double timeMs) override;
+
+        void startTicking();
+        void stopTicking();
+        bool isTicking = false;
+        double lastTickTimeMs = 0.0;
 
         struct KeyPreviewState final
         {
@@ -266,7 +279,9 @@ private:
             int16 noteOffTimeoutMs = 0;
         };
 
-        static constexpr auto timerTickMs = 50;
+        // note-ons are postponed a bit, so that
+        // quickly repeated previews of the same key are merged:
+        static constexpr auto noteOnDelayMs = 50;
         static constexpr auto numPreviewedKeys =
             Globals::numChannels * Globals::twelveToneKeyboardSize;
 
@@ -55,7 +55,7 @@ const CommandPaletteActionsProvider::Actions &CommandPaletteMoveNotesMenu::getAc
         return this->actionsCache;
     }
 
-    for (auto *targetTrack : this->project.findChildrenOfType<PianoTrackNode>())
+    for (auto *targetTrack : this->project.getPianoTracks())
     {
         if (targetTrack == this->roll.getActiveTrack())
         {
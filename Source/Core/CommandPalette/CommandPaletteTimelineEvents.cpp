@@ -162,7 +162,7 @@ const CommandPaletteActionsProvider::Actions &CommandPaletteTimelineEvents::getA
     {
         this->clipActionsCache.clearQuick();
 
-        for (auto *pianoTrackNode : this->project.findChildrenOfType<PianoTrackNode>())
+        for (auto *pianoTrackNode : this->project.getPianoTracks())
         {
             const auto *sequence = pianoTrackNode->getSequence();
             for (const auto *clip : pianoTrackNode->getPattern()->getClips())
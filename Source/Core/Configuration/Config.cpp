@@ -81,14 +81,66 @@ void Config::initResources()
         }
     }
 
-    for (auto &manager : this->resources)
+    const auto startTimeMs = Time::getMillisecondCounterHiRes();
+
+    // the first screen needs translations, colours and hotkeys right away,
+    // all the others are loaded on demand, or warmed up in the background
+    using namespace Serialization::Resources;
+    for (const auto &resourceType : { translations, colourSchemes, hotkeySchemes })
     {
-        manager.second->reloadResources();
+        this->resources[resourceType]->reloadResources();
     }
 
+    this->resourcesLoader = make<ThreadPool>(1);
+    this->resourcesLoader->addJob([this, startTimeMs]()
+    {
+        for (auto &manager : this->resources)
+        {
+            manager.second->loadIfNeeded();
+        }
+
+        this->logResourcesTimeline(startTimeMs);
+    });
+
     this->load(this->uiFlags.get(), Serialization::Config::activeUiFlags);
 }
 
+void Config::logResourcesTimeline(double startTimeMs) const
+{
+    Array<ResourceManager::LoadingStats> allStats;
+    Array<Identifier> resourceTypes;
+
+    for (const auto &manager : this->resources)
+    {
+        const auto stats = manager.second->getLoadingStats();
+
+        int index = 0;
+        while (index < allStats.size() && allStats.getReference(index).startTimeMs < stats.startTimeMs)
+        {
+            index++;
+        }
+
+        allStats.insert(index, stats);
+        resourceTypes.insert(index, manager.second->getResourceType());
+    }
+
+    String timeline("Resources loading timeline:");
+    for (int i = 0; i < allStats.size(); ++i)
+    {
+        const auto &stats = allStats.getReference(i);
+        const auto totalMs = stats.builtInMs + stats.downloadedMs + stats.userMs;
+        timeline << newLine << "  +" << String(stats.startTimeMs - startTimeMs, 1) << " ms "
+            << resourceTypes[i].toString() << ": " << String(totalMs, 1) << " ms ("
+            << String(stats.builtInMs, 1) << " built-in, "
+            << String(stats.downloadedMs, 1) << " downloaded, "
+            << String(stats.userMs, 1) << " user), "
+            << stats.numResources << " items, "
+            << (stats.loadedOnMessageThread ? "message thread" : "background");
+    }
+
+    Logger::writeToLog(timeline);
+}
+
 void Config::save(const Serializable *serializable, const Identifier &key)
 {
     SerializedData root(key);
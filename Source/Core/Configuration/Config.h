@@ -63,6 +63,8 @@ private:
     void onConfigChanged();
     bool saveIfNeeded();
 
+    void logResourcesTimeline(double startTimeMs) const;
+
     void timerCallback() override;
 
     InterProcessLock fileLock;
@@ -82,6 +84,10 @@ private:
 
     ResourceManagerLookup resources;
 
+    // warms up the resources not needed by the first screen,
+    // destroyed before the managers, waiting for the job to finish
+    UniquePointer<ThreadPool> resourcesLoader;
+
     UniquePointer<UserInterfaceFlags> uiFlags;
 
     bool needsSaving = false;
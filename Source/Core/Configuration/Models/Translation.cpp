@@ -55,9 +55,9 @@ void Translation::deserialize(const SerializedData &data)
     this->id = root.getProperty(Translations::localeId).toString().toLowerCase();
     this->name = root.getProperty(Translations::localeName);
 
-    this->pluralEquation = Translations::wrapperClassName + "." +
-        Translations::wrapperMethodName + "(" +
-        root.getProperty(Translations::pluralEquation, "1").toString() + ")";
+    const auto equation = root.getProperty(Translations::pluralEquation, "1").toString();
+    const auto compiled = this->pluralEquation.compile(equation);
+    jassert(compiled);
 
     forEachChildWithType(root, pluralLiteral, Translations::pluralLiteral)
     {
@@ -151,6 +151,7 @@ void Translation::reset()
 {
     this->singulars.clear();
     this->plurals.clear();
+    this->deferredData.clear();
 }
 
 //===----------------------------------------------------------------------===//
@@ -166,3 +167,334 @@ Identifier Translation::getResourceType() const noexcept
 {
     return Serialization::Resources::translations;
 }
+
+//===----------------------------------------------------------------------===//
+// Plural equation
+//===----------------------------------------------------------------------===//
+
+// A recursive descent parser, which follows the C operator precedence
+struct Translation::PluralEquation::Parser final
+{
+    Parser(PluralEquation &target, const String &text) :
+        target(target), t(text.getCharPointer()) {}
+
+    int parseCondition()
+    {
+        const auto condition = this->parseOr();
+        if (condition < 0 || !this->skip("?"))
+        {
+            return condition;
+        }
+
+        const auto whenTrue = this->parseCondition();
+        if (whenTrue < 0 || !this->skip(":"))
+        {
+            return -1;
+        }
+
+        const auto whenFalse = this->parseCondition();
+        if (whenFalse < 0)
+        {
+            return -1;
+        }
+
+        return this->target.addNode(Operation::Condition, condition, whenTrue, whenFalse);
+    }
+
+    int parseOr()
+    {
+        auto a = this->parseAnd();
+        while (a >= 0 && this->skip("||"))
+        {
+            a = this->binary(Operation::Or, a, this->parseAnd());
+        }
+
+        return a;
+    }
+
+    int parseAnd()
+    {
+        auto a = this->parseEquality();
+        while (a >= 0 && this->skip("&&"))
+        {
+            a = this->binary(Operation::And, a, this->parseEquality());
+        }
+
+        return a;
+    }
+
+    int parseEquality()
+    {
+        auto a = this->parseRelational();
+        while (a >= 0)
+        {
+            if (this->skip("==")) { a = this->binary(Operation::Equal, a, this->parseRelational()); }
+            else if (this->skip("!=")) { a = this->binary(Operation::NotEqual, a, this->parseRelational()); }
+            else { break; }
+        }
+
+        return a;
+    }
+
+    int parseRelational()
+    {
+        auto a = this->parseAdditive();
+        while (a >= 0)
+        {
+            if (this->skip("<=")) { a = this->binary(Operation::LessOrEqual, a, this->parseAdditive()); }
+            else if (this->skip(">=")) { a = this->binary(Operation::GreaterOrEqual, a, this->parseAdditive()); }
+            else if (this->skip("<")) { a = this->binary(Operation::Less, a, this->parseAdditive()); }
+            else if (this->skip(">")) { a = this->binary(Operation::Greater, a, this->parseAdditive()); }
+            else { break; }
+        }
+
+        return a;
+    }
+
+    int parseAdditive()
+    {
+        auto a = this->parseMultiplicative();
+        while (a >= 0)
+        {
+            if (this->skip("+")) { a = this->binary(Operation::Add, a, this->parseMultiplicative()); }
+            else if (this->skip("-")) { a = this->binary(Operation::Subtract, a, this->parseMultiplicative()); }
+            else { break; }
+        }
+
+        return a;
+    }
+
+    int parseMultiplicative()
+    {
+        auto a = this->parseUnary();
+        while (a >= 0)
+        {
+            if (this->skip("*")) { a = this->binary(Operation::Multiply, a, this->parseUnary()); }
+            else if (this->skip("/")) { a = this->binary(Operation::Divide, a, this->parseUnary()); }
+            else if (this->skip("%")) { a = this->binary(Operation::Modulo, a, this->parseUnary()); }
+            else { break; }
+        }
+
+        return a;
+    }
+
+    int parseUnary()
+    {
+        // mind the "!=" operator, which is not expected here anyway
+        if (this->skip("!"))
+        {
+            const auto a = this->parseUnary();
+            return a < 0 ? -1 : this->target.addNode(Operation::Not, a);
+        }
+
+        if (this->skip("-"))
+        {
+            const auto a = this->parseUnary();
+            return a < 0 ? -1 : this->target.addNode(Operation::Negate, a);
+        }
+
+        return this->parsePrimary();
+    }
+
+    int parsePrimary()
+    {
+        if (this->skip("("))
+        {
+            const auto a = this->parseCondition();
+            return (a >= 0 && this->skip(")")) ? a : -1;
+        }
+
+        // the meta symbol is the argument, but "n" is also supported,
+        // as used in the plural forms of gettext
+        if (this->skip(Serialization::Translations::metaSymbol.toString().toRawUTF8()) || this->skip("n"))
+        {
+            return this->target.addNode(Operation::Argument);
+        }
+
+        this->skipWhitespace();
+        if (!this->t.isDigit())
+        {
+            return -1;
+        }
+
+        int64 value = 0;
+        while (this->t.isDigit())
+        {
+            value = value * 10 + (this->t.getAndAdvance() - '0');
+        }
+
+        return this->target.addNode(Operation::Constant, -1, -1, -1, value);
+    }
+
+    int binary(Operation operation, int a, int b)
+    {
+        return b < 0 ? -1 : this->target.addNode(operation, a, b);
+    }
+
+    void skipWhitespace()
+    {
+        this->t.incrementToEndOfWhitespace();
+    }
+
+    bool skip(const char *token)
+    {
+        this->skipWhitespace();
+
+        auto p = this->t;
+        for (auto *c = token; *c != 0; ++c)
+        {
+            if (p.getAndAdvance() != juce_wchar(*c))
+            {
+                return false;
+            }
+        }
+
+        this->t = p;
+        return true;
+    }
+
+    bool isAtEnd()
+    {
+        this->skipWhitespace();
+        return this->t.isEmpty();
+    }
+
+    PluralEquation &target;
+    String::CharPointerType t;
+};
+
+bool Translation::PluralEquation::compile(const String &equation)
+{
+    this->nodes.clearQuick();
+
+    Parser parser(*this, equation);
+    this->rootNode = parser.parseCondition();
+
+    if (this->rootNode < 0 || !parser.isAtEnd())
+    {
+        this->nodes.clear();
+        this->rootNode = -1;
+        return false;
+    }
+
+    return true;
+}
+
+bool Translation::PluralEquation::isValid() const noexcept
+{
+    return this->rootNode >= 0;
+}
+
+int64 Translation::PluralEquation::evaluate(int64 x) const noexcept
+{
+    jassert(this->isValid());
+    return this->isValid() ? this->evaluate(this->rootNode, x) : 0;
+}
+
+int64 Translation::PluralEquation::evaluate(int nodeIndex, int64 x) const noexcept
+{
+    const auto &node = this->nodes.getReference(nodeIndex);
+    const auto a = [&]() { return this->evaluate(node.arguments[0], x); };
+    const auto b = [&]() { return this->evaluate(node.arguments[1], x); };
+
+    switch (node.operation)
+    {
+        case Operation::Constant: return node.value;
+        case Operation::Argument: return x;
+        case Operation::Negate: return -a();
+        case Operation::Not: return a() == 0 ? 1 : 0;
+        case Operation::Multiply: return a() * b();
+        case Operation::Divide: { const auto d = b(); return d == 0 ? 0 : a() / d; }
+        case Operation::Modulo: { const auto d = b(); return d == 0 ? 0 : a() % d; }
+        case Operation::Add: return a() + b();
+        case Operation::Subtract: return a() - b();
+        case Operation::Less: return a() < b() ? 1 : 0;
+        case Operation::LessOrEqual: return a() <= b() ? 1 : 0;
+        case Operation::Greater: return a() > b() ? 1 : 0;
+        case Operation::GreaterOrEqual: return a() >= b() ? 1 : 0;
+        case Operation::Equal: return a() == b() ? 1 : 0;
+        case Operation::NotEqual: return a() != b() ? 1 : 0;
+        case Operation::And: return (a() != 0 && b() != 0) ? 1 : 0;
+        case Operation::Or: return (a() != 0 || b() != 0) ? 1 : 0;
+        case Operation::Condition:
+            return this->evaluate(node.arguments[a() != 0 ? 1 : 2], x);
+        default: return 0;
+    }
+}
+
+int Translation::PluralEquation::addNode(Operation operation, int a, int b, int c, int64 value)
+{
+    this->nodes.add(Node{ operation, value, { a, b, c } });
+    return this->nodes.size() - 1;
+}
+
+//===----------------------------------------------------------------------===//
+// Tests
+//===----------------------------------------------------------------------===//
+
+#if JUCE_UNIT_TESTS
+
+class PluralEquationTests final : public UnitTest
+{
+public:
+    PluralEquationTests() : UnitTest("Plural equation tests", UnitTestCategories::helio) {}
+
+    void runTest() override
+    {
+        beginTest("Built-in plural equations");
+
+        {
+            Translation::PluralEquation english;
+            expect(english.compile("({x}==1 ? 1 : 2)"));
+            expectEquals(english.evaluate(0), int64(2));
+            expectEquals(english.evaluate(1), int64(1));
+            expectEquals(english.evaluate(21), int64(2));
+
+            Translation::PluralEquation russian;
+            expect(russian.compile("({x}%10==1 && {x}%100!=11 ? 1 : "
+                "{x}%10>=2 && {x}%10<=4 && ({x}%100<10 || {x}%100>=20) ? 2 : 3)"));
+
+            const int64 numbers[] = { 0, 1, 2, 4, 5, 11, 12, 14, 21, 22, 25, 101, 111, 1002 };
+            const int64 forms[] = { 3, 1, 2, 2, 3, 3, 3, 3, 1, 2, 3, 1, 3, 2 };
+            for (int i = 0; i < numElementsInArray(numbers); ++i)
+            {
+                expectEquals(russian.evaluate(numbers[i]), forms[i]);
+            }
+
+            Translation::PluralEquation french;
+            expect(french.compile("(({x}==0 || {x}==1) ? 1 : 2)"));
+            expectEquals(french.evaluate(0), int64(1));
+            expectEquals(french.evaluate(2), int64(2));
+
+            Translation::PluralEquation chinese;
+            expect(chinese.compile("1"));
+            expectEquals(chinese.evaluate(100), int64(1));
+        }
+
+        beginTest("Operators precedence and invalid equations");
+
+        {
+            Translation::PluralEquation equation;
+            expect(equation.compile("1 + 2 * {x} - -3 % 2"));
+            expectEquals(equation.evaluate(5), int64(1 + 2 * 5 - (-3 % 2)));
+
+            expect(equation.compile("n != 1 && !(n > 10)"));
+            expectEquals(equation.evaluate(1), int64(0));
+            expectEquals(equation.evaluate(5), int64(1));
+            expectEquals(equation.evaluate(11), int64(0));
+
+            expect(equation.compile("{x} / 0 + {x} % 0"));
+            expectEquals(equation.evaluate(7), int64(0));
+
+            expect(!equation.compile(""));
+            expect(!equation.compile("({x} == 1 ? 1"));
+            expect(!equation.compile("{x} == 1 ? 1 : 2)"));
+            expect(!equation.compile("pluralForm.detect({x})"));
+            expect(!equation.isValid());
+        }
+    }
+};
+
+static PluralEquationTests pluralEquationTests;
+
+#endif
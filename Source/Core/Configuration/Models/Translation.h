@@ -25,6 +25,45 @@ public:
 
     using Ptr = ReferenceCountedObjectPtr<Translation>;
 
+    // Plural form equations, like "({x}==1 ? 1 : 2)", are compiled once
+    // into a tiny expression tree, and evaluated without any script engine;
+    // supports integer arithmetic, comparisons, logic and ternary operators
+    class PluralEquation final
+    {
+    public:
+
+        bool compile(const String &equation);
+        bool isValid() const noexcept;
+
+        int64 evaluate(int64 x) const noexcept;
+
+    private:
+
+        enum class Operation : int8
+        {
+            Constant, Argument,
+            Negate, Not,
+            Multiply, Divide, Modulo, Add, Subtract,
+            Less, LessOrEqual, Greater, GreaterOrEqual, Equal, NotEqual,
+            And, Or, Condition
+        };
+
+        struct Node final
+        {
+            Operation operation;
+            int64 value;
+            int arguments[3];
+        };
+
+        Array<Node> nodes;
+        int rootNode = -1;
+
+        int64 evaluate(int nodeIndex, int64 x) const noexcept;
+        int addNode(Operation operation, int a = -1, int b = -1, int c = -1, int64 value = 0);
+
+        struct Parser;
+    };
+
     String getId() const noexcept;
     String getName() const noexcept;
 
@@ -47,7 +86,13 @@ private:
 
     String id;
     String name;
-    String pluralEquation;
+    PluralEquation pluralEquation;
+
+    // built-in translations are only indexed on startup and loaded
+    // when used for the first time, and all the data extending them
+    // (e.g. downloaded updates) is applied after that
+    bool isLoaded = true;
+    Array<SerializedData> deferredData;
 
     using SingularsMap = FlatHashMap<I18n::Key, String>;
     SingularsMap singulars;
@@ -41,8 +41,9 @@ HotkeyScheme::Ptr HotkeySchemesManager::findActiveScheme() const
     return { new HotkeyScheme() };
 }
 
-const HotkeyScheme::Ptr HotkeySchemesManager::getCurrent() const noexcept
+const HotkeyScheme::Ptr HotkeySchemesManager::getCurrent() const
 {
+    this->loadIfNeeded();
     jassert(this->activeScheme != nullptr);
     return this->activeScheme;
 }
@@ -50,6 +50,7 @@ void ResourceManager::updateBaseResource(const SerializedData &resource)
 
 void ResourceManager::updateUserResource(const BaseResource::Ptr resource)
 {
+    this->loadIfNeeded();
     this->userResources[resource->getResourceId()] = resource;
 
     // TODO sync with server?
@@ -105,14 +106,36 @@ SerializedData ResourceManager::serializeResources(const Resources &resources)
     return tree;
 }
 
+bool ResourceManager::loadBuiltInResources(Resources &outResources)
+{
+    const String builtInResource(this->getBuiltInResourceString());
+    if (builtInResource.isEmpty())
+    {
+        return false;
+    }
+
+    const auto tree(DocumentHelpers::load(builtInResource));
+    if (!tree.isValid())
+    {
+        return false;
+    }
+
+    this->deserializeResources(tree, outResources);
+    return true;
+}
+
 void ResourceManager::reset()
 {
     this->baseResources.clear();
     this->userResources.clear();
+    this->loaded = false;
 }
 
 void ResourceManager::reloadResources()
 {
+    const ScopedLock lock(this->loadingLock);
+    this->loadingInProgress = true;
+
     bool shouldBroadcastChange = false;
 
     // Reset and store an empty tree to append user objects to
@@ -123,26 +146,16 @@ void ResourceManager::reloadResources()
     // downloaded extends and overrides built-in one,
     // user's config extends and overrides the previous step
 
-#if DEBUG
-    auto startTime = Time::getMillisecondCounter();
-#endif
+    LoadingStats stats;
+    stats.startTimeMs = Time::getMillisecondCounterHiRes();
+    stats.loadedOnMessageThread = MessageManager::existsAndIsCurrentThread();
 
-    const String builtInResource(this->getBuiltInResourceString());
-    if (builtInResource.isNotEmpty())
+    if (this->loadBuiltInResources(this->baseResources))
     {
-        const auto tree(DocumentHelpers::load(builtInResource));
-        if (tree.isValid())
-        {
-            this->deserializeResources(tree, this->baseResources);
-            shouldBroadcastChange = true;
-        }
-
-        DBG("Loaded built-in " + this->resourceType.toString() + " in " + String(Time::getMillisecondCounter() - startTime) + " ms");
+        shouldBroadcastChange = true;
     }
 
-#if DEBUG
-    startTime = Time::getMillisecondCounter();
-#endif
+    stats.builtInMs = Time::getMillisecondCounterHiRes() - stats.startTimeMs;
 
     // Try to extend built-in config with downloaded one
     const File downloadedResource(this->getDownloadedResourceFile());
@@ -154,13 +167,9 @@ void ResourceManager::reloadResources()
             this->deserializeResources(tree, this->baseResources);
             shouldBroadcastChange = true;
         }
-
-        DBG("Loaded extended " + this->resourceType.toString() + " in " + String(Time::getMillisecondCounter() - startTime) + " ms");
     }
 
-#if DEBUG
-    startTime = Time::getMillisecondCounter();
-#endif
+    stats.downloadedMs = Time::getMillisecondCounterHiRes() - stats.startTimeMs - stats.builtInMs;
 
     // Try to extend base config with user's settings
     const File usersResource(this->getUsersResourceFile());
@@ -173,12 +182,55 @@ void ResourceManager::reloadResources()
             this->deserializeResources(tree, this->userResources);
             shouldBroadcastChange = true;
         }
-
-        DBG("Loaded user's " + this->resourceType.toString() + " in " + String(Time::getMillisecondCounter() - startTime) + " ms");
     }
 
+    stats.userMs = Time::getMillisecondCounterHiRes() -
+        stats.startTimeMs - stats.builtInMs - stats.downloadedMs;
+
+    stats.numResources = int(this->baseResources.size() + this->userResources.size());
+
+    this->loadingStats = stats;
+    this->loadingInProgress = false;
+    this->loaded = true;
+
     if (shouldBroadcastChange)
     {
         this->sendChangeMessage();
     }
 }
+
+void ResourceManager::loadIfNeeded() const
+{
+    if (this->loaded.load())
+    {
+        return;
+    }
+
+    const ScopedLock lock(this->loadingLock);
+
+    // someone might have loaded them while we were waiting for the lock,
+    // or, the resources are being deserialized right now by this thread,
+    // and some manager accesses the ones loaded so far;
+    // loading is not considered a modification of the manager,
+    // just like in any other lazily initialized cache
+    if (!this->loaded.load() && !this->loadingInProgress)
+    {
+        const_cast<ResourceManager *>(this)->reloadResources();
+    }
+}
+
+bool ResourceManager::isLoaded() const noexcept
+{
+    return this->loaded.load();
+}
+
+ResourceManager::LoadingStats ResourceManager::getLoadingStats() const
+{
+    const ScopedLock lock(this->loadingLock);
+    return this->loadingStats;
+}
+
+const Identifier &ResourceManager::getResourceType() const noexcept
+{
+    return this->resourceType;
+}
@@ -26,16 +26,39 @@ public:
     explicit ResourceManager(const Identifier &resourceType);
     ~ResourceManager() override;
 
+    // loads all resources synchronously
     void reloadResources();
 
-    inline bool isEmpty() const noexcept
+    // the resources are loaded on demand, when accessed for the first time,
+    // or in advance on a background thread; this is thread-safe,
+    // and blocks if the resources are being loaded on another thread
+    void loadIfNeeded() const;
+    bool isLoaded() const noexcept;
+
+    struct LoadingStats final
+    {
+        double startTimeMs = 0.0;
+        double builtInMs = 0.0;
+        double downloadedMs = 0.0;
+        double userMs = 0.0;
+        int numResources = 0;
+        bool loadedOnMessageThread = false;
+    };
+
+    LoadingStats getLoadingStats() const;
+    const Identifier &getResourceType() const noexcept;
+
+    inline bool isEmpty() const
     {
+        this->loadIfNeeded();
         return this->baseResources.size() == 0 && this->userResources.size() == 0;
     }
 
     template<typename T = BaseResource>
     const Array<typename T::Ptr> getAllResources() const
     {
+        this->loadIfNeeded();
+
         Array<typename T::Ptr> result;
 
         for (const auto &baseConfig : this->baseResources)
@@ -59,6 +82,8 @@ public:
     template<typename T = BaseResource>
     const Array<typename T::Ptr> getUserResources() const
     {
+        this->loadIfNeeded();
+
         Array<typename T::Ptr> result;
 
         for (const auto &userConfig : this->userResources)
@@ -73,6 +98,8 @@ public:
     template<typename T = BaseResource>
     const typename T::Ptr getResourceById(const String &resourceId) const
     {
+        this->loadIfNeeded();
+
         const auto foundUserResource = this->userResources.find(resourceId);
         if (foundUserResource != this->userResources.end())
         {
@@ -91,6 +118,8 @@ public:
     template<typename T = BaseResource>
     const typename T::Ptr getUserResourceById(const String &resourceId) const
     {
+        this->loadIfNeeded();
+
         const auto foundUserResource = this->userResources.find(resourceId);
         if (foundUserResource != this->userResources.end())
         {
@@ -103,6 +132,8 @@ public:
     template<typename T = BaseResource>
     const bool containsUserResourceWithId(const String &resourceId) const
     {
+        this->loadIfNeeded();
+
         const auto foundUserResource = this->userResources.find(resourceId);
         return foundUserResource != this->userResources.end();
     }
@@ -123,6 +154,11 @@ protected:
     Resources baseResources;
     Resources userResources;
 
+    // parses the whole built-in resource by default, managers with
+    // large resources may override this to only index them on startup,
+    // returns true if anything was loaded:
+    virtual bool loadBuiltInResources(Resources &outResources);
+
     // customized Serializable:
     virtual SerializedData serializeResources(const Resources &resources);
     virtual void deserializeResources(const SerializedData &tree, Resources &outResources) = 0;
@@ -133,6 +169,11 @@ private:
     const Identifier resourceType;
     const DummyBaseResource comparator;
 
+    CriticalSection loadingLock;
+    std::atomic<bool> loaded { false };
+    bool loadingInProgress = false;
+    LoadingStats loadingStats;
+
     JUCE_DECLARE_WEAK_REFERENCEABLE(ResourceManager)
 };
 
@@ -19,63 +19,28 @@
 #include "TranslationsManager.h"
 #include "SerializationKeys.h"
 #include "Config.h"
-
-struct PluralEquationWrapper final : public DynamicObject
-{
-    explicit PluralEquationWrapper(TranslationsManager &owner) : translator(owner)
-    {
-        this->setMethod(Serialization::Translations::wrapperMethodName, PluralEquationWrapper::detect);
-    }
-    
-    static Identifier getClassName()
-    {
-        return Serialization::Translations::wrapperClassName;
-    }
-    
-    static var detect(const var::NativeFunctionArgs &args)
-    {
-        if (args.numArguments > 0)
-        {
-            if (auto *thisObject = dynamic_cast<PluralEquationWrapper *>(args.thisObject.getObject()))
-            {
-                thisObject->translator.equationResult = args.arguments[0].toString();
-            }
-        }
-        
-        return var::undefined();
-    }
-    
-    TranslationsManager &translator;
-    
-    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(PluralEquationWrapper)
-};
+#include "JsonSerializer.h"
+#include "DocumentHelpers.h"
 
 TranslationsManager::TranslationsManager() :
-    ResourceManager(Serialization::Resources::translations)
-{
-    this->engine = make<JavascriptEngine>();
-    this->engine->maximumExecutionTime = RelativeTime::milliseconds(200);
+    ResourceManager(Serialization::Resources::translations) {}
 
-    PluralEquationWrapper::Ptr pluralEquationWrapper(new PluralEquationWrapper(*this));
-    this->engine->registerNativeObject(Serialization::Translations::wrapperClassName, pluralEquationWrapper.get());
-}
-
-TranslationsManager::~TranslationsManager()
-{
-    this->engine = nullptr;
-}
+TranslationsManager::~TranslationsManager() = default;
 
 //===----------------------------------------------------------------------===//
 // Translations
 //===----------------------------------------------------------------------===//
 
-const Translation::Ptr TranslationsManager::getCurrent() const noexcept
+const Translation::Ptr TranslationsManager::getCurrent() const
 {
+    this->loadIfNeeded();
     return this->currentTranslation;
 }
 
 void TranslationsManager::loadLocaleWithId(const String &localeId)
 {
+    this->loadIfNeeded();
+
     if (this->currentTranslation->id == localeId)
     {
         DBG(localeId + "translation is already loaded, skipping");
@@ -84,7 +49,13 @@ void TranslationsManager::loadLocaleWithId(const String &localeId)
 
     if (const auto translation = this->getResourceById<Translation>(localeId))
     {
-        this->currentTranslation = translation;
+        this->loadTranslationIfNeeded(translation);
+
+        {
+            const SpinLock::ScopedLockType sl(this->currentTranslationLock);
+            this->currentTranslation = translation;
+        }
+
         App::Config().setProperty(Serialization::Config::currentLocale, localeId);
         this->sendChangeMessage();
     }
@@ -102,6 +73,7 @@ String TranslationsManager::translate(const String &text)
 
 String TranslationsManager::translate(I18n::Key key)
 {
+    this->loadIfNeeded();
     const SpinLock::ScopedLockType sl(this->currentTranslationLock);
 
     const auto foundCurrentSingular = this->currentTranslation->singulars.find(key);
@@ -126,6 +98,8 @@ String TranslationsManager::translate(const String &baseLiteral, int64 targetNum
         return {};
     }
 
+    this->loadIfNeeded();
+
     using namespace Serialization;
     const SpinLock::ScopedLockType sl(this->currentTranslationLock);
 
@@ -136,14 +110,10 @@ String TranslationsManager::translate(const String &baseLiteral, int64 targetNum
         return baseLiteral.replace(Translations::metaSymbol, String(targetNumber));
     }
 
-    const String expressionToEvaluate =
-        this->currentTranslation->pluralEquation.replace(Translations::metaSymbol,
-            String(targetNumber > 0 ? targetNumber : -targetNumber));
-
-    const Result result = this->engine->execute(expressionToEvaluate);
-    if (!result.failed())
+    const auto &equation = this->currentTranslation->pluralEquation;
+    if (equation.isValid())
     {
-        const String pluralForm = this->equationResult;
+        const auto pluralForm = String(equation.evaluate(targetNumber > 0 ? targetNumber : -targetNumber));
         const auto foundTranslation = foundPlural->second->find(pluralForm);
         if (foundTranslation != foundPlural->second->end())
         {
@@ -180,7 +150,14 @@ void TranslationsManager::deserializeResources(const SerializedData &tree, Resou
             static_cast<Translation *>(existingTranslation->second.get()) : new Translation());
 
         //DBG(translationId + "/" + translation->getResourceId());
-        translation->deserialize(translationRoot);
+        if (translation->isLoaded)
+        {
+            translation->deserialize(translationRoot);
+        }
+        else
+        {
+            translation->deferredData.add(translationRoot);
+        }
 
         outResources[translation->getResourceId()] = translation;
 
@@ -204,12 +181,90 @@ void TranslationsManager::deserializeResources(const SerializedData &tree, Resou
     jassert(this->fallbackTranslation != nullptr);
 }
 
+bool TranslationsManager::loadBuiltInResources(Resources &outResources)
+{
+    // all locales are indexed, but only the selected one and the fallback
+    // are loaded, the others will be loaded when they are needed;
+    // the selected locale is not known until the index is built,
+    // so let's load the one that getSelectedLocaleId() would pick:
+    const auto configuredLocaleId = App::Config().containsProperty(Serialization::Config::currentLocale) ?
+        App::Config().getProperty(Serialization::Config::currentLocale, fallbackTranslationId) :
+        SystemStats::getUserLanguage().toLowerCase().substring(0, 2);
+
+    const auto locales = this->readBuiltInLocales({ configuredLocaleId, fallbackTranslationId });
+    if (locales.isEmpty())
+    {
+        return false;
+    }
+
+    for (const auto &localeRoot : locales)
+    {
+        Translation::Ptr translation(new Translation());
+        translation->deserialize(localeRoot);
+        translation->isLoaded = localeRoot.getNumChildren() > 0;
+        outResources[translation->getResourceId()] = translation;
+    }
+
+    const auto findTranslation = [&outResources](const String &localeId) -> Translation::Ptr
+    {
+        const auto found = outResources.find(localeId);
+        return found != outResources.end() ? static_cast<Translation *>(found->second.get()) : nullptr;
+    };
+
+    this->currentTranslation = findTranslation(this->getSelectedLocaleId());
+    this->fallbackTranslation = findTranslation(fallbackTranslationId);
+
+    if (this->currentTranslation == nullptr)
+    {
+        this->currentTranslation = this->fallbackTranslation;
+    }
+
+    jassert(this->currentTranslation != nullptr);
+    jassert(this->fallbackTranslation != nullptr);
+
+    this->loadTranslationIfNeeded(this->currentTranslation);
+    this->loadTranslationIfNeeded(this->fallbackTranslation);
+    return true;
+}
+
+void TranslationsManager::loadTranslationIfNeeded(Translation::Ptr translation)
+{
+    if (translation == nullptr || translation->isLoaded)
+    {
+        return;
+    }
+
+#if DEBUG
+    const auto startTime = Time::getMillisecondCounter();
+#endif
+
+    for (const auto &localeRoot : this->readBuiltInLocales({ translation->getResourceId() }))
+    {
+        if (localeRoot.getProperty(Serialization::Translations::localeId)
+            .toString().toLowerCase() == translation->getResourceId())
+        {
+            translation->deserialize(localeRoot);
+        }
+    }
+
+    // downloaded translations extend the built-in ones
+    for (const auto &data : translation->deferredData)
+    {
+        translation->deserialize(data);
+    }
+
+    translation->deferredData.clear();
+    translation->isLoaded = true;
+
+    DBG("Loaded " + translation->getResourceId() + " translation in " +
+        String(Time::getMillisecondCounter() - startTime) + " ms");
+}
+
 void TranslationsManager::reset()
 {
     ResourceManager::reset();
     this->currentTranslation = nullptr;
     this->fallbackTranslation = nullptr;
-    this->equationResult.clear();
 }
 
 //===----------------------------------------------------------------------===//
@@ -234,3 +289,184 @@ String TranslationsManager::getSelectedLocaleId() const
     
     return fallbackTranslationId;
 }
+
+// Passes through the locale headers, i.e. their ids, names and equations,
+// and the contents only of the locales that are about to be used,
+// so that there's no need to build the trees for all of them
+class TranslationsFilter final : public SerializedDataWriter
+{
+public:
+
+    explicit TranslationsFilter(const StringArray &localesToLoad) :
+        localesToLoad(localesToLoad) {}
+
+    void beginNode(const Identifier &type) override
+    {
+        this->depth++;
+
+        if (this->skippedDepth > 0)
+        {
+            this->skippedDepth++;
+            return;
+        }
+
+        if (this->depth == TranslationsFilter::localeDepth &&
+            type == Serialization::Translations::locale)
+        {
+            this->currentLocale = make<SerializedDataBuilder>();
+            this->currentLocale->beginNode(type);
+            this->hasCheckedCurrentLocale = false;
+            return;
+        }
+
+        if (this->currentLocale == nullptr)
+        {
+            return;
+        }
+
+        // the header properties are expected to go before
+        // the literals, but if not, the locale is loaded anyway
+        if (!this->hasCheckedCurrentLocale)
+        {
+            const auto localeId = this->currentLocale->getResult()
+                .getProperty(Serialization::Translations::localeId).toString().toLowerCase();
+
+            this->shouldLoadCurrentLocale = localeId.isEmpty() ||
+                this->localesToLoad.contains(localeId);
+
+            this->hasCheckedCurrentLocale = true;
+        }
+
+        if (this->shouldLoadCurrentLocale)
+        {
+            this->currentLocale->beginNode(type);
+        }
+        else
+        {
+            this->skippedDepth = 1;
+        }
+    }
+
+    void writeProperty(const Identifier &name, const var &value) override
+    {
+        if (this->skippedDepth == 0 && this->currentLocale != nullptr)
+        {
+            this->currentLocale->writeProperty(name, value);
+        }
+    }
+
+    void endNode() override
+    {
+        this->depth--;
+
+        if (this->skippedDepth > 0)
+        {
+            this->skippedDepth--;
+            return;
+        }
+
+        if (this->currentLocale == nullptr)
+        {
+            return;
+        }
+
+        this->currentLocale->endNode();
+
+        if (this->depth < TranslationsFilter::localeDepth)
+        {
+            this->locales.add(this->currentLocale->getResult());
+            this->currentLocale = nullptr;
+        }
+    }
+
+    Array<SerializedData> locales;
+
+private:
+
+    const StringArray localesToLoad;
+
+    // the root node is translations, and its children are locales
+    static constexpr auto localeDepth = 2;
+
+    int depth = 0;
+    int skippedDepth = 0;
+
+    UniquePointer<SerializedDataBuilder> currentLocale;
+    bool hasCheckedCurrentLocale = false;
+    bool shouldLoadCurrentLocale = false;
+
+    JUCE_DECLARE_NON_COPYABLE(TranslationsFilter)
+};
+
+Array<SerializedData> TranslationsManager::readBuiltInLocales(const StringArray &localesToLoad) const
+{
+    // no need to copy the built-in data into a string
+    MemoryInputStream builtInData(BinaryData::translations_json,
+        BinaryData::translations_jsonSize, false);
+
+    TranslationsFilter filter(localesToLoad);
+    const auto result = JsonSerializer().read(builtInData, filter);
+    jassert(result.wasOk());
+
+    return filter.locales;
+}
+
+//===----------------------------------------------------------------------===//
+// Tests
+//===----------------------------------------------------------------------===//
+
+#if JUCE_UNIT_TESTS
+
+class TranslationsFilterTests final : public UnitTest
+{
+public:
+    TranslationsFilterTests() : UnitTest("Translations lazy loading tests", UnitTestCategories::helio) {}
+
+    void runTest() override
+    {
+        beginTest("Built-in translations indexing");
+
+        const auto loadAllMs = Time::getMillisecondCounterHiRes();
+        const auto fullTree = DocumentHelpers::load(String::fromUTF8(BinaryData::translations_json,
+            BinaryData::translations_jsonSize));
+        const auto indexMs = Time::getMillisecondCounterHiRes();
+
+        MemoryInputStream builtInData(BinaryData::translations_json,
+            BinaryData::translations_jsonSize, false);
+
+        TranslationsFilter filter({ "ru" });
+        expect(JsonSerializer().read(builtInData, filter).wasOk());
+        const auto doneMs = Time::getMillisecondCounterHiRes();
+
+        expect(fullTree.hasType(Serialization::Resources::translations));
+
+        int numLocales = 0;
+        forEachChildWithType(fullTree, localeRoot, Serialization::Translations::locale)
+        {
+            const auto &indexed = filter.locales.getReference(numLocales++);
+            const auto localeId = localeRoot.getProperty(Serialization::Translations::localeId).toString();
+            expectEquals(indexed.getProperty(Serialization::Translations::localeId).toString(), localeId);
+            expectEquals(indexed.getProperty(Serialization::Translations::localeName).toString(),
+                localeRoot.getProperty(Serialization::Translations::localeName).toString());
+
+            if (localeId == "ru")
+            {
+                expect(indexed.isEquivalentTo(localeRoot));
+            }
+            else
+            {
+                expectEquals(indexed.getNumChildren(), 0);
+            }
+        }
+
+        expectEquals(filter.locales.size(), numLocales);
+        expect(numLocales > 1);
+
+        logMessage("Loaded all translations in " + String(indexMs - loadAllMs, 1) +
+            " ms, indexed them and loaded one in " + String(doneMs - indexMs, 1) + " ms");
+    }
+};
+
+static TranslationsFilterTests translationsFilterTests;
+
+#endif
@@ -37,7 +37,7 @@ public:
         return this->getAllResources<Translation>();
     }
 
-    const Translation::Ptr getCurrent() const noexcept;
+    const Translation::Ptr getCurrent() const;
 
     void loadLocaleWithId(const String &localeId);
 
@@ -51,18 +51,20 @@ public:
     
 private:
 
+    bool loadBuiltInResources(Resources &outResources) override;
     void deserializeResources(const SerializedData &tree, Resources &outResources) override;
     void reset() override;
 
-    UniquePointer<JavascriptEngine> engine;
-    String equationResult;
+    // parses the built-in translations, only building the trees
+    // for the given locales, and only the headers for the others
+    Array<SerializedData> readBuiltInLocales(const StringArray &localesToLoad) const;
+    void loadTranslationIfNeeded(Translation::Ptr translation);
 
     SpinLock currentTranslationLock;
     Translation::Ptr currentTranslation;
     Translation::Ptr fallbackTranslation;
 
     String getSelectedLocaleId() const;
-    friend struct PluralEquationWrapper;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(TranslationsManager)
 };
@@ -0,0 +1,429 @@
+/*
+    This file is part of Helio Workstation.
+
+    Helio is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Helio is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Helio. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "Common.h"
+#include "MidiFileWriter.h"
+#include "MidiSequence.h"
+#include "Pattern.h"
+#include "KeyboardMapping.h"
+
+// A lazily exported clip: the events are exported one by one,
+// the resulting messages are kept in a min-heap until all messages
+// of the next event are known to come not earlier than the heap's top
+class ClipMessageStream final
+{
+public:
+
+    ClipMessageStream(const MidiSequence &sequence, const Clip &clip,
+        const KeyboardMapping &keyMap, double timeFactor) :
+        sequence(sequence), clip(clip), keyMap(keyMap), timeFactor(timeFactor)
+    {
+        this->fetchEvents();
+    }
+
+    inline bool isEmpty() const noexcept
+    {
+        return this->pending.isEmpty();
+    }
+
+    inline double getNextTimeStamp() const noexcept
+    {
+        jassert(!this->isEmpty());
+        return this->pending.getReference(0).message.getTimeStamp();
+    }
+
+    MidiMessage popNextMessage()
+    {
+        std::pop_heap(this->pending.begin(), this->pending.end(), PendingMessage::isLater);
+        const auto message = this->pending.getLast().message;
+        this->pending.removeLast();
+        this->fetchEvents();
+        return message;
+    }
+
+private:
+
+    struct PendingMessage final
+    {
+        MidiMessage message;
+        int64 order; // to keep the simultaneous messages in the export order
+
+        static bool isLater(const PendingMessage &a, const PendingMessage &b) noexcept
+        {
+            const auto ta = a.message.getTimeStamp();
+            const auto tb = b.message.getTimeStamp();
+            return ta > tb || (ta == tb && a.order > b.order);
+        }
+    };
+
+    // every message of the event comes not earlier than the event start,
+    // so the events are exported until the next one starts after the heap's top
+    void fetchEvents()
+    {
+        while (this->nextEventIndex < this->sequence.size())
+        {
+            const auto *event = this->sequence.getUnchecked(this->nextEventIndex);
+            const auto eventTime = (event->getBeat() + this->clip.getBeat()) * this->timeFactor;
+            if (!this->isEmpty() && eventTime > this->getNextTimeStamp())
+            {
+                return;
+            }
+
+            this->eventMessages.clear();
+            event->exportMessages(this->eventMessages, this->clip,
+                this->keyMap, 0.0, this->timeFactor);
+
+            for (const auto *holder : this->eventMessages)
+            {
+                this->pending.add({ holder->message, this->messageCounter++ });
+                std::push_heap(this->pending.begin(), this->pending.end(), PendingMessage::isLater);
+            }
+
+            this->nextEventIndex++;
+        }
+    }
+
+    const MidiSequence &sequence;
+    const Clip &clip;
+    const KeyboardMapping &keyMap;
+    const double timeFactor;
+
+    int nextEventIndex = 0;
+    int64 messageCounter = 0;
+
+    Array<PendingMessage> pending;
+    MidiMessageSequence eventMessages;
+
+    JUCE_DECLARE_NON_COPYABLE(ClipMessageStream)
+};
+
+// Encodes the messages into the track chunk data,
+// the same way MidiFile::writeTo does it, with running status
+class TrackChunkEncoder final
+{
+public:
+
+    explicit TrackChunkEncoder(OutputStream &out) : out(out) {}
+
+    void write(const MidiMessage &message)
+    {
+        const auto tick = roundToInt(message.getTimeStamp());
+        this->writeVariableLengthInt(uint32(jmax(0, tick - this->lastTick)));
+        this->lastTick = tick;
+
+        const auto *data = message.getRawData();
+        auto dataSize = message.getRawDataSize();
+        const auto statusByte = data[0];
+
+        if (statusByte == this->lastStatusByte &&
+            (statusByte & 0xf0) != 0xf0 && dataSize > 1)
+        {
+            ++data;
+            --dataSize;
+        }
+        else if (statusByte == 0xf0)
+        {
+            this->out.writeByte(char(statusByte));
+            ++data;
+            --dataSize;
+            this->writeVariableLengthInt(uint32(dataSize));
+        }
+
+        this->out.write(data, size_t(dataSize));
+        this->lastStatusByte = statusByte;
+    }
+
+    void writeEndOfTrack()
+    {
+        const auto message = MidiMessage::endOfTrack();
+        this->out.writeByte(0);
+        this->out.write(message.getRawData(), size_t(message.getRawDataSize()));
+    }
+
+private:
+
+    void writeVariableLengthInt(uint32 value)
+    {
+        auto buffer = value & 0x7f;
+
+        while ((value >>= 7) != 0)
+        {
+            buffer <<= 8;
+            buffer |= ((value & 0x7f) | 0x80);
+        }
+
+        for (;;)
+        {
+            this->out.writeByte(char(buffer));
+            if ((buffer & 0x80) == 0)
+            {
+                break;
+            }
+
+            buffer >>= 8;
+        }
+    }
+
+    OutputStream &out;
+    int lastTick = 0;
+    uint8 lastStatusByte = 0;
+
+    JUCE_DECLARE_NON_COPYABLE(TrackChunkEncoder)
+};
+
+//===----------------------------------------------------------------------===//
+// MidiFileWriter
+//===----------------------------------------------------------------------===//
+
+MidiFileWriter::MidiFileWriter(OutputStream &stream, int ticksPerQuarterNote) :
+    stream(stream),
+    ticksPerQuarterNote(ticksPerQuarterNote) {}
+
+bool MidiFileWriter::write(const Array<MidiTrack *> &tracks, MidiTrack::Grouping grouping)
+{
+    // only the track lists are kept for each group, not the events
+    StringArray groupKeys;
+    OwnedArray<Array<const MidiTrack *>> groups;
+
+    for (const auto *track : tracks)
+    {
+        const auto groupKey = track->getTrackGroupKey(grouping);
+        auto groupIndex = groupKeys.indexOf(groupKey);
+        if (groupIndex < 0)
+        {
+            groupIndex = groupKeys.size();
+            groupKeys.add(groupKey);
+            groups.add(new Array<const MidiTrack *>());
+        }
+
+        groups.getUnchecked(groupIndex)->add(track);
+    }
+
+    this->stream.writeIntBigEndian(int(ByteOrder::bigEndianInt("MThd")));
+    this->stream.writeIntBigEndian(6);
+    this->stream.writeShortBigEndian(1);
+    this->stream.writeShortBigEndian(short(groups.size()));
+    this->stream.writeShortBigEndian(short(this->ticksPerQuarterNote));
+
+    for (const auto *group : groups)
+    {
+        if (!this->writeTrackChunk(*group))
+        {
+            return false;
+        }
+    }
+
+    this->stream.flush();
+    return true;
+}
+
+bool MidiFileWriter::writeTrackChunk(const Array<const MidiTrack *> &tracks)
+{
+    static Clip noTransform;
+    static KeyboardMapping simpleMapping;
+    const auto timeFactor = double(this->ticksPerQuarterNote);
+
+    OwnedArray<ClipMessageStream> streams;
+    for (const auto *track : tracks)
+    {
+        const auto *sequence = track->getSequence();
+        if (track->getPattern() == nullptr)
+        {
+            streams.add(new ClipMessageStream(*sequence, noTransform, simpleMapping, timeFactor));
+            continue;
+        }
+
+        for (const auto *clip : track->getPattern()->getClips())
+        {
+            if (!clip->isMuted())
+            {
+                streams.add(new ClipMessageStream(*sequence, *clip, simpleMapping, timeFactor));
+            }
+        }
+    }
+
+    // the merge heap keeps the streams ordered by their next message,
+    // and by their index for the simultaneous ones
+    Array<int> heap;
+    const auto isLater = [&streams](int a, int b)
+    {
+        const auto ta = streams.getUnchecked(a)->getNextTimeStamp();
+        const auto tb = streams.getUnchecked(b)->getNextTimeStamp();
+        return ta > tb || (ta == tb && a > b);
+    };
+
+    for (int i = 0; i < streams.size(); ++i)
+    {
+        if (!streams.getUnchecked(i)->isEmpty())
+        {
+            heap.add(i);
+        }
+    }
+
+    std::make_heap(heap.begin(), heap.end(), isLater);
+
+    // the chunk length is only known at the end, so it's patched afterwards
+    // if the stream can seek, otherwise the chunk data is buffered
+    const auto chunkStart = this->stream.getPosition();
+    const auto canSeek = this->stream.setPosition(chunkStart);
+
+    MemoryOutputStream chunkBuffer;
+    auto &chunkOut = canSeek ? this->stream : static_cast<OutputStream &>(chunkBuffer);
+
+    if (canSeek)
+    {
+        this->stream.writeIntBigEndian(int(ByteOrder::bigEndianInt("MTrk")));
+        this->stream.writeIntBigEndian(0);
+    }
+
+    TrackChunkEncoder encoder(chunkOut);
+
+    // the same rule as in MidiMessageSequence::updateMatchedPairs:
+    // a note-on of the key that is already on first gets a note-off
+    bool activeNotes[16][128] = {};
+
+    while (!heap.isEmpty())
+    {
+        std::pop_heap(heap.begin(), heap.end(), isLater);
+        const auto streamIndex = heap.getLast();
+        auto *clipStream = streams.getUnchecked(streamIndex);
+
+        const auto message = clipStream->popNextMessage();
+        if (message.isNoteOn())
+        {
+            auto &isActive = activeNotes[message.getChannel() - 1][message.getNoteNumber()];
+            if (isActive)
+            {
+                encoder.write(MidiMessage::noteOff(message.getChannel(),
+                    message.getNoteNumber()).withTimeStamp(message.getTimeStamp()));
+            }
+
+            isActive = true;
+        }
+        else if (message.isNoteOff())
+        {
+            activeNotes[message.getChannel() - 1][message.getNoteNumber()] = false;
+        }
+
+        encoder.write(message);
+
+        if (clipStream->isEmpty())
+        {
+            heap.removeLast();
+        }
+        else
+        {
+            std::push_heap(heap.begin(), heap.end(), isLater);
+        }
+    }
+
+    encoder.writeEndOfTrack();
+
+    if (!canSeek)
+    {
+        this->stream.writeIntBigEndian(int(ByteOrder::bigEndianInt("MTrk")));
+        this->stream.writeIntBigEndian(int(chunkBuffer.getDataSize()));
+        return this->stream.write(chunkBuffer.getData(), chunkBuffer.getDataSize());
+    }
+
+    const auto chunkEnd = this->stream.getPosition();
+    const auto chunkSize = chunkEnd - chunkStart - 8;
+    if (!this->stream.setPosition(chunkStart + 4))
+    {
+        return false;
+    }
+
+    this->stream.writeIntBigEndian(int(chunkSize));
+    return this->stream.setPosition(chunkEnd);
+}
+
+//===----------------------------------------------------------------------===//
+// Tests
+//===----------------------------------------------------------------------===//
+
+#if JUCE_UNIT_TESTS
+
+#include "PianoSequence.h"
+
+class MidiFileWriterTests final : public UnitTest
+{
+public:
+    MidiFileWriterTests() : UnitTest("Streaming MIDI file writer tests", UnitTestCategories::helio) {}
+
+    void runTest() override
+    {
+        beginTest("Same output as the MidiFile export");
+
+        static constexpr auto ticksPerQuarterNote = 960;
+
+        // overlapping notes, including the ones of the same key
+        Random random(1);
+        MidiMessageSequence generated;
+        for (int i = 0; i < 5000; ++i)
+        {
+            const auto key = 48 + random.nextInt(24);
+            const auto startTick = double(random.nextInt(ticksPerQuarterNote * 64));
+            const auto lengthTicks = double(1 + random.nextInt(ticksPerQuarterNote * 2));
+            generated.addEvent(MidiMessage::noteOn(1, key, 0.75f).withTimeStamp(startTick));
+            generated.addEvent(MidiMessage::noteOff(1, key).withTimeStamp(startTick + lengthTicks));
+        }
+
+        SingleSequenceTrack track;
+        track.sequence.importMidi(generated, ticksPerQuarterNote);
+
+        static Clip noTransform;
+        static KeyboardMapping simpleMapping;
+        MidiMessageSequence exported;
+        track.sequence.exportMidi(exported, noTransform, simpleMapping,
+            false, 0.0, double(ticksPerQuarterNote));
+        exported.updateMatchedPairs();
+
+        MidiFile legacyFile;
+        legacyFile.setTicksPerQuarterNote(ticksPerQuarterNote);
+        legacyFile.addTrack(exported);
+
+        MemoryOutputStream legacyOut;
+        expect(legacyFile.writeTo(legacyOut));
+
+        Array<MidiTrack *> tracks;
+        tracks.add(&track);
+
+        MemoryOutputStream streamedOut;
+        MidiFileWriter writer(streamedOut, ticksPerQuarterNote);
+        expect(writer.write(tracks, MidiTrack::Grouping::GroupByName));
+
+        expect(legacyOut.getMemoryBlock() == streamedOut.getMemoryBlock());
+    }
+
+private:
+
+    struct SingleSequenceTrack final : public EmptyMidiTrack
+    {
+        SingleSequenceTrack() : sequence(*this, dispatcher) {}
+        MidiSequence *getSequence() const noexcept override
+        {
+            return const_cast<PianoSequence *>(&this->sequence);
+        }
+
+        EmptyEventDispatcher dispatcher;
+        PianoSequence sequence;
+    };
+};
+
+static MidiFileWriterTests midiFileWriterTests;
+
+#endif
@@ -0,0 +1,51 @@
+/*
+    This file is part of Helio Workstation.
+
+    Helio is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Helio is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Helio. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include "MidiTrack.h"
+
+// Writes a standard MIDI file straight from the tracks, without building
+// a MidiMessageSequence (and a MidiFile) for the whole project first:
+// each track chunk is a k-way merge of the per-clip event streams,
+// which are already sorted by beat, and the messages are encoded
+// with their delta-times as soon as they come out of the merge.
+
+// The memory used is proportional to the number of clips,
+// and to the number of notes sounding at the same time,
+// but not to the number of events in the project.
+
+class MidiFileWriter final
+{
+public:
+
+    MidiFileWriter(OutputStream &stream, int ticksPerQuarterNote);
+
+    // writes a format 1 file with a track chunk per each group of tracks
+    // (groups keep the order in which they first appear in the tracks list);
+    // mute flags are respected, but solo flags are not, as they shouldn't
+    bool write(const Array<MidiTrack *> &tracks, MidiTrack::Grouping grouping);
+
+private:
+
+    bool writeTrackChunk(const Array<const MidiTrack *> &tracks);
+
+    OutputStream &stream;
+    const int ticksPerQuarterNote;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(MidiFileWriter)
+};
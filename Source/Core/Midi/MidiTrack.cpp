@@ -41,6 +41,16 @@ void MidiTrack::serializeTrackProperties(SerializedData &tree) const
     tree.setProperty(Core::trackControllerNumber, this->getTrackControllerNumber());
 }
 
+void MidiTrack::serializeTrackProperties(SerializedDataWriter &writer) const
+{
+    using namespace Serialization;
+    writer.writeProperty(Core::trackId, this->getTrackId());
+    writer.writeProperty(Core::trackColour, this->getTrackColour().toString());
+    writer.writeProperty(Core::trackChannel, this->getTrackChannel());
+    writer.writeProperty(Core::trackInstrumentId, this->getTrackInstrumentId());
+    writer.writeProperty(Core::trackControllerNumber, this->getTrackControllerNumber());
+}
+
 void MidiTrack::deserializeTrackProperties(const SerializedData &tree)
 {
     using namespace Serialization;
@@ -105,12 +105,17 @@ public:
     }
 
     void serializeTrackProperties(SerializedData &tree) const;
+    void serializeTrackProperties(SerializedDataWriter &writer) const;
     void deserializeTrackProperties(const SerializedData &tree);
 
     enum DefaultControllers
     {
         sustainPedalController = 64,
         tempoController = 81,
+        // not the real controller numbers, but automation tracks for these
+        // are exported as pitch wheel and channel pressure messages:
+        pitchBendController = 128,
+        channelPressureController = 129,
     };
 
     bool isTempoTrack() const noexcept;
@@ -32,9 +32,6 @@ AnnotationsSequence::AnnotationsSequence(MidiTrack &track,
 
 void AnnotationsSequence::importMidi(const MidiMessageSequence &sequence, short timeFormat)
 {
-    this->clearUndoHistory();
-    this->checkpoint();
-
     for (int i = 0; i < sequence.getNumEvents(); ++i)
     {
         const auto &message = sequence.getEventPointer(i)->message;
@@ -47,6 +44,7 @@ void AnnotationsSequence::importMidi(const MidiMessageSequence &sequence, short
         }
     }
 
+    this->sort();
     this->updateBeatRange(false);
 }
 
@@ -46,9 +46,6 @@ float AutomationSequence::getAverageControllerValue() const
 
 void AutomationSequence::importMidi(const MidiMessageSequence &sequence, short timeFormat)
 {
-    this->clearUndoHistory();
-    this->checkpoint();
-    
     for (int i = 0; i < sequence.getNumEvents(); ++i)
     {
         const MidiMessage &message = sequence.getEventPointer(i)->message;
@@ -67,6 +64,7 @@ void AutomationSequence::importMidi(const MidiMessageSequence &sequence, short t
         }
     }
     
+    this->sort();
     this->updateBeatRange(false);
 }
 
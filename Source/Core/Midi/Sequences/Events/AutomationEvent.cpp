@@ -71,6 +71,20 @@ float AutomationEvent::interpolateEvents(float cv1, float cv2, float factor, flo
     return cv1 + (easeIn + easeOut);
 }
 
+static MidiMessage createControllerMessage(int channel,
+    int controllerNumber, float controllerValue) noexcept
+{
+    switch (controllerNumber)
+    {
+    case MidiTrack::pitchBendController:
+        return MidiMessage::pitchWheel(channel, jlimit(0, 16383, int(controllerValue * 16383)));
+    case MidiTrack::channelPressureController:
+        return MidiMessage::channelPressureChange(channel, int(controllerValue * 127));
+    default:
+        return MidiMessage::controllerEvent(channel, controllerNumber, int(controllerValue * 127));
+    }
+}
+
 void AutomationEvent::exportMessages(MidiMessageSequence &outSequence,
     const Clip &clip, const KeyboardMapping &keyMap, double timeOffset, double timeFactor) const noexcept
 {
@@ -83,8 +97,8 @@ void AutomationEvent::exportMessages(MidiMessageSequence &outSequence,
     }
     else
     {
-        cc = MidiMessage::controllerEvent(this->getTrackChannel(),
-            this->getTrackControllerNumber(), int(this->controllerValue * 127));
+        cc = createControllerMessage(this->getTrackChannel(),
+            this->getTrackControllerNumber(), this->controllerValue);
     }
 
     const double startTime = (this->beat + clip.getBeat()) * timeFactor;
@@ -120,8 +134,8 @@ void AutomationEvent::exportMessages(MidiMessageSequence &outSequence,
                 }
                 else
                 {
-                    MidiMessage ci(MidiMessage::controllerEvent(this->getTrackChannel(),
-                        this->getTrackControllerNumber(), int(interpolatedValue * 127)));
+                    MidiMessage ci(createControllerMessage(this->getTrackChannel(),
+                        this->getTrackControllerNumber(), interpolatedValue));
                     ci.setTimeStamp(interpolatedTs);
                     outSequence.addEvent(ci, timeOffset);
                 }
@@ -223,6 +223,23 @@ SerializedData Note::serialize() const
     return tree;
 }
 
+// the same as above, but without building the tree
+void Note::serializeTo(SerializedDataWriter &writer) const
+{
+    using namespace Serialization;
+    writer.beginNode(Midi::note);
+    writer.writeProperty(Midi::id, packId(this->id));
+    writer.writeProperty(Midi::key, this->key);
+    writer.writeProperty(Midi::timestamp, int(this->beat * Globals::ticksPerBeat));
+    writer.writeProperty(Midi::length, int(this->length * Globals::ticksPerBeat));
+    writer.writeProperty(Midi::volume, int(this->velocity * Globals::velocitySaveResolution));
+    if (this->tuplet > 1)
+    {
+        writer.writeProperty(Midi::tuplet, this->tuplet);
+    }
+    writer.endNode();
+}
+
 void Note::deserialize(const SerializedData &data)
 {
     this->reset();
@@ -19,6 +19,11 @@
 
 #include "MidiEvent.h"
 
+namespace VCS
+{
+    class PackedNotes;
+}
+
 class Note final : public MidiEvent
 {
 public:
@@ -73,6 +78,7 @@ public:
     //===------------------------------------------------------------------===//
 
     SerializedData serialize() const override;
+    void serializeTo(SerializedDataWriter &writer) const override;
     void deserialize(const SerializedData &data) override;
     void reset() noexcept override;
 
@@ -103,5 +109,7 @@ protected:
 
 private:
 
+    friend class VCS::PackedNotes;
+
     JUCE_LEAK_DETECTOR(Note);
 };
@@ -32,9 +32,6 @@ KeySignaturesSequence::KeySignaturesSequence(MidiTrack &track,
 
 void KeySignaturesSequence::importMidi(const MidiMessageSequence &sequence, short timeFormat)
 {
-    this->clearUndoHistory();
-    this->checkpoint();
-
     for (int i = 0; i < sequence.getNumEvents(); ++i)
     {
         const MidiMessage &message = sequence.getEventPointer(i)->message;
@@ -65,6 +62,7 @@ void KeySignaturesSequence::importMidi(const MidiMessageSequence &sequence, shor
         }
     }
 
+    this->sort();
     this->updateBeatRange(false);
 }
 
@@ -28,8 +28,9 @@ struct EventIdGenerator final
     {
         jassert(length <= 4);
         MidiEvent::Id id = 0;
-        static Random r;
-        r.setSeedRandomly();
+        // sequences may be imported in parallel, each in its own thread,
+        // so each thread has its own generator, seeded once
+        static thread_local Random r(createSeed());
         static const char idChars[] = "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz";
         for (int i = 0; i < length; ++i)
         {
@@ -37,6 +38,15 @@ struct EventIdGenerator final
         }
         return id;
     }
+
+    // Random::setSeedRandomly isn't thread-safe, since it uses a global seed,
+    // so the threads' seeds are made different by a shared counter instead
+    static int64 createSeed() noexcept
+    {
+        static std::atomic<int64> numSeeds(0);
+        return Time::getHighResolutionTicks() ^
+            ((numSeeds++ + 1) * int64(0x9E3779B97F4A7C15ull));
+    }
 };
 
 MidiSequence::MidiSequence(MidiTrack &parentTrack,
@@ -110,8 +120,6 @@ void MidiSequence::exportMidi(MidiMessageSequence &outSequence, const Clip &clip
     {
         event->exportMessages(outSequence, clip, keyMap, timeAdjustment, timeFactor);
     }
-
-    outSequence.updateMatchedPairs();
 }
 
 float MidiSequence::midiTicksToBeats(double ticks, int timeFormat) noexcept
@@ -51,6 +51,10 @@ public:
 
     static float midiTicksToBeats(double ticks, int timeFormat) noexcept;
     virtual void importMidi(const MidiMessageSequence &sequence, short timeFormat) = 0;
+
+    // exports one clip; this doesn't update the note on/off pairs,
+    // since the callers typically export many clips into one sequence,
+    // so they are expected to do that once when all clips are exported
     virtual void exportMidi(MidiMessageSequence &outSequence, const Clip &clip,
         const KeyboardMapping &keyMap, bool soloPlaybackMode,
         double timeAdjustment, double timeFactor) const;
@@ -64,6 +68,8 @@ public:
     // Don't notify anybody to prevent notification hell.
     // Always call notifyLayerChanged() when you're done using it.
 
+    // imported events are appended without sorting, so that the import is linear;
+    // the importMidi implementations are expected to call sort() once when done
     template<typename T>
     void importMidiEvent(const MidiEvent &eventToImport)
     {
@@ -76,8 +82,7 @@ public:
             return;
         }
 
-        static T comparator;
-        this->midiEvents.addSorted(comparator, new T(this, event));
+        this->midiEvents.add(new T(this, event));
     }
 
     template<typename T>
@@ -86,16 +91,14 @@ public:
         static T empty;
         UniquePointer<T> event(new T(this, empty));
         event->deserialize(parameters);
+        this->insertCheckedOutEvent(move(event));
+    }
 
-        if (this->usedEventIds.contains(event->getId()))
-        {
-            jassertfalse;
-            return;
-        }
-
-        static T comparator;
-        this->usedEventIds.insert(event->getId());
-        this->midiEvents.addSorted(comparator, event.release());
+    // assumes the parameters are coming from the VCS and have a valid id
+    template<typename T>
+    void checkoutEvent(const T &parameters)
+    {
+        this->insertCheckedOutEvent(UniquePointer<T>(new T(this, parameters)));
     }
 
     //===------------------------------------------------------------------===//
@@ -187,6 +190,20 @@ protected:
     
 private:
 
+    template<typename T>
+    void insertCheckedOutEvent(UniquePointer<T> event)
+    {
+        if (this->usedEventIds.contains(event->getId()))
+        {
+            jassertfalse;
+            return;
+        }
+
+        static T comparator;
+        this->usedEventIds.insert(event->getId());
+        this->midiEvents.addSorted(comparator, event.release());
+    }
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(MidiSequence)
     JUCE_DECLARE_WEAK_REFERENCEABLE(MidiSequence)
 };
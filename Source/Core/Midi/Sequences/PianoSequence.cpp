@@ -18,6 +18,7 @@
 #include "Common.h"
 #include "PianoSequence.h"
 
+#include "MidiTrack.h"
 #include "PianoRoll.h"
 #include "NoteActions.h"
 #include "SerializationKeys.h"
@@ -33,32 +34,56 @@ PianoSequence::PianoSequence(MidiTrack &track,
 
 void PianoSequence::importMidi(const MidiMessageSequence &sequence, short timeFormat)
 {
-    this->clearUndoHistory();
-    this->checkpoint();
+    // note-ons waiting for their note-offs are kept in per-channel-and-key stacks,
+    // linked through the event indices, so that all pairs are found in one pass
+    // (an overlapping note-on of the same key just gets its own note-off)
+    static constexpr auto numSlots = 16 * 128;
+    HeapBlock<int> pendingNoteOns(numSlots);
+    std::fill_n(pendingNoteOns.get(), numSlots, -1);
+
+    Array<int> previousNoteOns;
+    previousNoteOns.resize(sequence.getNumEvents());
+
+    const auto getSlot = [](const MidiMessage &message)
+    {
+        return (jlimit(1, 16, message.getChannel()) - 1) * 128 + message.getNoteNumber();
+    };
 
     for (int i = 0; i < sequence.getNumEvents(); ++i)
     {
-        const auto &messageOn = sequence.getEventPointer(i)->message;
-        if (messageOn.isNoteOn())
+        const auto &message = sequence.getEventPointer(i)->message;
+        if (message.isNoteOn())
         {
-            const int key = messageOn.getNoteNumber();
-            const float velocity = messageOn.getVelocity() / 128.f;
+            const auto slot = getSlot(message);
+            previousNoteOns.setUnchecked(i, pendingNoteOns[slot]);
+            pendingNoteOns[slot] = i;
+        }
+        else if (message.isNoteOff())
+        {
+            const auto slot = getSlot(message);
+            const auto noteOnIndex = pendingNoteOns[slot];
+            if (noteOnIndex < 0)
+            {
+                continue;
+            }
+
+            pendingNoteOns[slot] = previousNoteOns.getUnchecked(noteOnIndex);
+
+            const auto &messageOn = sequence.getEventPointer(noteOnIndex)->message;
             const float startBeat = MidiSequence::midiTicksToBeats(messageOn.getTimeStamp(), timeFormat);
-            const int noteOffIndex = sequence.getIndexOfMatchingKeyUp(i);
-            if (noteOffIndex > 0)
+            const float endBeat = MidiSequence::midiTicksToBeats(message.getTimeStamp(), timeFormat);
+            if (endBeat > startBeat)
             {
-                const MidiMessage &messageOff = sequence.getEventPointer(noteOffIndex)->message;
-                const float endBeat = MidiSequence::midiTicksToBeats(messageOff.getTimeStamp(), timeFormat);
-                if (endBeat > startBeat)
-                {
-                    const float length = endBeat - startBeat;
-                    const Note note(this, key, startBeat, length, velocity);
-                    this->importMidiEvent<Note>(note);
-                }
+                const int key = messageOn.getNoteNumber();
+                const float velocity = messageOn.getVelocity() / 128.f;
+                const float length = endBeat - startBeat;
+                const Note note(this, key, startBeat, length, velocity);
+                this->importMidiEvent<Note>(note);
             }
         }
     }
 
+    this->sort();
     this->updateBeatRange(false);
 }
 
@@ -76,8 +101,6 @@ void PianoSequence::exportMidi(MidiMessageSequence &outSequence, const Clip &cli
     {
         event->exportMessages(outSequence, clip, keyMap, timeAdjustment, timeFactor);
     }
-
-    outSequence.updateMatchedPairs();
 }
 
 //===----------------------------------------------------------------------===//
@@ -306,6 +329,18 @@ SerializedData PianoSequence::serialize() const
     return tree;
 }
 
+void PianoSequence::serializeTo(SerializedDataWriter &writer) const
+{
+    writer.beginNode(Serialization::Midi::track);
+
+    for (int i = 0; i < this->midiEvents.size(); ++i)
+    {
+        this->midiEvents.getUnchecked(i)->serializeTo(writer);
+    }
+
+    writer.endNode();
+}
+
 void PianoSequence::deserialize(const SerializedData &data)
 {
     this->reset();
@@ -340,3 +375,101 @@ void PianoSequence::reset()
     this->midiEvents.clear();
     this->usedEventIds.clear();
 }
+
+//===----------------------------------------------------------------------===//
+// Tests
+//===----------------------------------------------------------------------===//
+
+#if JUCE_UNIT_TESTS
+
+class PianoSequenceImportTests final : public UnitTest
+{
+public:
+    PianoSequenceImportTests() : UnitTest("Piano sequence MIDI import tests", UnitTestCategories::helio) {}
+
+    void runTest() override
+    {
+        EmptyMidiTrack track;
+        EmptyEventDispatcher dispatcher;
+
+        beginTest("Note on/off pairing");
+
+        {
+            MidiMessageSequence midi;
+            midi.addEvent(MidiMessage::noteOn(1, 60, 0.5f).withTimeStamp(0.0));
+            midi.addEvent(MidiMessage::noteOn(2, 60, 0.5f).withTimeStamp(0.0));
+            midi.addEvent(MidiMessage::noteOn(1, 60, 0.5f).withTimeStamp(96.0));
+            midi.addEvent(MidiMessage::noteOff(1, 60).withTimeStamp(192.0));
+            midi.addEvent(MidiMessage::noteOff(2, 60).withTimeStamp(288.0));
+            midi.addEvent(MidiMessage::noteOff(1, 60).withTimeStamp(384.0));
+            midi.addEvent(MidiMessage::noteOff(1, 62).withTimeStamp(384.0)); // stray
+            midi.addEvent(MidiMessage::noteOn(1, 64, 0.5f).withTimeStamp(384.0)); // never released
+
+            PianoSequence sequence(track, dispatcher);
+            sequence.importMidi(midi, 96);
+
+            expectEquals(sequence.size(), 3);
+
+            // sorted by beat, the inner note of the overlapping pair
+            // gets the first note-off, and the outer one gets the last:
+            const auto *n1 = static_cast<const Note *>(sequence.getUnchecked(0));
+            const auto *n2 = static_cast<const Note *>(sequence.getUnchecked(1));
+            const auto *n3 = static_cast<const Note *>(sequence.getUnchecked(2));
+            expectEquals(n1->getBeat() + n2->getBeat(), 0.f);
+            expectEquals(n1->getLength() + n2->getLength(), 7.f);
+            expectEquals(n3->getBeat(), 1.f);
+            expectEquals(n3->getLength(), 1.f);
+            expectEquals(sequence.getLastBeat(), 4.f);
+        }
+
+        beginTest("Large file import performance");
+
+        {
+            // an orchestral-sized track: chords over all channels,
+            // with overlapping notes, stored and read as a real SMF
+            static constexpr auto numNotes = 200000;
+            static constexpr auto ticksPerBeat = 480;
+
+            Random random(1);
+            MidiMessageSequence generated;
+            for (int i = 0; i < numNotes; ++i)
+            {
+                const auto channel = 1 + (i % 16);
+                const auto key = 36 + random.nextInt(60);
+                const auto startTick = double((i / 8) * ticksPerBeat / 4);
+                const auto lengthTicks = double(ticksPerBeat / 8 + random.nextInt(ticksPerBeat * 4));
+                generated.addEvent(MidiMessage::noteOn(channel, key, 0.75f).withTimeStamp(startTick));
+                generated.addEvent(MidiMessage::noteOff(channel, key).withTimeStamp(startTick + lengthTicks));
+            }
+
+            MidiFile generatedFile;
+            generatedFile.setTicksPerQuarterNote(ticksPerBeat);
+            generatedFile.addTrack(generated);
+
+            MemoryOutputStream out;
+            expect(generatedFile.writeTo(out));
+
+            MemoryInputStream in(out.getData(), out.getDataSize(), false);
+            MidiFile file;
+            expect(file.readFrom(in, false));
+
+            PianoSequence sequence(track, dispatcher);
+            const auto startMs = Time::getMillisecondCounterHiRes();
+            sequence.importMidi(*file.getTrack(0), file.getTimeFormat());
+            const auto importMs = Time::getMillisecondCounterHiRes() - startMs;
+
+            expectEquals(sequence.size(), numNotes);
+            for (int i = 1; i < sequence.size(); ++i)
+            {
+                expect(sequence.getUnchecked(i - 1)->getBeat() <= sequence.getUnchecked(i)->getBeat());
+            }
+
+            logMessage("Imported " + String(numNotes) + " notes (" + String(out.getDataSize() / 1024) +
+                " kb file) in " + String(importMs, 1) + " ms");
+        }
+    }
+};
+
+static PianoSequenceImportTests pianoSequenceImportTests;
+
+#endif
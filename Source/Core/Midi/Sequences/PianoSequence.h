@@ -57,6 +57,7 @@ public:
     //===------------------------------------------------------------------===//
 
     SerializedData serialize() const override;
+    void serializeTo(SerializedDataWriter &writer) const override;
     void deserialize(const SerializedData &data) override;
     void reset() override;
 
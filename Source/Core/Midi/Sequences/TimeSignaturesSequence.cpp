@@ -32,9 +32,6 @@ TimeSignaturesSequence::TimeSignaturesSequence(MidiTrack &track,
 
 void TimeSignaturesSequence::importMidi(const MidiMessageSequence &sequence, short timeFormat)
 {
-    this->clearUndoHistory();
-    this->checkpoint();
-
     for (int i = 0; i < sequence.getNumEvents(); ++i)
     {
         const MidiMessage &message = sequence.getEventPointer(i)->message;
@@ -49,6 +46,7 @@ void TimeSignaturesSequence::importMidi(const MidiMessageSequence &sequence, sho
         }
     }
 
+    this->sort();
     this->updateBeatRange(false);
 }
 
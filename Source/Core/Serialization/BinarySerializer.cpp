@@ -21,6 +21,26 @@
 static const char *kHelioHeaderV2String = "Helio2::";
 static const uint64 kHelioHeaderV2 = ByteOrder::littleEndianInt64(kHelioHeaderV2String);
 
+// v3 is the compact format, with the property names table,
+// v2 files are still readable, but not written anymore
+static const char *kHelioHeaderV3String = "Helio3::";
+static const uint64 kHelioHeaderV3 = ByteOrder::littleEndianInt64(kHelioHeaderV3String);
+
+static SerializedData readWithAnyHeader(InputStream &inputStream)
+{
+    const auto magicNumber = static_cast<uint64>(inputStream.readInt64());
+    if (magicNumber == kHelioHeaderV3)
+    {
+        return SerializedData::readFromCompactStream(inputStream);
+    }
+    else if (magicNumber == kHelioHeaderV2)
+    {
+        return SerializedData::readFromStream(inputStream);
+    }
+
+    return {};
+}
+
 Result BinarySerializer::saveToFile(File file, const SerializedData &tree) const
 {
     FileOutputStream fileStream(file);
@@ -28,8 +48,8 @@ Result BinarySerializer::saveToFile(File file, const SerializedData &tree) const
     {
         fileStream.setPosition(0);
         fileStream.truncate();
-        fileStream.writeInt64(kHelioHeaderV2);
-        tree.writeToStream(fileStream);
+        fileStream.writeInt64(kHelioHeaderV3);
+        tree.writeToCompactStream(fileStream);
         return Result::ok();
     }
 
@@ -49,11 +69,7 @@ SerializedData BinarySerializer::loadFromFile(const File &file) const
     if (file.loadFileAsData(mb))
     {
         MemoryInputStream inputStream(mb, false);
-        const auto magicNumber = static_cast<uint64>(inputStream.readInt64());
-        if (magicNumber == kHelioHeaderV2)
-        {
-            return SerializedData::readFromStream(inputStream);
-        }
+        return readWithAnyHeader(inputStream);
     }
 
     return {};
@@ -62,8 +78,8 @@ SerializedData BinarySerializer::loadFromFile(const File &file) const
 Result BinarySerializer::saveToString(String &string, const SerializedData &tree) const
 {
     MemoryOutputStream memStream;
-    memStream.writeInt64(kHelioHeaderV2);
-    tree.writeToStream(memStream);
+    memStream.writeInt64(kHelioHeaderV3);
+    tree.writeToCompactStream(memStream);
     string = memStream.toUTF8();
     return Result::ok();
 }
@@ -72,12 +88,75 @@ SerializedData BinarySerializer::loadFromString(const String &string) const
 {
     if (string.isNotEmpty())
     {
-        return SerializedData::readFromData(string.toUTF8(), string.getNumBytesAsUTF8());
+        MemoryInputStream inputStream(string.toUTF8(), string.getNumBytesAsUTF8(), false);
+        return readWithAnyHeader(inputStream);
     }
 
     return {};
 }
 
+// The binary format isn't really streamable, since it has the key table,
+// which is only complete when the whole tree is written, so this one
+// builds the tree first, and writes it when the root node is closed:
+class BinaryTreeWriter final : public SerializedDataWriter
+{
+public:
+
+    explicit BinaryTreeWriter(OutputStream &output) : output(output) {}
+
+    void beginNode(const Identifier &type) override
+    {
+        this->depth++;
+        this->builder.beginNode(type);
+    }
+
+    void writeProperty(const Identifier &name, const var &value) override
+    {
+        this->builder.writeProperty(name, value);
+    }
+
+    void endNode() override
+    {
+        this->builder.endNode();
+        this->depth--;
+
+        if (this->depth == 0)
+        {
+            this->output.writeInt64(kHelioHeaderV3);
+            this->builder.getResult().writeToCompactStream(this->output);
+        }
+    }
+
+private:
+
+    OutputStream &output;
+    SerializedDataBuilder builder;
+    int depth = 0;
+
+    JUCE_DECLARE_NON_COPYABLE(BinaryTreeWriter)
+};
+
+UniquePointer<SerializedDataWriter> BinarySerializer::createWriter(OutputStream &output) const
+{
+    return make<BinaryTreeWriter>(output);
+}
+
+Result BinarySerializer::read(InputStream &input, SerializedDataWriter &target) const
+{
+    MemoryBlock mb;
+    input.readIntoMemoryBlock(mb);
+    MemoryInputStream inputStream(mb, false);
+
+    const auto tree = readWithAnyHeader(inputStream);
+    if (!tree.isValid())
+    {
+        return Result::fail("Failed to read");
+    }
+
+    target.writeNode(tree);
+    return Result::ok();
+}
+
 bool BinarySerializer::supportsFileWithExtension(const String &extension) const
 {
     return extension.endsWithIgnoreCase("hp") ||
@@ -86,5 +165,6 @@ bool BinarySerializer::supportsFileWithExtension(const String &extension) const
 
 bool BinarySerializer::supportsFileWithHeader(const String &header) const
 {
-    return header.startsWith(kHelioHeaderV2String);
+    return header.startsWith(kHelioHeaderV3String) ||
+        header.startsWith(kHelioHeaderV2String);
 }
@@ -85,6 +85,38 @@ public:
         return false;
     }
 
+    // streams the data into the file as it is written,
+    // (the binary format still has to collect the tree first,
+    // since it writes the property names table before the nodes)
+    template <typename T>
+    static bool save(const File &file, const std::function<void(SerializedDataWriter &)> &writeData)
+    {
+        static T serializer;
+        TempDocument tempDoc(file);
+
+        {
+            FileOutputStream fileStream(tempDoc.getFile());
+            if (!fileStream.openedOk())
+            {
+                return false;
+            }
+
+            fileStream.setPosition(0);
+            fileStream.truncate();
+
+            auto writer = serializer.createWriter(fileStream);
+            writeData(*writer);
+
+            fileStream.flush();
+            if (fileStream.getStatus().failed())
+            {
+                return false;
+            }
+        }
+
+        return tempDoc.overwriteTargetFileWithTemporary();
+    }
+
     class TempDocument final
     {
     public:
@@ -22,46 +22,163 @@
 // Json parser
 //===----------------------------------------------------------------------===//
 
-// Slightly modified JSONParser from JUCE classes,
-// but returns SerializedData instead of var, and supports comments like `//` and `/* */`.
+// Slightly modified JSONParser from JUCE classes, but reads the input stream
+// byte by byte, passing the nodes and properties to the target writer as it goes,
+// and supports comments like `//` and `/* */`.
 // Parses arrays and objects as nodes/children, and all others as properties.
 
-struct JsonParser final
+class JsonParser final
 {
-    static Result parseObjectOrArray(String::CharPointerType t, SerializedData &result)
+public:
+
+    JsonParser(InputStream &input, SerializedDataWriter &target) :
+        input(input), target(target), buffer(256) {}
+
+    // top-level primitive values need some parent node, which is only
+    // the case when the target is wrapped into a fake root node
+    Result parseObjectOrArray(bool allowTopLevelProperties)
     {
-        skipCommentsAndWhitespaces(t);
+        this->allowTopLevelProperties = allowTopLevelProperties;
+        this->skipByteOrderMark();
+        this->skipCommentsAndWhitespaces();
 
-        switch (t.getAndAdvance())
+        switch (this->input.next())
         {
-        case 0:      result = SerializedData(); return Result::ok();
-        case '{':    return parseObject(t, result);
-        case '[':    return parseArray(t, result, result.getType());
+        case 0:      return Result::ok();
+        case '{':    return this->parseObject();
+        case '[':    return this->parseArray(JsonParser::topLevelArrayItem);
         }
 
-        return createFail("Expected '{' or '['", &t);
+        return this->createFail("Expected '{' or '['");
     }
 
-    static Result parseStringProperty(const juce_wchar quoteChar, String::CharPointerType &t, const Identifier &propertyName, SerializedData &tree)
+    static const Identifier topLevelArrayItem;
+
+private:
+
+    // the files edited manually might have been saved with the utf-8 bom,
+    // which File::loadFileAsString used to skip
+    void skipByteOrderMark()
     {
-        String property;
-        const auto r = parseString(quoteChar, t, property);
-        if (r.wasOk())
+        if (static_cast<uint8>(this->input.peek()) == 0xef)
+        {
+            this->input.next();
+            this->input.next();
+            this->input.next();
+        }
+    }
+
+    Result parseAny(const Identifier &nodeOrProperty)
+    {
+        this->skipCommentsAndWhitespaces();
+
+        const auto c = this->input.peek();
+        switch (c)
+        {
+        case '{':
+            this->input.next();
+            this->target.beginNode(nodeOrProperty);
+            this->depth++;
+            {
+                const auto result = this->parseObject();
+                this->depth--;
+                this->target.endNode();
+                return result;
+            }
+
+        case '[':
+            this->input.next();
+            return this->parseArray(nodeOrProperty);
+
+        case '"':
+        case '\'':
         {
-            tree.setProperty(propertyName, property);
+            this->input.next();
+            String property;
+            const auto r = this->parseString(c, property);
+            if (r.wasOk())
+            {
+                return this->setProperty(nodeOrProperty, property);
+            }
+
+            return r;
         }
 
-        return r;
+        case '-':
+            this->input.next();
+            this->skipCommentsAndWhitespaces();
+            if (!CharacterFunctions::isDigit(this->input.peek()))
+            {
+                break;
+            }
+
+            return this->parseNumberProperty(nodeOrProperty, true);
+
+        case '0': case '1': case '2': case '3': case '4':
+        case '5': case '6': case '7': case '8': case '9':
+            return this->parseNumberProperty(nodeOrProperty, false);
+
+        case 't':   // "true"
+            if (this->skipWord("true"))
+            {
+                return this->setProperty(nodeOrProperty, true);
+            }
+            break;
+
+        case 'f':   // "false"
+            if (this->skipWord("false"))
+            {
+                return this->setProperty(nodeOrProperty, false);
+            }
+            break;
+
+        case 'n':   // "null"
+            if (this->skipWord("null"))
+            {
+                // no need to set any property in this case?
+                return Result::ok();
+            }
+            break;
+
+        default:
+            break;
+        }
+
+        return this->createFail("Syntax error");
+    }
+
+    Result setProperty(const Identifier &name, const var &value)
+    {
+        if (this->depth == 0 && !this->allowTopLevelProperties)
+        {
+            return this->createFail("Expected a node, but found a property");
+        }
+
+        this->target.writeProperty(name, value);
+        return Result::ok();
     }
 
-    static Result parseString(const juce_wchar quoteChar, String::CharPointerType &t, String &result)
+    bool skipWord(const char *word)
     {
-        static MemoryOutputStream buffer(256);
-        buffer.reset();
+        for (auto *c = word; *c != 0; ++c)
+        {
+            if (this->input.next() != *c)
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    Result parseString(const juce_wchar quoteChar, String &result)
+    {
+        this->buffer.reset();
 
         for (;;)
         {
-            auto c = t.getAndAdvance();
+            // multi-byte utf-8 characters are copied as is
+            juce_wchar c = static_cast<uint8>(this->input.next());
 
             if (c == quoteChar)
             {
@@ -70,7 +187,7 @@ struct JsonParser final
 
             if (c == '\\')
             {
-                c = t.getAndAdvance();
+                c = static_cast<uint8>(this->input.next());
 
                 switch (c)
                 {
@@ -92,271 +209,218 @@ struct JsonParser final
 
                     for (int i = 4; --i >= 0;)
                     {
-                        auto digitValue = CharacterFunctions::getHexDigitValue(t.getAndAdvance());
-                        if (digitValue < 0) { return createFail("Syntax error in Unicode escape sequence"); }
+                        auto digitValue = CharacterFunctions::getHexDigitValue(this->input.next());
+                        if (digitValue < 0) { return this->createFail("Syntax error in Unicode escape sequence"); }
                         c = (juce_wchar)((c << 4) + static_cast<juce_wchar> (digitValue));
                     }
 
-                    break;
+                    if (c == 0) { return this->createFail("Unexpected end-of-input in string constant"); }
+                    this->buffer.appendUTF8Char(c);
+                    continue;
                 }
                 }
             }
 
-            if (c == 0) { return createFail("Unexpected end-of-input in string constant"); }
-            buffer.appendUTF8Char(c);
+            if (c == 0) { return this->createFail("Unexpected end-of-input in string constant"); }
+            this->buffer.writeByte(char(c));
         }
 
-        result = buffer.toUTF8();
+        result = String::fromUTF8(static_cast<const char *>(this->buffer.getData()),
+            int(this->buffer.getDataSize()));
+
         return Result::ok();
     }
 
-    static void findNextNewline(String::CharPointerType &t)
+    void findNextNewline()
     {
-        juce_wchar c = 0;
-        do { c = t.getAndAdvance(); } while (c != '\n' && c != '\r');
+        char c = 0;
+        do { c = this->input.next(); } while (c != '\n' && c != '\r' && c != 0);
     }
 
-    static void findEndOfMultilineComment(String::CharPointerType &t)
+    void findEndOfMultilineComment()
     {
-        juce_wchar c1 = 0;
-        juce_wchar c2 = 0;
+        char c1 = 0;
+        char c2 = 0;
         do
         { 
             c1 = c2;
-            c2 = t.getAndAdvance();
+            c2 = this->input.next();
             if (c2 == 0) { return; }
         } while (c1 != '*' || c2 != '/');
     }
 
-    static void skipCommentsAndWhitespaces(String::CharPointerType &t)
+    void skipCommentsAndWhitespaces()
     {
-        t = t.findEndOfWhitespace();
-        auto t2 = t;
-        switch (t2.getAndAdvance())
+        for (;;)
         {
-        case '/':
-            const auto c = t2.getAndAdvance();
-            if (c == '/')
+            while (CharacterFunctions::isWhitespace(this->input.peek()))
             {
-                t = t2;
-                findNextNewline(t);
-                skipCommentsAndWhitespaces(t);
+                this->input.next();
             }
-            else if (c == '*')
-            {
-                t = t2;
-                findEndOfMultilineComment(t);
-                skipCommentsAndWhitespaces(t);
-            }
-        }
-    }
-
-    static Result parseAny(String::CharPointerType &t, SerializedData &result, const Identifier &nodeOrProperty)
-    {
-        skipCommentsAndWhitespaces(t);
-        auto t2 = t;
 
-        switch (t2.getAndAdvance())
-        {
-        case '{':
+            if (this->input.peek() != '/')
             {
-                t = t2;
-                SerializedData child(nodeOrProperty);
-                result.appendChild(child);
-                return parseObject(t, child);
+                return;
             }
 
-        case '[':
-            t = t2;
-            return parseArray(t, result, nodeOrProperty);
-
-        case '"':
-            t = t2;
-            return parseStringProperty('"', t, nodeOrProperty, result);
-
-        case '\'':
-            t = t2;
-            return parseStringProperty('\'', t, nodeOrProperty, result);
-
-        case '-':
-            skipCommentsAndWhitespaces(t2);
-            if (!CharacterFunctions::isDigit(*t2))
-                break;
-
-            t = t2;
-            return parseNumberProperty(t, nodeOrProperty, result, true);
-
-        case '0': case '1': case '2': case '3': case '4':
-        case '5': case '6': case '7': case '8': case '9':
-            return parseNumberProperty(t, nodeOrProperty, result, false);
-
-        case 't':   // "true"
-            if (t2.getAndAdvance() == 'r' && t2.getAndAdvance() == 'u' && t2.getAndAdvance() == 'e')
+            // a lone slash is a syntax error anyway
+            this->input.next();
+            const auto c = this->input.next();
+            if (c == '/')
             {
-                t = t2;
-                result.setProperty(nodeOrProperty, true);
-                return Result::ok();
+                this->findNextNewline();
             }
-            break;
-
-        case 'f':   // "false"
-            if (t2.getAndAdvance() == 'a' && t2.getAndAdvance() == 'l'
-                && t2.getAndAdvance() == 's' && t2.getAndAdvance() == 'e')
+            else if (c == '*')
             {
-                t = t2;
-                result.setProperty(nodeOrProperty, false);
-                return Result::ok();
+                this->findEndOfMultilineComment();
             }
-            break;
-
-        case 'n':   // "null"
-            if (t2.getAndAdvance() == 'u' && t2.getAndAdvance() == 'l' && t2.getAndAdvance() == 'l')
+            else
             {
-                t = t2;
-                // no need to set any property in this case?
-                return Result::ok();
+                return;
             }
-            break;
-
-        default:
-            break;
         }
-
-        return createFail("Syntax error", &t);
     }
 
-private:
-    static Result createFail(const char *const message, const String::CharPointerType *location = nullptr)
+    Result createFail(const char *const message) const
     {
         String m(message);
-        if (location != nullptr)
-            m << ": \"" << String(*location, 20) << '"';
-
+        m << " at " << String(this->input.getPosition());
         return Result::fail(m);
     }
 
-    static Result parseNumberProperty(String::CharPointerType &t, const Identifier &propertyName, SerializedData &result, const bool isNegative)
+    Result parseNumberProperty(const Identifier &propertyName, const bool isNegative)
     {
-        auto oldT = t;
+        // the digits are also collected, in case it turns out to be a double
+        this->buffer.reset();
 
-        int64 intValue = t.getAndAdvance() - '0';
-        jassert(intValue >= 0 && intValue < 10);
+        int64 intValue = 0;
+        bool isDouble = false;
 
         for (;;)
         {
-            auto previousChar = t;
-            auto c = t.getAndAdvance();
-            auto digit = ((int)c) - '0';
+            const auto c = this->input.peek();
+            const auto digit = int(c) - '0';
 
             if (isPositiveAndBelow(digit, 10))
             {
                 intValue = intValue * 10 + digit;
-                continue;
             }
-
-            if (c == 'e' || c == 'E' || c == '.')
+            else if (c == 'e' || c == 'E' || c == '.' ||
+                (isDouble && (c == '-' || c == '+')))
             {
-                t = oldT;
-                auto asDouble = CharacterFunctions::readDoubleValue(t);
-                result.setProperty(propertyName, isNegative ? -asDouble : asDouble);
-                return Result::ok();
+                isDouble = true;
             }
-
-            if (CharacterFunctions::isWhitespace(c)
+            else if (CharacterFunctions::isWhitespace(c)
                 || c == ',' || c == '}' || c == ']' || c == 0)
             {
-                t = previousChar;
                 break;
             }
+            else
+            {
+                return this->createFail("Syntax error in number");
+            }
+
+            this->buffer.writeByte(this->input.next());
+        }
 
-            return createFail("Syntax error in number", &oldT);
+        if (isDouble)
+        {
+            this->buffer.writeByte(0);
+            auto t = String::CharPointerType(static_cast<const char *>(this->buffer.getData()));
+            const auto asDouble = CharacterFunctions::readDoubleValue(t);
+            return this->setProperty(propertyName, isNegative ? -asDouble : asDouble);
         }
 
         auto correctedValue = isNegative ? -intValue : intValue;
 
         if ((intValue >> 31) != 0)
-            result.setProperty(propertyName, correctedValue);
-        else
-            result.setProperty(propertyName, (int)correctedValue);
+        {
+            return this->setProperty(propertyName, correctedValue);
+        }
 
-        return Result::ok();
+        return this->setProperty(propertyName, (int)correctedValue);
     }
 
-    static Result parseObject(String::CharPointerType &t, SerializedData &result)
+    Result parseObject()
     {
         for (;;)
         {
-            skipCommentsAndWhitespaces(t);
+            this->skipCommentsAndWhitespaces();
 
-            auto oldT = t;
-            auto c = t.getAndAdvance();
+            const auto c = this->input.next();
 
             if (c == '}') { break; }
-            if (c == 0) { return createFail("Unexpected end-of-input in object declaration"); }
+            if (c == 0) { return this->createFail("Unexpected end-of-input in object declaration"); }
             if (c == '"')
             {
                 String nodeNameVar;
-                const auto r = parseString('"', t, nodeNameVar);
+                const auto r = this->parseString('"', nodeNameVar);
                 if (r.failed()) { return r; }
 
-                const Identifier nodeName(nodeNameVar);
-                if (nodeName.isValid())
+                if (nodeNameVar.isNotEmpty())
                 {
-                    skipCommentsAndWhitespaces(t);
-                    oldT = t;
+                    const Identifier nodeName(nodeNameVar);
 
-                    auto c2 = t.getAndAdvance();
+                    this->skipCommentsAndWhitespaces();
 
-                    if (c2 != ':') { return createFail("Expected ':', but found", &oldT); }
+                    if (this->input.next() != ':') { return this->createFail("Expected ':'"); }
 
-                    const auto r2 = parseAny(t, result, nodeName);
+                    const auto r2 = this->parseAny(nodeName);
                     if (r2.failed()) { return r2; }
 
-                    skipCommentsAndWhitespaces(t);
-                    oldT = t;
+                    this->skipCommentsAndWhitespaces();
 
-                    auto nextChar = t.getAndAdvance();
+                    const auto nextChar = this->input.next();
                     if (nextChar == ',') { continue; }
                     if (nextChar == '}') { break; }
                 }
             }
 
-            return createFail("Expected object member declaration, but found", &oldT);
+            return this->createFail("Expected object member declaration");
         }
 
         return Result::ok();
     }
 
-    static Result parseArray(String::CharPointerType &t, SerializedData &result, const Identifier &nodeName)
+    Result parseArray(const Identifier &nodeName)
     {
         for (;;)
         {
-            skipCommentsAndWhitespaces(t);
+            this->skipCommentsAndWhitespaces();
 
-            auto oldT = t;
-            auto c = t.getAndAdvance();
+            const auto c = this->input.peek();
 
-            if (c == ']') { break; }
-            if (c == 0) { return createFail("Unexpected end-of-input in array declaration"); }
+            if (c == ']') { this->input.next(); break; }
+            if (c == 0) { return this->createFail("Unexpected end-of-input in array declaration"); }
 
-            t = oldT;
-            auto r = parseAny(t, result, nodeName);
+            const auto r = this->parseAny(nodeName);
 
             if (r.failed()) { return r; }
 
-            skipCommentsAndWhitespaces(t);
-            oldT = t;
+            this->skipCommentsAndWhitespaces();
 
-            auto nextChar = t.getAndAdvance();
+            const auto nextChar = this->input.next();
             if (nextChar == ',') { continue; }
             if (nextChar == ']') { break; }
-            return createFail("Expected object array item, but found", &oldT);
+            return this->createFail("Expected object array item");
         }
 
         return Result::ok();
     }
+
+    SerializedDataStreamReader input;
+    SerializedDataWriter &target;
+    MemoryOutputStream buffer;
+
+    int depth = 0;
+    bool allowTopLevelProperties = false;
+
+    JUCE_DECLARE_NON_COPYABLE(JsonParser)
 };
 
+// the same as the fake root node name, as it used to be
+const Identifier JsonParser::topLevelArrayItem = "root";
+
 //===----------------------------------------------------------------------===//
 // Json formatter
 //===----------------------------------------------------------------------===//
@@ -515,6 +579,11 @@ struct JsonFormatter final
         {
             out << String(static_cast<double> (v), maximumDecimalPlaces);
         }
+        else if (v.isBinaryData())
+        {
+            // base64, just like in xml attributes
+            out << '"' << v.toString() << '"';
+        }
         else
         {
             // Should never hit this point anyway
@@ -616,6 +685,275 @@ struct JsonFormatter final
     enum { indentSize = 2 };
 };
 
+//===----------------------------------------------------------------------===//
+// Json stream writer
+//===----------------------------------------------------------------------===//
+
+// Writes the same format as the formatter above, except that it can't know
+// in advance how many children of the same type are there, so all children
+// are written as arrays, even if there's only one; the parser reads both.
+
+// Object keys have to stay unique, so the children are grouped by type:
+// the first type in each node is written directly into the output,
+// and the children of other types are formatted into per-type buffers,
+// which are flushed when the node is closed. For the typical trees,
+// where most children are of the same type, most data is not buffered.
+
+class JsonStreamWriter final : public SerializedDataWriter
+{
+public:
+
+    JsonStreamWriter(OutputStream &out, const StringArray &headerComments,
+        bool allOnOneLine, int maximumDecimalPlaces) :
+        out(out),
+        headerComments(headerComments),
+        allOnOneLine(allOnOneLine),
+        maximumDecimalPlaces(maximumDecimalPlaces) {}
+
+    ~JsonStreamWriter() override
+    {
+        // all nodes are expected to be closed
+        jassert(this->openNodes.isEmpty());
+    }
+
+    void beginNode(const Identifier &type) override
+    {
+        OpenNode node;
+
+        if (this->openNodes.isEmpty())
+        {
+            this->writeDocumentStart(type);
+            node.out = &this->out;
+            node.indentLevel = JsonFormatter::indentSize;
+        }
+        else
+        {
+            auto &parent = this->openNodes.getReference(this->openNodes.size() - 1);
+            node.indentLevel = parent.indentLevel + JsonFormatter::indentSize * 2;
+
+            if (!parent.streamedType.isValid())
+            {
+                this->writeMemberName(parent, type);
+                *parent.out << '[';
+                if (!this->allOnOneLine) { *parent.out << newLine; }
+                parent.streamedType = type;
+                node.out = parent.out;
+            }
+            else if (parent.streamedType == type)
+            {
+                this->writeItemSeparator(*parent.out);
+                node.out = parent.out;
+            }
+            else
+            {
+                auto *group = this->findOrAddBufferedGroup(parent, type);
+                if (group->numItems > 0)
+                {
+                    this->writeItemSeparator(group->buffer);
+                }
+
+                group->numItems++;
+                node.out = &group->buffer;
+            }
+
+            if (!this->allOnOneLine) { JsonFormatter::writeSpaces(*node.out, node.indentLevel); }
+        }
+
+        *node.out << '{';
+        if (!this->allOnOneLine) { *node.out << newLine; }
+
+        node.firstBufferedGroup = this->bufferedGroups.size();
+        this->openNodes.add(node);
+    }
+
+    void writeProperty(const Identifier &name, const var &value) override
+    {
+        jassert(!this->openNodes.isEmpty());
+        if (this->openNodes.isEmpty())
+        {
+            return;
+        }
+
+        auto &node = this->openNodes.getReference(this->openNodes.size() - 1);
+
+        // the properties are expected to go before the children,
+        // the late ones are written after all children groups
+        if (node.streamedType.isValid())
+        {
+            node.lateProperties.set(name, value);
+            return;
+        }
+
+        this->writeMemberName(node, name);
+        JsonFormatter::writeProperty(*node.out, value, this->maximumDecimalPlaces);
+    }
+
+    void endNode() override
+    {
+        jassert(!this->openNodes.isEmpty());
+        if (this->openNodes.isEmpty())
+        {
+            return;
+        }
+
+        auto &node = this->openNodes.getReference(this->openNodes.size() - 1);
+
+        if (node.streamedType.isValid())
+        {
+            this->writeArrayEnd(node);
+        }
+
+        for (int i = node.firstBufferedGroup; i < this->bufferedGroups.size(); ++i)
+        {
+            const auto *group = this->bufferedGroups.getUnchecked(i);
+            this->writeMemberName(node, group->type);
+            *node.out << '[';
+            if (!this->allOnOneLine) { *node.out << newLine; }
+            node.out->write(group->buffer.getData(), group->buffer.getDataSize());
+            this->writeArrayEnd(node);
+        }
+
+        this->bufferedGroups.removeRange(node.firstBufferedGroup,
+            this->bufferedGroups.size() - node.firstBufferedGroup);
+
+        for (const auto &property : node.lateProperties)
+        {
+            this->writeMemberName(node, property.name);
+            JsonFormatter::writeProperty(*node.out, property.value, this->maximumDecimalPlaces);
+        }
+
+        if (!this->allOnOneLine)
+        {
+            if (node.hasMembers) { *node.out << newLine; }
+            JsonFormatter::writeSpaces(*node.out, node.indentLevel);
+        }
+
+        *node.out << '}';
+        this->openNodes.removeLast();
+
+        if (this->openNodes.isEmpty())
+        {
+            if (!this->allOnOneLine) { this->out << newLine; }
+            this->out << '}';
+        }
+    }
+
+private:
+
+    struct BufferedGroup final
+    {
+        explicit BufferedGroup(const Identifier &type) : type(type) {}
+
+        const Identifier type;
+        MemoryOutputStream buffer;
+        int numItems = 0;
+    };
+
+    struct OpenNode final
+    {
+        OutputStream *out = nullptr; // either the output, or the parent's group buffer
+        int indentLevel = 0;
+        bool hasMembers = false;
+        Identifier streamedType; // the children of this type are not buffered
+        int firstBufferedGroup = 0;
+        NamedValueSet lateProperties;
+    };
+
+    void writeDocumentStart(const Identifier &rootType)
+    {
+        // only one root node is expected
+        jassert(!this->hasWrittenRoot);
+        this->hasWrittenRoot = true;
+
+        this->out << '{';
+        if (!this->allOnOneLine) { this->out << newLine; }
+
+        if (this->headerComments.size() > 0)
+        {
+            if (!this->allOnOneLine) { JsonFormatter::writeSpaces(this->out, JsonFormatter::indentSize); }
+            this->out << "/*";
+            if (!this->allOnOneLine) { this->out << newLine; }
+
+            for (const auto &comment : this->headerComments)
+            {
+                if (!this->allOnOneLine)
+                {
+                    JsonFormatter::writeSpaces(this->out, JsonFormatter::indentSize);
+                    this->out << " *";
+                }
+
+                this->out << ' ' << comment;
+                if (!this->allOnOneLine) { this->out << newLine; }
+            }
+
+            if (!this->allOnOneLine) { JsonFormatter::writeSpaces(this->out, JsonFormatter::indentSize); }
+            this->out << " */";
+            if (!this->allOnOneLine) { this->out << newLine; }
+        }
+
+        if (!this->allOnOneLine) { JsonFormatter::writeSpaces(this->out, JsonFormatter::indentSize); }
+        this->out << '"';
+        JsonFormatter::writeString(this->out, rootType);
+        this->out << "\": ";
+    }
+
+    BufferedGroup *findOrAddBufferedGroup(const OpenNode &node, const Identifier &type)
+    {
+        // there are only a few different types of children in a node
+        for (int i = node.firstBufferedGroup; i < this->bufferedGroups.size(); ++i)
+        {
+            if (this->bufferedGroups.getUnchecked(i)->type == type)
+            {
+                return this->bufferedGroups.getUnchecked(i);
+            }
+        }
+
+        return this->bufferedGroups.add(new BufferedGroup(type));
+    }
+
+    void writeItemSeparator(OutputStream &target)
+    {
+        if (this->allOnOneLine) { target << ", "; } else { target << ',' << newLine; }
+    }
+
+    void writeMemberName(OpenNode &node, const Identifier &name)
+    {
+        if (node.hasMembers)
+        {
+            this->writeItemSeparator(*node.out);
+        }
+
+        node.hasMembers = true;
+
+        if (!this->allOnOneLine) { JsonFormatter::writeSpaces(*node.out, node.indentLevel + JsonFormatter::indentSize); }
+        *node.out << '"';
+        JsonFormatter::writeString(*node.out, name);
+        *node.out << "\": ";
+    }
+
+    void writeArrayEnd(OpenNode &node)
+    {
+        if (!this->allOnOneLine)
+        {
+            *node.out << newLine;
+            JsonFormatter::writeSpaces(*node.out, node.indentLevel + JsonFormatter::indentSize);
+        }
+
+        *node.out << ']';
+    }
+
+    OutputStream &out;
+    const StringArray headerComments;
+    const bool allOnOneLine;
+    const int maximumDecimalPlaces;
+
+    Array<OpenNode> openNodes;
+    OwnedArray<BufferedGroup> bufferedGroups;
+    bool hasWrittenRoot = false;
+
+    JUCE_DECLARE_NON_COPYABLE(JsonStreamWriter)
+};
+
 //===----------------------------------------------------------------------===//
 // Json serializer
 //===----------------------------------------------------------------------===//
@@ -647,12 +985,21 @@ Result JsonSerializer::saveToFile(File file, const SerializedData &tree) const
 
 SerializedData JsonSerializer::loadFromFile(const File &file) const
 {
-    const String text(file.loadFileAsString());
-    SerializedData root(fakeRoot);
-    const auto result = JsonParser::parseObjectOrArray(text.getCharPointer(), root);
+    FileInputStream fileStream(file);
+    if (!fileStream.openedOk())
+    {
+        return {};
+    }
+
+    SerializedDataBuilder builder;
+    builder.beginNode(fakeRoot);
+    JsonParser parser(fileStream, builder);
+    const auto result = parser.parseObjectOrArray(true);
+    builder.endNode();
+
     if (result.wasOk())
     {
-        return root.getChild(0);
+        return builder.getResult().getChild(0);
     }
 
     return {};
@@ -668,10 +1015,17 @@ Result JsonSerializer::saveToString(String &string, const SerializedData &tree)
 
 SerializedData JsonSerializer::loadFromString(const String &string) const
 {
-    SerializedData root(fakeRoot);
-    const auto result = JsonParser::parseObjectOrArray(string.getCharPointer(), root);
+    MemoryInputStream stringStream(string.toRawUTF8(), string.getNumBytesAsUTF8(), false);
+
+    SerializedDataBuilder builder;
+    builder.beginNode(fakeRoot);
+    JsonParser parser(stringStream, builder);
+    const auto result = parser.parseObjectOrArray(true);
+    builder.endNode();
+
     if (result.wasOk())
     {
+        const auto root = builder.getResult();
         if (root.getNumChildren() == 1 && root.getNumProperties() == 0)
         {
             // expected behaviour in most cases:
@@ -687,6 +1041,17 @@ SerializedData JsonSerializer::loadFromString(const String &string) const
     return {};
 }
 
+UniquePointer<SerializedDataWriter> JsonSerializer::createWriter(OutputStream &output) const
+{
+    return make<JsonStreamWriter>(output, this->headerComments, this->allOnOneLine, 6);
+}
+
+Result JsonSerializer::read(InputStream &input, SerializedDataWriter &target) const
+{
+    JsonParser parser(input, target);
+    return parser.parseObjectOrArray(false);
+}
+
 bool JsonSerializer::supportsFileWithExtension(const String &extension) const
 {
     return extension.endsWithIgnoreCase("json");
@@ -33,6 +33,9 @@ public:
     Result saveToString(String &string, const SerializedData &tree) const override;
     SerializedData loadFromString(const String &string) const override;
 
+    UniquePointer<SerializedDataWriter> createWriter(OutputStream &output) const override;
+    Result read(InputStream &input, SerializedDataWriter &target) const override;
+
     bool supportsFileWithExtension(const String &extension) const override;
     bool supportsFileWithHeader(const String &header) const override;
 
@@ -18,6 +18,7 @@
 #pragma once
 
 #include "SerializedData.h"
+#include "SerializedDataWriter.h"
 
 class Serializable
 {
@@ -27,4 +28,12 @@ public:
     virtual SerializedData serialize() const = 0;
     virtual void deserialize(const SerializedData &data) = 0;
     virtual void reset() = 0;
+
+    // the streaming version of serialize(), which builds the subtree
+    // by default; large objects may override it to write their data
+    // directly, without building the tree in memory
+    virtual void serializeTo(SerializedDataWriter &writer) const
+    {
+        writer.writeNode(this->serialize());
+    }
 };
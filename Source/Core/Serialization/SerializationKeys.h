@@ -170,11 +170,20 @@ namespace Serialization
         static const Identifier pluginNumInputs = "numInputs";
         static const Identifier pluginNumOutputs = "numOutputs";
 
+        static const Identifier builtInSynth = "builtInSynth";
+        static const Identifier builtInSynthPolyphony = "polyphony";
+        static const Identifier builtInSynthVoiceStealing = "voiceStealing";
+
         static const Identifier midiInputName = "midiInputName";
         static const Identifier midiInputId = "midiInputId";
         static const Identifier midiInputReadjusting = "midiInputReadjusting";
 
         static const Identifier pluginsList = "plugins";
+        static const Identifier pluginScanCache = "pluginScanCache";
+        static const Identifier pluginScanCacheFile = "file";
+        static const Identifier pluginScanCachePath = "path";
+        static const Identifier pluginScanCacheModTime = "modTime";
+        static const Identifier pluginScanCacheSize = "size";
         static const Identifier audioCore = "audioCore";
         static const Identifier orchestra = "orchestra";
 
@@ -302,9 +311,6 @@ namespace Serialization
     {
         static const Identifier metaSymbol = "{x}";
 
-        static const Identifier wrapperClassName = "pluralForm";
-        static const Identifier wrapperMethodName = "detect";
-
         // old keys
         static const Identifier translationIdOld = "name";
         static const Identifier translationValueOld = "translation";
@@ -472,6 +478,7 @@ namespace Serialization
             static const Identifier notesAdded = "notesAdded";
             static const Identifier notesRemoved = "notesRemoved";
             static const Identifier notesChanged = "notesChanged";
+            static const Identifier packedNotes = "packed";
         }
 
         namespace ProjectTimelineDeltas
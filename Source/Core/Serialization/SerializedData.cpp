@@ -17,6 +17,185 @@
 
 #include "Common.h"
 #include "SerializedData.h"
+#include "SerializationKeys.h"
+
+// Most of the nodes in a project are notes and other events with a handful
+// of properties, so instead of NamedValueSet, which always allocates
+// its array, the first few properties are stored inline in the node:
+class SmallPropertySet final
+{
+public:
+
+    SmallPropertySet() = default;
+    SmallPropertySet(const SmallPropertySet &other) = default;
+    SmallPropertySet &operator= (const SmallPropertySet &other) = default;
+
+    int size() const noexcept
+    {
+        return this->numProperties;
+    }
+
+    const Identifier &getName(int index) const noexcept
+    {
+        jassert(isPositiveAndBelow(index, this->numProperties));
+        return this->getReference(index).name;
+    }
+
+    const var &getValueAt(int index) const noexcept
+    {
+        jassert(isPositiveAndBelow(index, this->numProperties));
+        return this->getReference(index).value;
+    }
+
+    const var *getVarPointer(const Identifier &name) const noexcept
+    {
+        for (int i = 0; i < this->numProperties; ++i)
+        {
+            const auto &property = this->getReference(i);
+            if (property.name == name)
+            {
+                return &property.value;
+            }
+        }
+
+        return nullptr;
+    }
+
+    void set(const Identifier &name, var value)
+    {
+        for (int i = 0; i < this->numProperties; ++i)
+        {
+            auto &property = this->getReference(i);
+            if (property.name == name)
+            {
+                property.value = move(value);
+                return;
+            }
+        }
+
+        if (this->numProperties < SmallPropertySet::numInlineProperties)
+        {
+            auto &property = this->inlineProperties[this->numProperties];
+            property.name = name;
+            property.value = move(value);
+        }
+        else
+        {
+            this->extraProperties.add({ name, move(value) });
+        }
+
+        this->numProperties++;
+    }
+
+    // just like NamedValueSet, the order doesn't matter,
+    // but the properties are compared in order while they match,
+    // and only the rest of them are looked up by name
+    bool operator== (const SmallPropertySet &other) const noexcept
+    {
+        if (this->numProperties != other.numProperties)
+        {
+            return false;
+        }
+
+        for (int i = 0; i < this->numProperties; ++i)
+        {
+            const auto &a = this->getReference(i);
+            const auto &b = other.getReference(i);
+
+            if (a.name != b.name)
+            {
+                for (int j = i; j < this->numProperties; ++j)
+                {
+                    const auto &property = this->getReference(j);
+                    const auto *otherValue = other.getVarPointer(property.name);
+                    if (otherValue == nullptr || *otherValue != property.value)
+                    {
+                        return false;
+                    }
+                }
+
+                return true;
+            }
+
+            if (a.value != b.value)
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    bool operator!= (const SmallPropertySet &other) const noexcept
+    {
+        return !(*this == other);
+    }
+
+    // the same format as in NamedValueSet::copyToXmlAttributes:
+    // binary values are base64-encoded, and their names get the "base64:" prefix
+    void copyToXmlAttributes(XmlElement &xml) const
+    {
+        for (int i = 0; i < this->numProperties; ++i)
+        {
+            const auto &property = this->getReference(i);
+            if (const auto *block = property.value.getBinaryData())
+            {
+                xml.setAttribute("base64:" + property.name.toString(), block->toBase64Encoding());
+            }
+            else
+            {
+                xml.setAttribute(property.name, property.value.toString());
+            }
+        }
+    }
+
+    void setFromXmlAttributes(const XmlElement &xml)
+    {
+        for (int i = 0; i < xml.getNumAttributes(); ++i)
+        {
+            const auto &name = xml.getAttributeName(i);
+            const auto &value = xml.getAttributeValue(i);
+
+            MemoryBlock block;
+            if (name.startsWith("base64:") && block.fromBase64Encoding(value))
+            {
+                this->set(name.substring(7), var(block));
+                continue;
+            }
+
+            this->set(name, value);
+        }
+    }
+
+private:
+
+    struct Property final
+    {
+        Identifier name;
+        var value;
+    };
+
+    const Property &getReference(int index) const noexcept
+    {
+        return index < SmallPropertySet::numInlineProperties ?
+            this->inlineProperties[index] :
+            this->extraProperties.getReference(index - SmallPropertySet::numInlineProperties);
+    }
+
+    Property &getReference(int index) noexcept
+    {
+        return index < SmallPropertySet::numInlineProperties ?
+            this->inlineProperties[index] :
+            this->extraProperties.getReference(index - SmallPropertySet::numInlineProperties);
+    }
+
+    // enough for a note: id, key, beat, length, velocity and tuplet
+    static constexpr auto numInlineProperties = 6;
+
+    Property inlineProperties[numInlineProperties];
+    Array<Property> extraProperties;
+    int numProperties = 0;
+};
 
 class SerializedData::SharedData final : public ReferenceCountedObject
 {
@@ -168,7 +347,7 @@ public:
     }
 
     const Identifier type;
-    NamedValueSet properties;
+    SmallPropertySet properties;
     ReferenceCountedArray<SharedData> children;
     SharedData *parent = nullptr;
 
@@ -260,13 +439,24 @@ SerializedData SerializedData::getParent() const noexcept
 const var &SerializedData::getProperty(const Identifier &name) const noexcept
 {
     jassert(this->data != nullptr);
-    return this->data->properties[name];
+    if (const auto *value = this->data->properties.getVarPointer(name))
+    {
+        return *value;
+    }
+
+    static const var nullValue;
+    return nullValue;
 }
 
 var SerializedData::getProperty(const Identifier &name, const var &defaultValue) const
 {
     jassert(this->data != nullptr);
-    return this->data->properties.getWithDefault(name, defaultValue);
+    if (const auto *value = this->data->properties.getVarPointer(name))
+    {
+        return *value;
+    }
+
+    return defaultValue;
 }
 
 SerializedData &SerializedData::setProperty(const Identifier &name, const var &newValue)
@@ -279,7 +469,7 @@ SerializedData &SerializedData::setProperty(const Identifier &name, const var &n
 
 bool SerializedData::hasProperty(const Identifier &name) const noexcept
 {
-    return this->data != nullptr && this->data->properties.contains(name);
+    return this->data != nullptr && this->data->properties.getVarPointer(name) != nullptr;
 }
 
 int SerializedData::getNumProperties() const noexcept
@@ -396,7 +586,7 @@ inline static Identifier readIdentifier(InputStream &input)
     // (using JUCE's readString() on deserialization sucks really hard);
     // also preallocated size of 32 should be enough for all identifiers I ever use,
     // and for all string values var::readFromStream() will be called, but far less frequently 
-    static MemoryOutputStream buffer(32);
+    static thread_local MemoryOutputStream buffer(32);
     buffer.reset();
 
     for (;;)
@@ -462,3 +652,436 @@ SerializedData SerializedData::readFromData(const void *data, size_t numBytes)
     MemoryInputStream in(data, numBytes, false);
     return readFromStream(in);
 }
+
+//===----------------------------------------------------------------------===//
+// Compact binary format
+//===----------------------------------------------------------------------===//
+
+// The legacy format above writes each node type and property name in full,
+// which makes most of the file size for note-dense projects, and reading
+// them means hitting the global string pool for every single property;
+// instead, here each name is written once per stream, when first met,
+// and then referenced by its index in the stream's key table.
+// Ints and strings, which are most of the values, are written without
+// the var's size prefix, ints also as variable length ints.
+
+struct CompactStreamFormat final
+{
+    // the key indices are shifted by 2 to reserve these markers:
+    static constexpr int noNode = 0;
+    static constexpr int newKey = 1;
+    static constexpr int firstKeyIndex = 2;
+
+    enum ValueType : uint8
+    {
+        otherValue = 0, // written with var::writeToStream
+        intValue = 1,
+        stringValue = 2
+    };
+};
+
+struct IdentifierPointerHash final
+{
+    // identifiers are pooled strings, so the pointer is enough
+    inline HashCode operator()(const Identifier &key) const noexcept
+    {
+        return std::hash<const void *>()(key.getCharPointer().getAddress());
+    }
+};
+
+class CompactStreamWriter final
+{
+public:
+
+    explicit CompactStreamWriter(OutputStream &output) : output(output) {}
+
+    void writeKey(const Identifier &key)
+    {
+        const auto found = this->keyIndices.find(key);
+        if (found != this->keyIndices.end())
+        {
+            this->output.writeCompressedInt(found->second + CompactStreamFormat::firstKeyIndex);
+            return;
+        }
+
+        const auto newIndex = int(this->keyIndices.size());
+        this->keyIndices[key] = newIndex;
+        this->output.writeCompressedInt(CompactStreamFormat::newKey);
+        this->output.writeString(key.toString());
+    }
+
+    void writeValue(const var &value)
+    {
+        if (value.isInt())
+        {
+            this->output.writeByte(CompactStreamFormat::intValue);
+            this->output.writeCompressedInt(int(value));
+        }
+        else if (value.isString())
+        {
+            this->output.writeByte(CompactStreamFormat::stringValue);
+            this->output.writeString(value.toString());
+        }
+        else
+        {
+            this->output.writeByte(CompactStreamFormat::otherValue);
+            value.writeToStream(this->output);
+        }
+    }
+
+    void writeNoNode()
+    {
+        this->output.writeCompressedInt(CompactStreamFormat::noNode);
+    }
+
+    void writeCount(int count)
+    {
+        this->output.writeCompressedInt(count);
+    }
+
+private:
+
+    OutputStream &output;
+    FlatHashMap<Identifier, int, IdentifierPointerHash> keyIndices;
+
+    JUCE_DECLARE_NON_COPYABLE(CompactStreamWriter)
+};
+
+class CompactStreamReader final
+{
+public:
+
+    explicit CompactStreamReader(InputStream &input) :
+        input(input), buffer(32) {}
+
+    // returns false for the no-node marker or for broken data
+    bool readKey(Identifier &result)
+    {
+        const auto index = this->input.readCompressedInt();
+        if (index == CompactStreamFormat::newKey)
+        {
+            const auto name = this->readNullTerminatedString();
+            if (name.isEmpty())
+            {
+                jassertfalse;
+                return false;
+            }
+
+            result = Identifier(name);
+            this->keys.add(result);
+            return true;
+        }
+
+        const auto keyIndex = index - CompactStreamFormat::firstKeyIndex;
+        if (isPositiveAndBelow(keyIndex, this->keys.size()))
+        {
+            result = this->keys.getUnchecked(keyIndex);
+            return true;
+        }
+
+        jassert(index == CompactStreamFormat::noNode);
+        return false;
+    }
+
+    var readValue()
+    {
+        switch (this->input.readByte())
+        {
+            case CompactStreamFormat::intValue:
+                return this->input.readCompressedInt();
+            case CompactStreamFormat::stringValue:
+                return this->readNullTerminatedString();
+            default:
+                return var::readFromStream(this->input);
+        }
+    }
+
+    int readCount()
+    {
+        return jmax(0, this->input.readCompressedInt());
+    }
+
+    bool isExhausted()
+    {
+        return this->input.isExhausted();
+    }
+
+private:
+
+    String readNullTerminatedString()
+    {
+        this->buffer.reset();
+
+        for (;;)
+        {
+            const auto c = this->input.readByte();
+            if (c == 0)
+            {
+                return String::fromUTF8(static_cast<const char *>(this->buffer.getData()),
+                    int(this->buffer.getDataSize()));
+            }
+
+            this->buffer.writeByte(c);
+        }
+    }
+
+    InputStream &input;
+    MemoryOutputStream buffer;
+    Array<Identifier> keys;
+
+    JUCE_DECLARE_NON_COPYABLE(CompactStreamReader)
+};
+
+void SerializedData::writeToCompactStream(OutputStream &output) const
+{
+    CompactStreamWriter writer(output);
+
+    if (this->data == nullptr)
+    {
+        writer.writeNoNode();
+        return;
+    }
+
+    const std::function<void(const SharedData &)> writeNode = [&](const SharedData &node)
+    {
+        writer.writeKey(node.type);
+        writer.writeCount(node.properties.size());
+
+        for (int i = 0; i < node.properties.size(); ++i)
+        {
+            writer.writeKey(node.properties.getName(i));
+            writer.writeValue(node.properties.getValueAt(i));
+        }
+
+        writer.writeCount(node.children.size());
+
+        for (const auto *child : node.children)
+        {
+            writeNode(*child);
+        }
+    };
+
+    writeNode(*this->data);
+}
+
+SerializedData SerializedData::readFromCompactStream(InputStream &input)
+{
+    CompactStreamReader reader(input);
+
+    const std::function<SerializedData()> readNode = [&]() -> SerializedData
+    {
+        Identifier type;
+        if (!reader.readKey(type))
+        {
+            return {};
+        }
+
+        SerializedData v(type);
+
+        const auto numProps = reader.readCount();
+        for (int i = 0; i < numProps; ++i)
+        {
+            Identifier propertyName;
+            if (!reader.readKey(propertyName))
+            {
+                jassertfalse;
+                return v;
+            }
+
+            v.data->properties.set(propertyName, reader.readValue());
+        }
+
+        const auto numChildren = reader.readCount();
+        v.data->children.ensureStorageAllocated(numChildren);
+
+        for (int i = 0; i < numChildren && !reader.isExhausted(); ++i)
+        {
+            const auto child = readNode();
+            if (!child.isValid())
+            {
+                return v;
+            }
+
+            v.data->children.add(child.data);
+            child.data->parent = v.data.get();
+        }
+
+        return v;
+    };
+
+    return readNode();
+}
+
+//===----------------------------------------------------------------------===//
+// Tests
+//===----------------------------------------------------------------------===//
+
+#if JUCE_UNIT_TESTS
+
+class SerializedDataTests final : public UnitTest
+{
+public:
+    SerializedDataTests() : UnitTest("Serialized data tests", UnitTestCategories::helio) {}
+
+    // a tree that looks like a project with lots of notes
+    static SerializedData createProjectLikeTree(int numTracks, int numNotesPerTrack)
+    {
+        using namespace Serialization;
+
+        Random random(numTracks * numNotesPerTrack);
+        SerializedData root(Core::project);
+        root.setProperty(Core::projectId, Uuid().toString());
+
+        for (int i = 0; i < numTracks; ++i)
+        {
+            SerializedData trackNode(Core::treeNode);
+            trackNode.setProperty(Core::treeNodeType, Core::pianoTrack.toString());
+            trackNode.setProperty(Core::treeNodeName, "Track " + String(i));
+            trackNode.setProperty(Core::trackColour, "ffc0c0c0");
+
+            SerializedData sequence(Midi::track);
+            for (int j = 0; j < numNotesPerTrack; ++j)
+            {
+                SerializedData note(Midi::note);
+                note.setProperty(Midi::id, String::toHexString(random.nextInt(1 << 24)));
+                note.setProperty(Midi::key, random.nextInt(128));
+                note.setProperty(Midi::timestamp, j * 4);
+                note.setProperty(Midi::length, 1 + random.nextInt(64));
+                note.setProperty(Midi::volume, random.nextInt(1024));
+                if (j % 10 == 0)
+                {
+                    note.setProperty(Midi::tuplet, 3);
+                }
+
+                sequence.appendChild(note);
+            }
+
+            trackNode.appendChild(sequence);
+            root.appendChild(trackNode);
+        }
+
+        return root;
+    }
+
+    void runTest() override
+    {
+        beginTest("Properties beyond the inline storage");
+
+        {
+            SerializedData node(Serialization::Core::treeNode);
+            for (int i = 0; i < 20; ++i)
+            {
+                node.setProperty(Identifier("p" + String(i)), i);
+            }
+
+            node.setProperty(Identifier("p3"), "three");
+            node.setProperty(Identifier("p15"), "fifteen");
+
+            expectEquals(node.getNumProperties(), 20);
+            expectEquals(node.getProperty(Identifier("p3")).toString(), String("three"));
+            expectEquals(node.getProperty(Identifier("p15")).toString(), String("fifteen"));
+            expectEquals(int(node.getProperty(Identifier("p19"))), 19);
+            expectEquals(node.getPropertyName(10).toString(), String("p10"));
+            expect(node.getProperty(Identifier("missing")).isVoid());
+            expectEquals(int(node.getProperty(Identifier("missing"), 42)), 42);
+            expect(node.createCopy().isEquivalentTo(node));
+
+            MemoryOutputStream out;
+            node.writeToCompactStream(out);
+            MemoryInputStream in(out.getData(), out.getDataSize(), false);
+            expect(SerializedData::readFromCompactStream(in).isEquivalentTo(node));
+
+            MemoryOutputStream emptyOut;
+            SerializedData().writeToCompactStream(emptyOut);
+            MemoryInputStream emptyIn(emptyOut.getData(), emptyOut.getDataSize(), false);
+            expect(!SerializedData::readFromCompactStream(emptyIn).isValid());
+        }
+
+        beginTest("Comparing properties in different order");
+
+        {
+            SerializedData a(Serialization::Core::treeNode);
+            SerializedData b(Serialization::Core::treeNode);
+            for (int i = 0; i < 10; ++i)
+            {
+                a.setProperty(Identifier("p" + String(i)), i);
+                b.setProperty(Identifier("p" + String(9 - i)), 9 - i);
+            }
+
+            expect(a.isEquivalentTo(b));
+            expect(b.isEquivalentTo(a));
+
+            b.setProperty(Identifier("p2"), "two");
+            expect(!a.isEquivalentTo(b));
+            expect(!b.isEquivalentTo(a));
+        }
+
+        beginTest("Compact stream round trip");
+
+        {
+            SerializedData node(Serialization::Core::treeNode);
+            node.setProperty(Identifier("negative"), -123456);
+            node.setProperty(Identifier("int64"), int64(1) << 40);
+            node.setProperty(Identifier("double"), 0.5);
+            node.setProperty(Identifier("bool"), true);
+            node.setProperty(Identifier("unicode"), CharPointer_UTF8("\xd0\xbd\xd0\xbe\xd1\x82\xd0\xb0"));
+            node.setProperty(Identifier("empty"), String());
+            node.setProperty(Identifier("binary"), var(MemoryBlock("\0\1\2\3", 4)));
+            node.appendChild(SerializedData(Serialization::Core::treeNode));
+
+            MemoryOutputStream out;
+            node.writeToCompactStream(out);
+            MemoryInputStream in(out.getData(), out.getDataSize(), false);
+            const auto result = SerializedData::readFromCompactStream(in);
+            expect(result.isEquivalentTo(node));
+            expectEquals(result.getNumChildren(), 1);
+
+            // binary values survive xml as well, like with NamedValueSet
+            UniquePointer<XmlElement> xml(node.writeToXml());
+            expect(xml->hasAttribute("base64:binary"));
+            const auto fromXml = SerializedData::readFromXml(*xml);
+            expect(fromXml.getProperty(Identifier("binary")).isBinaryData());
+            expect(*fromXml.getProperty(Identifier("binary")).getBinaryData() == MemoryBlock("\0\1\2\3", 4));
+        }
+
+        beginTest("Saving and loading 1M notes");
+
+        {
+            static constexpr auto numTracks = 100;
+            static constexpr auto numNotesPerTrack = 10000;
+            const auto tree = createProjectLikeTree(numTracks, numNotesPerTrack);
+
+            auto startMs = Time::getMillisecondCounterHiRes();
+            MemoryOutputStream legacyOut;
+            tree.writeToStream(legacyOut);
+            const auto legacySaveMs = Time::getMillisecondCounterHiRes() - startMs;
+
+            startMs = Time::getMillisecondCounterHiRes();
+            MemoryOutputStream compactOut;
+            tree.writeToCompactStream(compactOut);
+            const auto compactSaveMs = Time::getMillisecondCounterHiRes() - startMs;
+
+            startMs = Time::getMillisecondCounterHiRes();
+            const auto legacyLoaded = SerializedData::readFromData(legacyOut.getData(), legacyOut.getDataSize());
+            const auto legacyLoadMs = Time::getMillisecondCounterHiRes() - startMs;
+
+            startMs = Time::getMillisecondCounterHiRes();
+            MemoryInputStream compactIn(compactOut.getData(), compactOut.getDataSize(), false);
+            const auto compactLoaded = SerializedData::readFromCompactStream(compactIn);
+            const auto compactLoadMs = Time::getMillisecondCounterHiRes() - startMs;
+
+            expect(legacyLoaded.isEquivalentTo(tree));
+            expect(compactLoaded.isEquivalentTo(tree));
+            expect(compactOut.getDataSize() * 2 < legacyOut.getDataSize());
+
+            logMessage("1M notes, legacy format: " + String(legacyOut.getDataSize()) + " bytes, saved in " +
+                String(legacySaveMs, 0) + " ms, loaded in " + String(legacyLoadMs, 0) + " ms");
+            logMessage("1M notes, compact format: " + String(compactOut.getDataSize()) + " bytes, saved in " +
+                String(compactSaveMs, 0) + " ms, loaded in " + String(compactLoadMs, 0) + " ms");
+        }
+    }
+};
+
+static SerializedDataTests serializedDataTests;
+
+#endif
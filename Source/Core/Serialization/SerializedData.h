@@ -65,6 +65,11 @@ public:
     static SerializedData readFromStream(InputStream &input);
     static SerializedData readFromData(const void *data, size_t numBytes);
 
+    // a more compact binary format, with a table of property names
+    // written once per stream, instead of each name in each node
+    void writeToCompactStream(OutputStream &output) const;
+    static SerializedData readFromCompactStream(InputStream &input);
+
     struct Iterator final
     {
         Iterator(const SerializedData &, bool isEnd);
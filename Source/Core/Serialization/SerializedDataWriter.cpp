@@ -0,0 +1,300 @@
+/*
+    This file is part of Helio Workstation.
+
+    Helio is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Helio is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Helio. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "Common.h"
+#include "SerializedDataWriter.h"
+#include "SerializationKeys.h"
+#include "BinarySerializer.h"
+#include "XmlSerializer.h"
+#include "JsonSerializer.h"
+#include "PianoSequence.h"
+#include "MidiTrack.h"
+#include "ProjectEventDispatcher.h"
+
+void SerializedDataWriter::writeNode(const SerializedData &tree)
+{
+    if (!tree.isValid())
+    {
+        return;
+    }
+
+    this->beginNode(tree.getType());
+
+    for (int i = 0; i < tree.getNumProperties(); ++i)
+    {
+        const auto name = tree.getPropertyName(i);
+        this->writeProperty(name, tree.getProperty(name));
+    }
+
+    for (const auto &child : tree)
+    {
+        this->writeNode(child);
+    }
+
+    this->endNode();
+}
+
+void SerializedDataBuilder::beginNode(const Identifier &type)
+{
+    SerializedData node(type);
+
+    if (this->openNodes.isEmpty())
+    {
+        // only one root node is expected
+        jassert(!this->result.isValid());
+        this->result = node;
+    }
+    else
+    {
+        this->openNodes.getReference(this->openNodes.size() - 1).appendChild(node);
+    }
+
+    this->openNodes.add(node);
+}
+
+void SerializedDataBuilder::writeProperty(const Identifier &name, const var &value)
+{
+    jassert(!this->openNodes.isEmpty());
+    if (!this->openNodes.isEmpty())
+    {
+        this->openNodes.getReference(this->openNodes.size() - 1).setProperty(name, value);
+    }
+}
+
+void SerializedDataBuilder::endNode()
+{
+    jassert(!this->openNodes.isEmpty());
+    this->openNodes.removeLast();
+}
+
+const SerializedData &SerializedDataBuilder::getResult() const noexcept
+{
+    return this->result;
+}
+
+//===----------------------------------------------------------------------===//
+// Tests
+//===----------------------------------------------------------------------===//
+
+#if JUCE_UNIT_TESTS
+
+class SerializedDataStreamingTests final : public UnitTest
+{
+public:
+    SerializedDataStreamingTests() : UnitTest("Serialized data streaming tests", UnitTestCategories::helio) {}
+
+    static SerializedData createTestTree()
+    {
+        using namespace Serialization;
+
+        SerializedData root(Core::project);
+        root.setProperty(Core::treeNodeName, "Tricky <name> & \"quotes\" 'n' ümläuts");
+        root.setProperty(Core::projectId, 42);
+        root.setProperty(Core::trackColour, 0.5);
+
+        // children of different types, interleaved
+        for (int i = 0; i < 3; ++i)
+        {
+            SerializedData trackNode(Core::treeNode);
+            trackNode.setProperty(Core::treeNodeName, "Track\t" + String(i));
+
+            SerializedData sequence(Midi::track);
+            for (int j = 0; j < 5; ++j)
+            {
+                SerializedData note(Midi::note);
+                note.setProperty(Midi::key, j);
+                note.setProperty(Midi::timestamp, j * 128);
+                sequence.appendChild(note);
+            }
+
+            trackNode.appendChild(sequence);
+            trackNode.appendChild(SerializedData(Midi::pattern));
+            root.appendChild(trackNode);
+            root.appendChild(SerializedData(Midi::clip));
+        }
+
+        return root;
+    }
+
+    static MemoryBlock writeWith(const Serializer &serializer, const SerializedData &tree)
+    {
+        MemoryOutputStream out;
+
+        {
+            auto writer = serializer.createWriter(out);
+            writer->writeNode(tree);
+        }
+
+        return out.getMemoryBlock();
+    }
+
+    // json objects can't keep the order of children of different types,
+    // only the order of children within each type
+    static bool isEquivalentInEachType(const SerializedData &a, const SerializedData &b)
+    {
+        if (a.getType() != b.getType() ||
+            a.getNumProperties() != b.getNumProperties() ||
+            a.getNumChildren() != b.getNumChildren())
+        {
+            return false;
+        }
+
+        for (int i = 0; i < a.getNumProperties(); ++i)
+        {
+            const auto name = a.getPropertyName(i);
+            if (!b.hasProperty(name) || a.getProperty(name) != b.getProperty(name))
+            {
+                return false;
+            }
+        }
+
+        for (const auto &child : a)
+        {
+            Array<SerializedData> childrenA, childrenB;
+            for (const auto &c : a) { if (c.hasType(child.getType())) { childrenA.add(c); } }
+            for (const auto &c : b) { if (c.hasType(child.getType())) { childrenB.add(c); } }
+
+            if (childrenA.size() != childrenB.size())
+            {
+                return false;
+            }
+
+            for (int i = 0; i < childrenA.size(); ++i)
+            {
+                if (!isEquivalentInEachType(childrenA.getReference(i), childrenB.getReference(i)))
+                {
+                    return false;
+                }
+            }
+        }
+
+        return true;
+    }
+
+    SerializedData readWith(const Serializer &serializer, const MemoryBlock &data)
+    {
+        MemoryInputStream in(data, false);
+        SerializedDataBuilder builder;
+        const auto result = serializer.read(in, builder);
+        expect(result.wasOk(), result.getErrorMessage());
+        return builder.getResult();
+    }
+
+    void runTest() override
+    {
+        const auto tree = createTestTree();
+
+        beginTest("Stream writers and readers round trip");
+
+        {
+            const BinarySerializer binary;
+            const XmlSerializer xml;
+            const JsonSerializer json;
+
+            expect(this->readWith(binary, writeWith(binary, tree)).isEquivalentTo(tree));
+            expect(this->readWith(xml, writeWith(xml, tree)).isEquivalentTo(tree));
+            expect(isEquivalentInEachType(this->readWith(json, writeWith(json, tree)), tree));
+
+            String text;
+            expect(xml.saveToString(text, tree).wasOk());
+            expect(xml.loadFromString(text).isEquivalentTo(tree));
+            expect(json.saveToString(text, tree).wasOk());
+            expect(isEquivalentInEachType(json.loadFromString(text), tree));
+        }
+
+        beginTest("Xml stream format compatibility");
+
+        {
+            // what's written by XmlElement is readable by the stream parser
+            UniquePointer<XmlElement> xml(tree.writeToXml());
+            const auto text = xml->toString();
+            expect(XmlSerializer().loadFromString(text).isEquivalentTo(tree));
+
+            // and vice versa
+            const auto data = writeWith(XmlSerializer(), tree);
+            const auto document = parseXML(data.toString());
+            expect(document != nullptr);
+            expect(SerializedData::readFromXml(*document).isEquivalentTo(tree));
+        }
+
+        beginTest("Json stream format compatibility");
+
+        {
+            // arrays of nodes and single nodes are both readable
+            const auto text = String(R"({
+  "project": {
+    "name": "test",
+    "node": { "name": "a" },
+    "track": [ { "note": { "key": 1 } } ],
+    "clip": [ {}, {} ]
+  }
+})");
+            const auto loaded = JsonSerializer().loadFromString(text);
+            expect(loaded.hasType(Serialization::Core::project));
+            expectEquals(loaded.getNumChildren(), 4);
+            expectEquals(loaded.getChild(1).getChild(0).getProperty(Serialization::Midi::key).toString(), String("1"));
+
+            // interleaved children types don't produce duplicate keys,
+            // which other parsers would silently drop
+            const auto written = writeWith(JsonSerializer(), tree).toString();
+            const auto parsed = JSON::parse(written);
+            const auto *project = parsed[Serialization::Core::project].getDynamicObject();
+            expect(project != nullptr);
+            if (project != nullptr)
+            {
+                expectEquals(project->getProperty(Serialization::Core::treeNode).size(), 3);
+                expectEquals(project->getProperty(Serialization::Midi::clip).size(), 3);
+            }
+
+            // the utf-8 byte order mark is skipped
+            const auto textWithBom = String(CharPointer_UTF8("\xef\xbb\xbf")) + text;
+            const auto file = File::createTempFile("json");
+            expect(file.replaceWithText(textWithBom, false, false));
+            expect(JsonSerializer().loadFromFile(file).isEquivalentTo(loaded));
+            file.deleteFile();
+
+            // top-level primitives can only go to the fake root
+            MemoryInputStream in(R"({ "key": 1 })", 12, false);
+            SerializedDataBuilder builder;
+            expect(JsonSerializer().read(in, builder).failed());
+        }
+
+        beginTest("Sequence streaming is equivalent to serializing");
+
+        {
+            EmptyMidiTrack track;
+            EmptyEventDispatcher dispatcher;
+            PianoSequence sequence(track, dispatcher);
+
+            Random random(1);
+            for (int i = 0; i < 100; ++i)
+            {
+                Note note(&sequence, 40 + random.nextInt(40), float(i), 1.f + random.nextFloat());
+                sequence.insert(i % 2 == 0 ? note : note.withTuplet(3), false);
+            }
+
+            SerializedDataBuilder builder;
+            sequence.serializeTo(builder);
+            expect(builder.getResult().isEquivalentTo(sequence.serialize()));
+        }
+    }
+};
+
+static SerializedDataStreamingTests serializedDataStreamingTests;
+
+#endif
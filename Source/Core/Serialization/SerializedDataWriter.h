@@ -0,0 +1,124 @@
+/*
+    This file is part of Helio Workstation.
+
+    Helio is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Helio is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Helio. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+
+// The streaming interface for serializers, which doesn't need the whole
+// tree in memory: nodes and their properties are passed one by one,
+// properties are expected to go before the node's children.
+
+// Serializers implement it to format the data as it comes,
+// and their readers push the parsed data into any writer,
+// e.g. SerializedDataBuilder, or another serializer's writer.
+
+class SerializedDataWriter
+{
+public:
+
+    virtual ~SerializedDataWriter() = default;
+
+    virtual void beginNode(const Identifier &type) = 0;
+    virtual void writeProperty(const Identifier &name, const var &value) = 0;
+    virtual void endNode() = 0;
+
+    // writes the whole subtree
+    void writeNode(const SerializedData &tree);
+
+};
+
+// Builds a tree from the written nodes,
+// accepts the properties in any order
+
+class SerializedDataBuilder final : public SerializedDataWriter
+{
+public:
+
+    SerializedDataBuilder() = default;
+
+    void beginNode(const Identifier &type) override;
+    void writeProperty(const Identifier &name, const var &value) override;
+    void endNode() override;
+
+    const SerializedData &getResult() const noexcept;
+
+private:
+
+    SerializedData result;
+    Array<SerializedData> openNodes;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SerializedDataBuilder)
+};
+
+// A minimal buffered reader for the streaming parsers, which read
+// the input byte by byte: a bit faster than BufferedInputStream,
+// and returns zero at the end of the stream, like String's char pointers
+
+class SerializedDataStreamReader final
+{
+public:
+
+    explicit SerializedDataStreamReader(InputStream &input) : input(input)
+    {
+        this->buffer.malloc(SerializedDataStreamReader::bufferSize);
+    }
+
+    inline char peek()
+    {
+        if (this->position >= this->numBytes && !this->refill())
+        {
+            return 0;
+        }
+
+        return this->buffer[this->position];
+    }
+
+    inline char next()
+    {
+        if (this->position >= this->numBytes && !this->refill())
+        {
+            return 0;
+        }
+
+        return this->buffer[this->position++];
+    }
+
+    int64 getPosition() const noexcept
+    {
+        return this->numBytesBefore + this->position;
+    }
+
+private:
+
+    bool refill()
+    {
+        this->numBytesBefore += this->numBytes;
+        this->numBytes = jmax(0, this->input.read(this->buffer, SerializedDataStreamReader::bufferSize));
+        this->position = 0;
+        return this->numBytes > 0;
+    }
+
+    InputStream &input;
+    HeapBlock<char> buffer;
+    int position = 0;
+    int numBytes = 0;
+    int64 numBytesBefore = 0;
+
+    static constexpr auto bufferSize = 64 * 1024;
+
+    JUCE_DECLARE_NON_COPYABLE(SerializedDataStreamReader)
+};
@@ -19,6 +19,7 @@
 
 class Serializable;
 class SerializedData;
+class SerializedDataWriter;
 
 class Serializer
 {
@@ -32,6 +33,12 @@ public:
     virtual Result saveToString(String &string, const SerializedData &tree) const = 0;
     virtual SerializedData loadFromString(const String &string) const = 0;
 
+    // Streaming, without the whole tree in memory: the created writer formats
+    // the nodes into the output as they come, and the reader parses the input
+    // and passes the nodes into the target writer as it goes
+    virtual UniquePointer<SerializedDataWriter> createWriter(OutputStream &output) const = 0;
+    virtual Result read(InputStream &input, SerializedDataWriter &target) const = 0;
+
     virtual bool supportsFileWithExtension(const String &extension) const = 0;
     virtual bool supportsFileWithHeader(const String &header) const = 0;
 
@@ -18,36 +18,541 @@
 #include "Common.h"
 #include "XmlSerializer.h"
 
-static const String xmlEncoding = "UTF-8";
+//===----------------------------------------------------------------------===//
+// Xml stream writer
+//===----------------------------------------------------------------------===//
 
-static XmlElement::TextFormat getXmlFormat()
+// Writes the same markup as XmlElement does, except for the long lines wrapping;
+// the start tag is only closed when the first child or the end of node
+// comes, so that the nodes without children are written as <node ... />
+
+class XmlStreamWriter final : public SerializedDataWriter
 {
-    static XmlElement::TextFormat format;
-    format.dtd = {};
-    format.lineWrapLength = 120;
-    format.customEncoding = xmlEncoding;
-    return format;
-}
+public:
+
+    explicit XmlStreamWriter(OutputStream &out) : out(out) {}
+
+    ~XmlStreamWriter() override
+    {
+        // all nodes are expected to be closed
+        jassert(this->openNodes.isEmpty());
+    }
+
+    void beginNode(const Identifier &type) override
+    {
+        if (this->openNodes.isEmpty())
+        {
+            // only one root node is expected
+            jassert(!this->hasWrittenRoot);
+            this->hasWrittenRoot = true;
+
+            this->out << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>" << newLine << newLine;
+        }
+        else
+        {
+            this->closeStartTagIfNeeded();
+        }
+
+        XmlStreamWriter::writeSpaces(this->out, this->openNodes.size() * XmlStreamWriter::indentSize);
+        this->out << '<' << type.toString();
+
+        this->openNodes.add(type);
+        this->isStartTagOpen = true;
+    }
+
+    void writeProperty(const Identifier &name, const var &value) override
+    {
+        if (!this->isStartTagOpen)
+        {
+            jassertfalse; // attributes can't go after the child nodes
+            return;
+        }
+
+        // binary values are written the same way as NamedValueSet does
+        const auto *binaryData = value.getBinaryData();
+        this->out << ' ' << (binaryData != nullptr ? "base64:" : "") << name.toString() << "=\"";
+
+        if (binaryData != nullptr)
+        {
+            this->out << binaryData->toBase64Encoding();
+        }
+        else
+        {
+            XmlStreamWriter::writeEscaped(this->out, value.toString());
+        }
+
+        this->out << '"';
+    }
+
+    void endNode() override
+    {
+        jassert(!this->openNodes.isEmpty());
+        if (this->openNodes.isEmpty())
+        {
+            return;
+        }
+
+        const auto type = this->openNodes.getLast();
+        this->openNodes.removeLast();
+
+        if (this->isStartTagOpen)
+        {
+            this->out << "/>" << newLine;
+            this->isStartTagOpen = false;
+        }
+        else
+        {
+            XmlStreamWriter::writeSpaces(this->out, this->openNodes.size() * XmlStreamWriter::indentSize);
+            this->out << "</" << type.toString() << '>' << newLine;
+        }
+    }
+
+private:
+
+    void closeStartTagIfNeeded()
+    {
+        if (this->isStartTagOpen)
+        {
+            this->out << '>' << newLine;
+            this->isStartTagOpen = false;
+        }
+    }
+
+    static void writeSpaces(OutputStream &out, int numSpaces)
+    {
+        out.writeRepeatedByte(' ', size_t(numSpaces));
+    }
+
+    static void writeEscaped(OutputStream &out, const String &text)
+    {
+        for (auto t = text.getCharPointer(); !t.isEmpty();)
+        {
+            const auto c = t.getAndAdvance();
+
+            switch (c)
+            {
+            case '&':   out << "&amp;"; break;
+            case '"':   out << "&quot;"; break;
+            case '\'':  out << "&apos;"; break;
+            case '<':   out << "&lt;"; break;
+            case '>':   out << "&gt;"; break;
+
+            default:
+                if (c >= 32 && c < 127)
+                {
+                    out << char(c);
+                }
+                else
+                {
+                    out << "&#" << int(c) << ';';
+                }
+                break;
+            }
+        }
+    }
+
+    OutputStream &out;
+
+    Array<Identifier> openNodes;
+    bool isStartTagOpen = false;
+    bool hasWrittenRoot = false;
+
+    static constexpr auto indentSize = 2;
+
+    JUCE_DECLARE_NON_COPYABLE(XmlStreamWriter)
+};
+
+//===----------------------------------------------------------------------===//
+// Xml stream parser
+//===----------------------------------------------------------------------===//
+
+// A minimal SAX-style parser, which only cares about the elements
+// and their attributes, and passes them to the target as it goes;
+// the text content, comments, DTDs and processing instructions are skipped,
+// everything after the root element is ignored
+
+class XmlStreamParser final
+{
+public:
+
+    XmlStreamParser(InputStream &input, SerializedDataWriter &target) :
+        input(input), target(target), buffer(256) {}
+
+    Result parseDocument()
+    {
+        this->skipByteOrderMark();
+
+        for (;;)
+        {
+            // the text content is not supported
+            char c = this->input.next();
+            while (c != '<' && c != 0)
+            {
+                c = this->input.next();
+            }
+
+            if (c == 0)
+            {
+                if (this->depth == 0 && this->hasParsedRoot)
+                {
+                    return Result::ok();
+                }
+
+                return this->createFail("Unexpected end of input");
+            }
+
+            const auto result = this->parseTag();
+            if (result.failed())
+            {
+                return result;
+            }
+
+            if (this->depth == 0 && this->hasParsedRoot)
+            {
+                return Result::ok();
+            }
+        }
+    }
+
+private:
+
+    // expects the opening bracket to be consumed
+    Result parseTag()
+    {
+        switch (this->input.peek())
+        {
+        case '?':
+            this->skipUntil("?>");
+            return Result::ok();
+
+        case '!':
+            this->input.next();
+            if (this->input.peek() == '-')
+            {
+                this->skipUntil("-->");
+            }
+            else if (this->input.peek() == '[')
+            {
+                this->skipUntil("]]>"); // CDATA
+            }
+            else
+            {
+                this->skipDoctype();
+            }
+            return Result::ok();
+
+        case '/':
+            this->input.next();
+            this->readName();
+            this->skipUntil(">");
+            if (this->depth == 0)
+            {
+                return this->createFail("Unexpected closing tag");
+            }
+
+            this->depth--;
+            this->target.endNode();
+            return Result::ok();
+
+        default:
+            break;
+        }
+
+        if (this->depth == 0 && this->hasParsedRoot)
+        {
+            return this->createFail("Multiple root elements");
+        }
+
+        const auto type = this->readName();
+        if (type.isEmpty())
+        {
+            return this->createFail("Expected an element name");
+        }
+
+        this->target.beginNode(Identifier(type));
+        this->depth++;
+        this->hasParsedRoot = true;
+
+        for (;;)
+        {
+            this->skipWhitespaces();
+
+            const auto c = this->input.next();
+            if (c == '>')
+            {
+                return Result::ok();
+            }
+
+            if (c == '/')
+            {
+                if (this->input.next() != '>')
+                {
+                    return this->createFail("Expected '>'");
+                }
+
+                this->depth--;
+                this->target.endNode();
+                return Result::ok();
+            }
+
+            if (c == 0)
+            {
+                return this->createFail("Unexpected end of input");
+            }
+
+            this->buffer.reset();
+            this->buffer.writeByte(c);
+            const auto attributeName = this->readName();
+
+            this->skipWhitespaces();
+            if (this->input.next() != '=')
+            {
+                return this->createFail("Expected '='");
+            }
+
+            this->skipWhitespaces();
+            const auto quote = this->input.next();
+            if (quote != '"' && quote != '\'')
+            {
+                return this->createFail("Expected a quoted attribute value");
+            }
+
+            String value;
+            const auto result = this->readAttributeValue(quote, value);
+            if (result.failed())
+            {
+                return result;
+            }
+
+            MemoryBlock binaryData;
+            if (attributeName.startsWith("base64:") && binaryData.fromBase64Encoding(value))
+            {
+                this->target.writeProperty(Identifier(attributeName.substring(7)), var(binaryData));
+            }
+            else
+            {
+                this->target.writeProperty(Identifier(attributeName), value);
+            }
+        }
+    }
+
+    // appends to whatever is in the buffer
+    String readName()
+    {
+        for (;;)
+        {
+            const auto c = this->input.peek();
+            if (c == 0 || c == '=' || c == '>' || c == '/' ||
+                CharacterFunctions::isWhitespace(c))
+            {
+                break;
+            }
+
+            this->buffer.writeByte(this->input.next());
+        }
+
+        const auto name = String::fromUTF8(static_cast<const char *>(this->buffer.getData()),
+            int(this->buffer.getDataSize()));
+
+        this->buffer.reset();
+        return name;
+    }
+
+    Result readAttributeValue(char quote, String &result)
+    {
+        this->buffer.reset();
+
+        for (;;)
+        {
+            // multi-byte utf-8 characters are copied as is
+            const auto c = this->input.next();
+
+            if (c == quote)
+            {
+                break;
+            }
+
+            if (c == 0)
+            {
+                return this->createFail("Unexpected end of input in attribute value");
+            }
+
+            if (c == '&')
+            {
+                const auto r = this->readEntity();
+                if (r.failed())
+                {
+                    return r;
+                }
+            }
+            else
+            {
+                this->buffer.writeByte(c);
+            }
+        }
+
+        result = String::fromUTF8(static_cast<const char *>(this->buffer.getData()),
+            int(this->buffer.getDataSize()));
+
+        this->buffer.reset();
+        return Result::ok();
+    }
+
+    Result readEntity()
+    {
+        char entity[16] = {};
+        int length = 0;
+
+        for (;;)
+        {
+            const auto c = this->input.next();
+            if (c == ';')
+            {
+                break;
+            }
+
+            if (c == 0 || length >= numElementsInArray(entity) - 1)
+            {
+                return this->createFail("Unterminated entity");
+            }
+
+            entity[length++] = c;
+        }
+
+        const String name(entity);
+
+        if (name == "amp")          { this->buffer.writeByte('&'); }
+        else if (name == "quot")    { this->buffer.writeByte('"'); }
+        else if (name == "apos")    { this->buffer.writeByte('\''); }
+        else if (name == "lt")      { this->buffer.writeByte('<'); }
+        else if (name == "gt")      { this->buffer.writeByte('>'); }
+        else if (name.startsWithChar('#'))
+        {
+            const auto charCode = (name[1] == 'x' || name[1] == 'X') ?
+                name.substring(2).getHexValue32() : name.substring(1).getIntValue();
+
+            if (charCode <= 0)
+            {
+                return this->createFail("Invalid character reference");
+            }
+
+            this->buffer.appendUTF8Char(juce_wchar(charCode));
+        }
+        else
+        {
+            return this->createFail("Unknown entity");
+        }
+
+        return Result::ok();
+    }
+
+    void skipWhitespaces()
+    {
+        while (CharacterFunctions::isWhitespace(this->input.peek()))
+        {
+            this->input.next();
+        }
+    }
+
+    void skipUntil(const char *terminator)
+    {
+        const auto length = int(strlen(terminator));
+        int matched = 0;
+
+        while (matched < length)
+        {
+            const auto c = this->input.next();
+            if (c == 0)
+            {
+                return;
+            }
+
+            if (c == terminator[matched])
+            {
+                matched++;
+            }
+            else
+            {
+                matched = (c == terminator[0]) ? 1 : 0;
+            }
+        }
+    }
+
+    // the internal subset may contain brackets of its own
+    void skipDoctype()
+    {
+        int nesting = 0;
+        for (;;)
+        {
+            const auto c = this->input.next();
+            if (c == 0) { return; }
+            else if (c == '[') { nesting++; }
+            else if (c == ']') { nesting--; }
+            else if (c == '>' && nesting <= 0) { return; }
+        }
+    }
+
+    void skipByteOrderMark()
+    {
+        if (static_cast<uint8>(this->input.peek()) == 0xef)
+        {
+            this->input.next();
+            this->input.next();
+            this->input.next();
+        }
+    }
+
+    Result createFail(const char *const message) const
+    {
+        String m(message);
+        m << " at " << String(this->input.getPosition());
+        return Result::fail(m);
+    }
+
+    SerializedDataStreamReader input;
+    SerializedDataWriter &target;
+
+    MemoryOutputStream buffer;
+
+    int depth = 0;
+    bool hasParsedRoot = false;
+
+    JUCE_DECLARE_NON_COPYABLE(XmlStreamParser)
+};
+
+//===----------------------------------------------------------------------===//
+// Xml serializer
+//===----------------------------------------------------------------------===//
 
 Result XmlSerializer::saveToFile(File file, const SerializedData &tree) const
 {
-    UniquePointer<XmlElement> xml(tree.writeToXml());
-    if (xml != nullptr)
+    FileOutputStream fileStream(file);
+    if (fileStream.openedOk())
     {
-        const auto saved = xml->writeTo(file, getXmlFormat());
-        return saved ? Result::ok() : Result::fail({});
+        fileStream.setPosition(0);
+        fileStream.truncate();
+
+        XmlStreamWriter writer(fileStream);
+        writer.writeNode(tree);
+        return Result::ok();
     }
 
-    return Result::fail({});
+    return Result::fail("Failed to save");
 }
 
 SerializedData XmlSerializer::loadFromFile(const File &file) const
 {
-    XmlDocument document(file);
-    UniquePointer<XmlElement> xml(document.getDocumentElement());
-    if (xml != nullptr)
+    FileInputStream fileStream(file);
+    if (!fileStream.openedOk())
     {
-        return SerializedData::readFromXml(*xml);
+        return {};
+    }
+
+    SerializedDataBuilder builder;
+    XmlStreamParser parser(fileStream, builder);
+    if (parser.parseDocument().wasOk())
+    {
+        return builder.getResult();
     }
 
     return {};
@@ -55,21 +560,40 @@ SerializedData XmlSerializer::loadFromFile(const File &file) const
 
 Result XmlSerializer::saveToString(String &string, const SerializedData &tree) const
 {
-    UniquePointer<XmlElement> xml(tree.writeToXml());
-    if (xml != nullptr)
+    MemoryOutputStream stringStream;
+
     {
-        string = xml->toString(getXmlFormat());
-        return Result::ok();
+        XmlStreamWriter writer(stringStream);
+        writer.writeNode(tree);
     }
 
-    return Result::fail({});
+    string = stringStream.toUTF8();
+    return Result::ok();
 }
 
 SerializedData XmlSerializer::loadFromString(const String &string) const
 {
-    XmlDocument document(string);
-    UniquePointer<XmlElement> xml(document.getDocumentElement());
-    return SerializedData::readFromXml(*xml);
+    MemoryInputStream stringStream(string.toRawUTF8(), string.getNumBytesAsUTF8(), false);
+
+    SerializedDataBuilder builder;
+    XmlStreamParser parser(stringStream, builder);
+    if (parser.parseDocument().wasOk())
+    {
+        return builder.getResult();
+    }
+
+    return {};
+}
+
+UniquePointer<SerializedDataWriter> XmlSerializer::createWriter(OutputStream &output) const
+{
+    return make<XmlStreamWriter>(output);
+}
+
+Result XmlSerializer::read(InputStream &input, SerializedDataWriter &target) const
+{
+    XmlStreamParser parser(input, target);
+    return parser.parseDocument();
 }
 
 bool XmlSerializer::supportsFileWithExtension(const String &extension) const
@@ -182,6 +182,25 @@ SerializedData AutomationTrackNode::serialize() const
     return tree;
 }
 
+void AutomationTrackNode::serializeTo(SerializedDataWriter &writer) const
+{
+    writer.beginNode(Serialization::Core::treeNode);
+
+    this->serializeVCSUuid(writer);
+
+    writer.writeProperty(Serialization::Core::treeNodeType, this->type);
+    writer.writeProperty(Serialization::Core::treeNodeName, this->name);
+
+    this->serializeTrackProperties(writer);
+
+    this->sequence->serializeTo(writer);
+    this->pattern->serializeTo(writer);
+
+    TreeNodeSerializer::serializeChildren(*this, writer);
+
+    writer.endNode();
+}
+
 void AutomationTrackNode::deserialize(const SerializedData &data)
 {
     this->reset();
@@ -191,7 +210,7 @@ void AutomationTrackNode::deserialize(const SerializedData &data)
 
     forEachChildWithType(data, e, Serialization::Midi::automation)
     {
-        this->sequence->deserialize(e);
+        this->deserializeSequence(e);
     }
 
     forEachChildWithType(data, e, Serialization::Midi::pattern)
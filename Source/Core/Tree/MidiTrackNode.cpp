@@ -380,6 +380,7 @@ void MidiTrackNode::dispatchChangeProjectBeatRange()
 {
     if (this->lastFoundParent != nullptr)
     {
+        this->lastFoundParent->onTrackBeatRangeChanged(this);
         this->lastFoundParent->broadcastChangeProjectBeatRange();
     }
 }
@@ -423,6 +424,15 @@ ProjectNode *MidiTrackNode::getProject() const noexcept
     return this->lastFoundParent;
 }
 
+void MidiTrackNode::deserializeSequence(const SerializedData &data)
+{
+    if (this->lastFoundParent == nullptr ||
+        !this->lastFoundParent->deferSequenceLoading(this->sequence.get(), data))
+    {
+        this->sequence->deserialize(data);
+    }
+}
+
 //===----------------------------------------------------------------------===//
 // Add to tree and remove from tree callbacks
 //===----------------------------------------------------------------------===//
@@ -435,6 +445,12 @@ void MidiTrackNode::onNodeAddToTree(bool sendNotifications)
     const bool parentHasChanged = (this->lastFoundParent != newParent);
     this->lastFoundParent = newParent;
 
+    // the track might have been just moved within the same project
+    if (this->lastFoundParent != nullptr)
+    {
+        this->lastFoundParent->onTrackNodesChanged();
+    }
+
     if (parentHasChanged &&
         sendNotifications &&
         this->lastFoundParent != nullptr)
@@ -456,6 +472,7 @@ void MidiTrackNode::onNodeRemoveFromTree(bool sendNotifications)
 
         // Then disconnect from the tree
         this->removeNodeFromParent();
+        this->lastFoundParent->onTrackNodesChanged();
         TrackGroupNode::removeAllEmptyGroupsInProject(this->lastFoundParent);
     }
 }
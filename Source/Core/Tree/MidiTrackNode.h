@@ -116,6 +116,9 @@ public:
 
 protected:
 
+    // loads the sequence right away, or later when the whole project is loaded
+    void deserializeSequence(const SerializedData &data);
+
     ProjectNode *lastFoundParent;
 
     UniquePointer<MidiSequence> sequence;
@@ -18,6 +18,7 @@
 #include "Common.h"
 #include "PianoTrackNode.h"
 #include "PianoSequence.h"
+#include "PackedNotes.h"
 #include "ProjectNode.h"
 #include "TreeNodeSerializer.h"
 #include "Icons.h"
@@ -178,6 +179,25 @@ SerializedData PianoTrackNode::serialize() const
     return tree;
 }
 
+void PianoTrackNode::serializeTo(SerializedDataWriter &writer) const
+{
+    writer.beginNode(Serialization::Core::treeNode);
+
+    this->serializeVCSUuid(writer);
+
+    writer.writeProperty(Serialization::Core::treeNodeType, this->type);
+    writer.writeProperty(Serialization::Core::treeNodeName, this->name);
+
+    this->serializeTrackProperties(writer);
+
+    this->sequence->serializeTo(writer);
+    this->pattern->serializeTo(writer);
+
+    TreeNodeSerializer::serializeChildren(*this, writer);
+
+    writer.endNode();
+}
+
 void PianoTrackNode::deserialize(const SerializedData &data)
 {
     this->reset();
@@ -187,7 +207,7 @@ void PianoTrackNode::deserialize(const SerializedData &data)
 
     forEachChildWithType(data, e, Serialization::Midi::track)
     {
-        this->sequence->deserialize(e);
+        this->deserializeSequence(e);
     }
 
     forEachChildWithType(data, e, Serialization::Midi::pattern)
@@ -230,14 +250,8 @@ SerializedData PianoTrackNode::serializeInstrumentDelta() const
 
 SerializedData PianoTrackNode::serializeEventsDelta() const
 {
-    SerializedData tree(Serialization::VCS::PianoSequenceDeltas::notesAdded);
-    for (int i = 0; i < this->getSequence()->size(); ++i)
-    {
-        const MidiEvent *event = this->getSequence()->getUnchecked(i);
-        tree.appendChild(event->serialize());
-    }
-
-    return tree;
+    return VCS::PackedNotes::fromSequence(*this->getSequence())
+        .toDeltaData(Serialization::VCS::PianoSequenceDeltas::notesAdded);
 }
 
 void PianoTrackNode::resetPathDelta(const SerializedData &state)
@@ -271,9 +285,11 @@ void PianoTrackNode::resetEventsDelta(const SerializedData &state)
     jassert(state.hasType(Serialization::VCS::PianoSequenceDeltas::notesAdded));
 
     this->getSequence()->reset();
-    forEachChildWithType(state, e, Serialization::Midi::note)
+
+    const auto notes = VCS::PackedNotes::fromDeltaData(state);
+    for (int i = 0; i < notes.size(); ++i)
     {
-        this->getSequence()->checkoutEvent<Note>(e);
+        this->getSequence()->checkoutEvent<Note>(notes.createNote(i));
     }
 
     this->getSequence()->updateBeatRange(false);
@@ -43,6 +43,7 @@ public:
     //===------------------------------------------------------------------===//
 
     SerializedData serialize() const override;
+    void serializeTo(SerializedDataWriter &writer) const override;
     void deserialize(const SerializedData &data) override;
 
     //===------------------------------------------------------------------===//
@@ -38,6 +38,7 @@
 #include "RollBase.h"
 #include "UndoStack.h"
 #include "MidiRecorder.h"
+#include "MidiFileWriter.h"
 #include "KeyboardMapping.h"
 
 #include "ProjectMetadata.h"
@@ -51,6 +52,8 @@
 #include "Workspace.h"
 #include "ColourIDs.h"
 #include "Config.h"
+#include "FrameProfiler.h"
+#include "ParallelWorkers.h"
 
 ProjectNode::ProjectNode() :
     DocumentOwner({}, "helio"),
@@ -80,6 +83,9 @@ void ProjectNode::initialize()
     this->undoStack = make<UndoStack>(*this);
     this->autosaver = make<Autosaver>(*this);
 
+    // the helper threads for loading and importing the tracks concurrently
+    this->loadingThreadPool = make<ThreadPool>(jmax(1, SystemStats::getNumCpus() - 1));
+
     auto &orchestra = App::Workspace().getAudioCore();
     auto &audioCoreSleepTimer = App::Workspace().getAudioCore(); // yup, the same
     this->transport = make<Transport>(orchestra, audioCoreSleepTimer);
@@ -125,6 +131,8 @@ ProjectNode::~ProjectNode()
 
     this->autosaver = nullptr;
     this->undoStack = nullptr;
+
+    this->loadingThreadPool = nullptr;
 }
 
 String ProjectNode::getId() const noexcept
@@ -134,7 +142,7 @@ String ProjectNode::getId() const noexcept
 
 String ProjectNode::getStats() const
 {
-    const auto tracks = this->findChildrenOfType<MidiTrackNode>();
+    const auto &tracks = this->getTrackNodes();
     
     int numEvents = 0;
     int numTracks = tracks.size();
@@ -227,7 +235,7 @@ void ProjectNode::recreatePage()
     this->lastBeatCache = Globals::Defaults::projectLength;
 
     // if there is anything to reload, reload:
-    if (!this->findChildrenOfType<MidiTrack>().isEmpty())
+    if (!this->getTrackNodes().isEmpty())
     {
         this->broadcastReloadProjectContent();
 
@@ -333,6 +341,9 @@ UniquePointer<Component> ProjectNode::createMenu()
 
 void ProjectNode::onNodeChildPostRemove(bool sendNotifications)
 {
+    // whatever was removed, it might have contained tracks
+    this->isTracksCacheOutdated = true;
+
     // a track have removed, the range might have changed:
     if (sendNotifications)
     {
@@ -385,7 +396,7 @@ void ProjectNode::removeTrack(const MidiTrack &track)
     }
 
     // nothing to be focused on in the piano roll, switch to patterns:
-    if (this->findChildrenOfType<PianoTrackNode>().isEmpty())
+    if (this->getPianoTracks().isEmpty())
     {
         this->selectFirstChildOfType<PatternEditorNode>();
     }
@@ -395,59 +406,56 @@ void ProjectNode::removeTrack(const MidiTrack &track)
 // Project
 //===----------------------------------------------------------------------===//
 
-Array<MidiTrack *> ProjectNode::getTracks() const
+const Array<MidiTrack *> &ProjectNode::getTracks() const
 {
-    const ScopedReadLock lock(this->tracksListLock);
-    Array<MidiTrack *> tracks;
+    this->rebuildTracksRefsCacheIfNeeded();
+    return this->tracksCache;
+}
 
-    // now get all layers inside a tree hierarchy
-    this->collectTracks(tracks);
-    
-    // and explicitly add the only non-tree-owned tracks
-    tracks.add(this->timeline->getAnnotations());
-    tracks.add(this->timeline->getKeySignatures());
-    tracks.add(this->timeline->getTimeSignatures());
+const Array<MidiTrackNode *> &ProjectNode::getTrackNodes() const
+{
+    this->rebuildTracksRefsCacheIfNeeded();
+    return this->trackNodesCache;
+}
 
-    return tracks;
+const Array<PianoTrackNode *> &ProjectNode::getPianoTracks() const
+{
+    this->rebuildTracksRefsCacheIfNeeded();
+    return this->pianoTracksCache;
 }
 
-void ProjectNode::collectTracks(Array<MidiTrack *> &resultArray, bool onlySelected /*= false*/) const
+const Array<AutomationTrackNode *> &ProjectNode::getAutomationTracks() const
 {
-    const auto trackNodes = this->findChildrenOfType<MidiTrackNode>();
-    
-    for (int i = 0; i < trackNodes.size(); ++i)
+    this->rebuildTracksRefsCacheIfNeeded();
+    return this->automationTracksCache;
+}
+
+void ProjectNode::onTrackNodesChanged() noexcept
+{
+    this->isTracksCacheOutdated = true;
+}
+
+void ProjectNode::onTrackBeatRangeChanged(const MidiTrack *track)
+{
+    if (this->isBeatRangeIndexOutdated)
     {
-        if (trackNodes.getUnchecked(i)->isSelected() || !onlySelected)
-        {
-            resultArray.add(trackNodes.getUnchecked(i));
-        }
+        return; // will be rebuilt from scratch on the next request
     }
+
+    this->removeTrackBeatRange(track);
+    this->addTrackBeatRange(track);
 }
 
 Range<float> ProjectNode::getProjectRangeInBeats() const
 {
-    float lastBeat = -FLT_MAX;
-    float firstBeat = FLT_MAX;
+    this->rebuildBeatRangeIndexIfNeeded();
 
-    this->rebuildTracksRefsCacheIfNeeded();
+    float firstBeat = this->tracksFirstBeats.empty() ?
+        FLT_MAX : *this->tracksFirstBeats.begin();
 
-    for (const auto &i : this->tracksRefsCache)
-    {
-        const auto *track = i.second.get();
-        if (track->getSequence()->isEmpty())
-        {
-            // ignore empty tracks as they affect the project range in a misleading way
-            continue;
-        }
+    float lastBeat = this->tracksLastBeats.empty() ?
+        -FLT_MAX : *this->tracksLastBeats.rbegin();
 
-        const float sequenceFirstBeat = track->getSequence()->getFirstBeat();
-        const float sequenceLastBeat = track->getSequence()->getLastBeat();
-        const float patternFirstBeat = track->getPattern() ? track->getPattern()->getFirstBeat() : 0.f;
-        const float patternLastBeat = track->getPattern() ? track->getPattern()->getLastBeat() : 0.f;
-        firstBeat = jmin(firstBeat, sequenceFirstBeat + patternFirstBeat);
-        lastBeat = jmax(lastBeat, sequenceLastBeat + patternLastBeat);
-    }
-    
     if (firstBeat == FLT_MAX)
     {
         firstBeat = 0;
@@ -535,25 +543,28 @@ void ProjectNode::reset()
     this->vcsItems.add(this->timeline.get());
     this->undoStack->clearUndoHistory();
     TreeNode::reset();
+    this->isTracksCacheOutdated = true;
 }
 
-SerializedData ProjectNode::save() const
+// the track nodes write their sequences directly into the writer,
+// so the text formats don't need the whole project tree in memory
+void ProjectNode::saveTo(SerializedDataWriter &writer) const
 {
-    SerializedData tree(Serialization::Core::project);
+    writer.beginNode(Serialization::Core::project);
 
-    tree.setProperty(Serialization::Core::treeNodeName, this->name);
-    tree.setProperty(Serialization::Core::projectId, this->id);
-    tree.setProperty(Serialization::UI::trackGrouping, int(this->trackGroupingMode));
+    writer.writeProperty(Serialization::Core::treeNodeName, this->name);
+    writer.writeProperty(Serialization::Core::projectId, this->id);
+    writer.writeProperty(Serialization::UI::trackGrouping, int(this->trackGroupingMode));
 
-    tree.appendChild(this->metadata->serialize());
-    tree.appendChild(this->timeline->serialize());
-    tree.appendChild(this->undoStack->serialize());
-    tree.appendChild(this->transport->serialize());
-    tree.appendChild(this->sequencerLayout->serialize());
+    this->metadata->serializeTo(writer);
+    this->timeline->serializeTo(writer);
+    this->undoStack->serializeTo(writer);
+    this->transport->serializeTo(writer);
+    this->sequencerLayout->serializeTo(writer);
 
-    TreeNodeSerializer::serializeChildren(*this, tree);
+    TreeNodeSerializer::serializeChildren(*this, writer);
 
-    return tree;
+    writer.endNode();
 }
 
 void ProjectNode::load(const SerializedData &tree)
@@ -571,11 +582,20 @@ void ProjectNode::load(const SerializedData &tree)
     const auto grouping = root.getProperty(Serialization::UI::trackGrouping, int(this->trackGroupingMode));
     this->trackGroupingMode = MidiTrack::Grouping(int(grouping));
 
+    auto stageStartMs = Time::getMillisecondCounterHiRes();
+
     this->metadata->deserialize(root);
     this->timeline->deserialize(root);
 
-    // Proceed with basic properties and children
+    DBG("Project metadata and timeline loaded in " +
+        String(Time::getMillisecondCounterHiRes() - stageStartMs, 2) + " ms");
+    stageStartMs = Time::getMillisecondCounterHiRes();
+
+    // Proceed with basic properties and children,
+    // the track nodes only collect their sequences here
+    this->isLoadingTree = true;
     TreeNode::deserialize(root);
+    this->isLoadingTree = false;
 
     // Legacy support: if no pattern set manager found, create one
     if (nullptr == this->findChildOfType<PatternEditorNode>())
@@ -584,6 +604,17 @@ void ProjectNode::load(const SerializedData &tree)
         this->addChildNode(new PatternEditorNode(), 1);
     }
 
+    DBG("Project tree loaded in " +
+        String(Time::getMillisecondCounterHiRes() - stageStartMs, 2) + " ms");
+    stageStartMs = Time::getMillisecondCounterHiRes();
+
+    const auto numSequences = this->deferredSequences.size();
+    this->loadDeferredSequences();
+
+    DBG(String(numSequences) + " sequences loaded in " +
+        String(Time::getMillisecondCounterHiRes() - stageStartMs, 2) + " ms");
+    stageStartMs = Time::getMillisecondCounterHiRes();
+
     this->broadcastReloadProjectContent();
     const auto range = this->broadcastChangeProjectBeatRange();
 
@@ -597,17 +628,62 @@ void ProjectNode::load(const SerializedData &tree)
     const float viewLastBeat = ceilf(viewEndWithMargin / r) * r;
     this->broadcastChangeViewBeatRange(viewFirstBeat, viewLastBeat);
 
+    DBG("Project listeners reloaded in " +
+        String(Time::getMillisecondCounterHiRes() - stageStartMs, 2) + " ms");
+    stageStartMs = Time::getMillisecondCounterHiRes();
+
     this->undoStack->deserialize(root);
 
     // At least, when all tracks are ready:
     this->transport->deserialize(root);
     this->sequencerLayout->deserialize(root);
+
+    DBG("Undo stack, transport and layout loaded in " +
+        String(Time::getMillisecondCounterHiRes() - stageStartMs, 2) + " ms");
+}
+
+bool ProjectNode::deferSequenceLoading(MidiSequence *sequence, const SerializedData &data)
+{
+    if (!this->isLoadingTree)
+    {
+        return false;
+    }
+
+    this->deferredSequences.add({ sequence, data });
+    return true;
+}
+
+void ProjectNode::loadDeferredSequences()
+{
+    // sequences are already attached to their tracks, but nobody
+    // looks into them until the reload broadcast, and each sequence
+    // only touches its own events while deserializing,
+    // so they can be loaded concurrently, like in importMidi:
+    std::atomic<int> nextSequenceIndex(0);
+    const std::function<void()> loadRemainingSequences = [&]()
+    {
+        for (int i = nextSequenceIndex++; i < this->deferredSequences.size(); i = nextSequenceIndex++)
+        {
+            const auto &deferred = this->deferredSequences.getReference(i);
+            deferred.sequence->deserialize(deferred.data);
+        }
+    };
+
+    const auto numHelperJobs =
+        jmin(this->loadingThreadPool->getNumThreads(), this->deferredSequences.size() - 1);
+
+    ParallelWorkers(this->loadingThreadPool.get(),
+        numHelperJobs, loadRemainingSequences).run();
+
+    this->deferredSequences.clear();
 }
 
 void ProjectNode::importMidi(InputStream &stream)
 {
+    // note on/off pairs are matched by the piano sequence importer in one pass,
+    // no need to let MidiFile do the quadratic matching for every track:
     MidiFile tempFile;
-    if (!tempFile.readFrom(stream))
+    if (!tempFile.readFrom(stream, false))
     {
         DBG("Midi file appears corrupted");
         return;
@@ -620,6 +696,10 @@ void ProjectNode::importMidi(InputStream &stream)
     const auto colours = ColourIDs::getColoursList();
     const auto timeFormat = tempFile.getTimeFormat();
 
+    // the track nodes are created here, and filled in later in parallel
+    Array<MidiSequence *> targetSequences;
+    Array<const MidiMessageSequence *> sourceTracks;
+
     for (int i = 0; i < tempFile.getNumTracks(); i++)
     {
         const auto *importedTrack = tempFile.getTrack(i);
@@ -668,7 +748,9 @@ void ProjectNode::importMidi(InputStream &stream)
 
             trackNode->setTrackControllerNumber(trackControllerNumber, dontSendNotification);
             trackNode->setTrackColour(colour, dontSendNotification);
-            trackNode->getSequence()->importMidi(*importedTrack, timeFormat);
+
+            targetSequences.add(trackNode->getSequence());
+            sourceTracks.add(importedTrack);
         }
 
         if (hasPianoEvents)
@@ -681,16 +763,42 @@ void ProjectNode::importMidi(InputStream &stream)
             this->addChildNode(trackNode, -1, false);
 
             trackNode->setTrackColour(colour, dontSendNotification);
-            trackNode->getSequence()->importMidi(*importedTrack, timeFormat);
+
+            targetSequences.add(trackNode->getSequence());
+            sourceTracks.add(importedTrack);
         }
+    }
+
+    // each sequence only touches its own events while importing,
+    // so the tracks can be imported concurrently:
+    std::atomic<int> nextTrackIndex(0);
+    const std::function<void()> importRemainingTracks = [&]()
+    {
+        for (int i = nextTrackIndex++; i < targetSequences.size(); i = nextTrackIndex++)
+        {
+            targetSequences.getUnchecked(i)->importMidi(*sourceTracks.getUnchecked(i), timeFormat);
+        }
+    };
+
+    const auto numHelperJobs =
+        jmin(this->loadingThreadPool->getNumThreads(), targetSequences.size() - 1);
 
-        // if the track contains any key/time signatures, try importing them all,
-        // skipping others (assuming that there might be cases where tracks contain
-        // events of different types, e.g. mostly notes but also some meta events):
+    ParallelWorkers(this->loadingThreadPool.get(),
+        numHelperJobs, importRemainingTracks).run();
+
+    // if the track contains any key/time signatures, try importing them all,
+    // skipping others (assuming that there might be cases where tracks contain
+    // events of different types, e.g. mostly notes but also some meta events):
+    for (int i = 0; i < tempFile.getNumTracks(); i++)
+    {
+        const auto *importedTrack = tempFile.getTrack(i);
         this->timeline->getAnnotations()->getSequence()->importMidi(*importedTrack, timeFormat);
         this->timeline->getKeySignatures()->getSequence()->importMidi(*importedTrack, timeFormat);
         this->timeline->getTimeSignatures()->getSequence()->importMidi(*importedTrack, timeFormat);
     }
+
+    this->undoStack->clearUndoHistory();
+    this->undoStack->beginNewTransaction();
     
     this->isTracksCacheOutdated = true;
     this->broadcastReloadProjectContent();
@@ -732,6 +840,7 @@ void ProjectNode::broadcastChangeEvent(const MidiEvent &oldEvent, const MidiEven
 {
     //jassert(oldEvent.isValid()); // old event is allowed to be un-owned
     jassert(newEvent.isValid());
+    FrameProfiler::countListenerCalls(this->changeListeners.size());
     this->changeListeners.call(&ProjectListener::onChangeMidiEvent, oldEvent, newEvent);
     this->sendChangeMessage();
 }
@@ -739,6 +848,7 @@ void ProjectNode::broadcastChangeEvent(const MidiEvent &oldEvent, const MidiEven
 void ProjectNode::broadcastAddEvent(const MidiEvent &event)
 {
     jassert(event.isValid());
+    FrameProfiler::countListenerCalls(this->changeListeners.size());
     this->changeListeners.call(&ProjectListener::onAddMidiEvent, event);
     this->sendChangeMessage();
 }
@@ -746,6 +856,7 @@ void ProjectNode::broadcastAddEvent(const MidiEvent &event)
 void ProjectNode::broadcastRemoveEvent(const MidiEvent &event)
 {
     jassert(event.isValid());
+    FrameProfiler::countListenerCalls(this->changeListeners.size());
     this->changeListeners.call(&ProjectListener::onRemoveMidiEvent, event);
     this->sendChangeMessage();
 }
@@ -792,24 +903,28 @@ void ProjectNode::broadcastChangeTrackProperties(MidiTrack *const track)
 
 void ProjectNode::broadcastChangeTrackBeatRange(MidiTrack *const track)
 {
+    FrameProfiler::countListenerCalls(this->changeListeners.size());
     this->changeListeners.call(&ProjectListener::onChangeTrackBeatRange, track);
     this->sendChangeMessage();
 }
 
 void ProjectNode::broadcastAddClip(const Clip &clip)
 {
+    FrameProfiler::countListenerCalls(this->changeListeners.size());
     this->changeListeners.call(&ProjectListener::onAddClip, clip);
     this->sendChangeMessage();
 }
 
 void ProjectNode::broadcastChangeClip(const Clip &oldClip, const Clip &newClip)
 {
+    FrameProfiler::countListenerCalls(this->changeListeners.size());
     this->changeListeners.call(&ProjectListener::onChangeClip, oldClip, newClip);
     this->sendChangeMessage();
 }
 
 void ProjectNode::broadcastRemoveClip(const Clip &clip)
 {
+    FrameProfiler::countListenerCalls(this->changeListeners.size());
     this->changeListeners.call(&ProjectListener::onRemoveClip, clip);
     this->sendChangeMessage();
 }
@@ -840,6 +955,7 @@ Range<float> ProjectNode::broadcastChangeProjectBeatRange()
         // so that transport updates playhead position later then others,
         // so that resizing roll will make playhead glitch;
         // as a hack, just force transport to update its playhead position before all others
+        FrameProfiler::countListenerCalls(this->changeListeners.size());
         this->transport->onChangeProjectBeatRange(this->firstBeatCache, this->lastBeatCache);
         this->changeListeners.callExcluding(this->transport.get(),
             &ProjectListener::onChangeProjectBeatRange, this->firstBeatCache, this->lastBeatCache);
@@ -857,6 +973,9 @@ void ProjectNode::broadcastBeforeReloadProjectContent()
 
 void ProjectNode::broadcastReloadProjectContent()
 {
+    // tracks' sequences might have been reloaded without notifications
+    this->isBeatRangeIndexOutdated = true;
+
     this->changeListeners.call(&ProjectListener::onReloadProjectContent,
         this->getTracks(), this->metadata.get());
 
@@ -875,6 +994,7 @@ void ProjectNode::broadcastDeactivateProjectSubtree()
 
 void ProjectNode::broadcastChangeViewBeatRange(float firstBeat, float lastBeat)
 {
+    FrameProfiler::countListenerCalls(this->changeListeners.size());
     this->changeListeners.call(&ProjectListener::onChangeViewBeatRange, firstBeat, lastBeat);
     // this->sendChangeMessage(); the project itself didn't change, so dont call this
 }
@@ -903,11 +1023,15 @@ bool ProjectNode::onDocumentLoad(const File &file)
 
 bool ProjectNode::onDocumentSave(const File &file)
 {
-    const auto projectNode = this->save();
+    const auto saveProject = [this](SerializedDataWriter &writer)
+    {
+        this->saveTo(writer);
+    };
+
 #if DEBUG
-    DocumentHelpers::save<XmlSerializer>(file.withFileExtension("xml"), projectNode);
+    DocumentHelpers::save<XmlSerializer>(file.withFileExtension("xml"), saveProject);
 #endif
-    return DocumentHelpers::save<BinarySerializer>(file, projectNode);
+    return DocumentHelpers::save<BinarySerializer>(file, saveProject);
 }
 
 void ProjectNode::onDocumentImport(InputStream &stream)
@@ -925,52 +1049,13 @@ bool ProjectNode::onDocumentExport(OutputStream &stream)
 
 void ProjectNode::exportMidi(OutputStream &stream) const
 {
-    MidiFile tempFile;
-    static const double midiClock = 960.0;
-    tempFile.setTicksPerQuarterNote(int(midiClock));
-
-    static Clip noTransform;
-    static KeyboardMapping simpleMapping;
+    static constexpr auto midiClock = 960;
 
     // Solo flags won't be taken into account
-    // in MIDI export, as I believe they shouldn't:
-    const bool soloFlag = false;
-
-    const auto grouping = this->getTrackGroupingMode();
-    FlatHashMap<String, MidiMessageSequence, StringHash> sequences;
-
-    for (const auto *track : this->getTracks())
-    {
-        const auto groupKey = track->getTrackGroupKey(grouping);
-        if (!sequences.contains(groupKey))
-        {
-            sequences.insert({ groupKey, {} });
-        }
-
-        auto &sequence = sequences[groupKey];
-
-        // todo add more meta events like track name
-        if (track->getPattern() != nullptr)
-        {
-            for (const auto *clip : track->getPattern()->getClips())
-            {
-                track->getSequence()->exportMidi(sequence, *clip,
-                    simpleMapping, soloFlag, 0.0, midiClock);
-            }
-        }
-        else
-        {
-            track->getSequence()->exportMidi(sequence, noTransform,
-                simpleMapping, soloFlag, 0.0, midiClock);
-        }
-    }
-
-    for (const auto &i : sequences)
-    {
-        tempFile.addTrack(i.second);
-    }
-
-    tempFile.writeTo(stream);
+    // in MIDI export, as I believe they shouldn't
+    // todo add more meta events like track name
+    MidiFileWriter writer(stream, midiClock);
+    writer.write(this->getTracks(), this->getTrackGroupingMode());
 }
 
 //===----------------------------------------------------------------------===//
@@ -1129,27 +1214,98 @@ void ProjectNode::changeListenerCallback(ChangeBroadcaster *source)
 
 void ProjectNode::rebuildTracksRefsCacheIfNeeded() const
 {
-    if (this->isTracksCacheOutdated)
+    if (!this->isTracksCacheOutdated)
     {
-        this->tracksRefsCache.clear();
+        return;
+    }
 
-        this->tracksRefsCache[this->timeline->getAnnotations()->getTrackId()] =
-            this->timeline->getAnnotations();
+    // the only full tree scan, the registries keep the tree order
+    this->trackNodesCache = this->findChildrenOfType<MidiTrackNode>();
 
-        this->tracksRefsCache[this->timeline->getKeySignatures()->getTrackId()] =
-            this->timeline->getKeySignatures();
+    this->pianoTracksCache.clearQuick();
+    this->automationTracksCache.clearQuick();
+    this->tracksCache.clearQuick();
+    this->tracksRefsCache.clear();
 
-        this->tracksRefsCache[this->timeline->getTimeSignatures()->getTrackId()] =
-            this->timeline->getTimeSignatures();
-        
-        const auto children = this->findChildrenOfType<MidiTrack>();
-        
-        for (int i = 0; i < children.size(); ++i)
+    for (auto *trackNode : this->trackNodesCache)
+    {
+        if (auto *pianoTrack = dynamic_cast<PianoTrackNode *>(trackNode))
         {
-            MidiTrack *const track = children.getUnchecked(i);
-            this->tracksRefsCache[track->getTrackId()] = track;
+            this->pianoTracksCache.add(pianoTrack);
         }
-        
-        this->isTracksCacheOutdated = false;
+        else if (auto *automationTrack = dynamic_cast<AutomationTrackNode *>(trackNode))
+        {
+            this->automationTracksCache.add(automationTrack);
+        }
+
+        this->tracksCache.add(trackNode);
+    }
+
+    // and explicitly add the only non-tree-owned tracks
+    this->tracksCache.add(this->timeline->getAnnotations());
+    this->tracksCache.add(this->timeline->getKeySignatures());
+    this->tracksCache.add(this->timeline->getTimeSignatures());
+
+    for (auto *track : this->tracksCache)
+    {
+        this->tracksRefsCache[track->getTrackId()] = track;
+    }
+
+    this->isTracksCacheOutdated = false;
+    this->isBeatRangeIndexOutdated = true;
+}
+
+void ProjectNode::rebuildBeatRangeIndexIfNeeded() const
+{
+    this->rebuildTracksRefsCacheIfNeeded();
+
+    if (!this->isBeatRangeIndexOutdated)
+    {
+        return;
+    }
+
+    this->trackBeatRanges.clear();
+    this->tracksFirstBeats.clear();
+    this->tracksLastBeats.clear();
+
+    for (const auto *track : this->tracksCache)
+    {
+        this->addTrackBeatRange(track);
     }
+
+    this->isBeatRangeIndexOutdated = false;
+}
+
+void ProjectNode::addTrackBeatRange(const MidiTrack *track) const
+{
+    const auto *sequence = track->getSequence();
+    if (sequence->isEmpty())
+    {
+        // ignore empty tracks as they affect the project range in a misleading way
+        return;
+    }
+
+    const auto *pattern = track->getPattern();
+
+    TrackBeatRange range;
+    range.firstBeat = sequence->getFirstBeat() + (pattern != nullptr ? pattern->getFirstBeat() : 0.f);
+    range.lastBeat = sequence->getLastBeat() + (pattern != nullptr ? pattern->getLastBeat() : 0.f);
+
+    this->trackBeatRanges[track] = range;
+    this->tracksFirstBeats.insert(range.firstBeat);
+    this->tracksLastBeats.insert(range.lastBeat);
+}
+
+void ProjectNode::removeTrackBeatRange(const MidiTrack *track) const
+{
+    const auto found = this->trackBeatRanges.find(track);
+    if (found == this->trackBeatRanges.end())
+    {
+        return;
+    }
+
+    // erase only one instance of each value, others may belong to other tracks
+    this->tracksFirstBeats.erase(this->tracksFirstBeats.find(found->second.firstBeat));
+    this->tracksLastBeats.erase(this->tracksLastBeats.find(found->second.lastBeat));
+    this->trackBeatRanges.erase(found);
 }
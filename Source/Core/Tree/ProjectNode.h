@@ -32,6 +32,9 @@ class CommandPaletteTimelineEvents;
 class UndoStack;
 class Pattern;
 class Clip;
+class MidiTrackNode;
+class PianoTrackNode;
+class AutomationTrackNode;
 
 #include "TreeNode.h"
 #include "DocumentOwner.h"
@@ -70,6 +73,11 @@ public:
     void importMidi(InputStream &stream);
     void exportMidi(OutputStream &stream) const;
 
+    // while the project is loading, track nodes don't deserialize their
+    // sequences right away, but pass them here to be loaded in parallel
+    // when the whole tree is ready; returns false if not loading now
+    bool deferSequenceLoading(MidiSequence *sequence, const SerializedData &data);
+
     Image getIcon() const noexcept override;
 
     void showPage() override;
@@ -111,7 +119,23 @@ public:
     // Accessors
     //===------------------------------------------------------------------===//
 
-    Array<MidiTrack *> getTracks() const;
+    // all tracks, including the timeline ones, and the track nodes by type,
+    // in the tree order; these registries are rebuilt lazily after
+    // the tree changes, so the lookups are cheap and don't allocate;
+    // message thread only: the tree is only changed there,
+    // and the returned arrays are rebuilt in place
+    const Array<MidiTrack *> &getTracks() const;
+    const Array<MidiTrackNode *> &getTrackNodes() const;
+    const Array<PianoTrackNode *> &getPianoTracks() const;
+    const Array<AutomationTrackNode *> &getAutomationTracks() const;
+
+    // track nodes call this when they are added, moved or removed
+    void onTrackNodesChanged() noexcept;
+
+    // tracks call this when their sequence or pattern range changes,
+    // so that the project range is updated for that single track
+    void onTrackBeatRangeChanged(const MidiTrack *track);
+
     Range<float> getProjectRangeInBeats() const;
     StringArray getAllTrackNames() const;
     MidiTrack::Grouping getTrackGroupingMode() const noexcept;
@@ -209,8 +233,6 @@ protected:
 
 private:
 
-    void collectTracks(Array<MidiTrack *> &resultArray, bool onlySelected = false) const;
-
     UniquePointer<Autosaver> autosaver;
     UniquePointer<Transport> transport;
     UniquePointer<MidiRecorder> midiRecorder;
@@ -220,7 +242,6 @@ private:
 
     ListenerList<ProjectListener> changeListeners;
     UniquePointer<ProjectPage> projectPage;
-    ReadWriteLock tracksListLock;
 
     UniquePointer<ProjectMetadata> metadata;
     UniquePointer<ProjectTimeline> timeline;
@@ -232,9 +253,21 @@ private:
 private:
 
     void initialize();
-    SerializedData save() const;
+    void saveTo(SerializedDataWriter &writer) const;
     void load(const SerializedData &tree);
 
+    struct DeferredSequence final
+    {
+        MidiSequence *sequence = nullptr;
+        SerializedData data;
+    };
+
+    bool isLoadingTree = false;
+    Array<DeferredSequence> deferredSequences;
+    void loadDeferredSequences();
+
+    UniquePointer<ThreadPool> loadingThreadPool;
+
 private:
 
     String id;
@@ -251,6 +284,27 @@ private:
 
     mutable bool isTracksCacheOutdated = true;
     mutable FlatHashMap<String, WeakReference<MidiTrack>, StringHash> tracksRefsCache;
+    mutable Array<MidiTrack *> tracksCache;
+    mutable Array<MidiTrackNode *> trackNodesCache;
+    mutable Array<PianoTrackNode *> pianoTracksCache;
+    mutable Array<AutomationTrackNode *> automationTracksCache;
     void rebuildTracksRefsCacheIfNeeded() const;
 
+    // the non-empty tracks' beat ranges, and the sorted sets of their
+    // first and last beats, so that the project range is always the first
+    // and the last elements, updated in O(log n) when some track changes
+    struct TrackBeatRange final
+    {
+        float firstBeat = 0.f;
+        float lastBeat = 0.f;
+    };
+
+    mutable bool isBeatRangeIndexOutdated = true;
+    mutable FlatHashMap<const MidiTrack *, TrackBeatRange> trackBeatRanges;
+    mutable std::multiset<float> tracksFirstBeats;
+    mutable std::multiset<float> tracksLastBeats;
+    void rebuildBeatRangeIndexIfNeeded() const;
+    void addTrackBeatRange(const MidiTrack *track) const;
+    void removeTrackBeatRange(const MidiTrack *track) const;
+
 };
@@ -286,11 +286,16 @@ void ProjectTimeline::dispatchChangeTrackProperties()
 
 void ProjectTimeline::dispatchChangeTrackBeatRange()
 {
-    this->project.broadcastChangeProjectBeatRange();
+    this->dispatchChangeProjectBeatRange();
 }
 
 void ProjectTimeline::dispatchChangeProjectBeatRange()
 {
+    // all timeline sequences share this dispatcher, so we don't know
+    // which one has changed, but there are only three of them:
+    this->project.onTrackBeatRangeChanged(this->getAnnotations());
+    this->project.onTrackBeatRangeChanged(this->getKeySignatures());
+    this->project.onTrackBeatRangeChanged(this->getTimeSignatures());
     this->project.broadcastChangeProjectBeatRange();
 }
 
@@ -171,7 +171,7 @@ static ProjectNode *createProjectContentFromTemplate(ProjectNode *project, const
     return project;
 }
 
-static void addAllEssentialProjectNodes(ProjectNode *parent)
+void RootNode::addAllEssentialProjectNodes(ProjectNode *parent)
 {
     auto *vcs = new VersionControlNode();
     parent->addChildNode(vcs);
@@ -51,6 +51,9 @@ public:
     ProjectNode *addExampleProject();
     ProjectNode *addEmptyProject(const File &projectLocation, const String &templateName);
     ProjectNode *addEmptyProject(const String &projectName, const String &templateName);
+
+    // the version control and the pattern editor nodes every project must have
+    static void addAllEssentialProjectNodes(ProjectNode *project);
     
     //===------------------------------------------------------------------===//
     // Menu
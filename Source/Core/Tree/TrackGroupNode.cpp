@@ -19,6 +19,7 @@
 #include "TrackGroupNode.h"
 #include "ProjectNode.h"
 #include "PianoTrackNode.h"
+#include "TreeNodeSerializer.h"
 #include "Icons.h"
 
 TrackGroupNode::TrackGroupNode(const String &name) :
@@ -128,6 +129,19 @@ void TrackGroupNode::safeRename(const String &newName, bool sendNotifications)
     this->sortByNameAmongSiblings();
 }
 
+//===----------------------------------------------------------------------===//
+// Serializable
+//===----------------------------------------------------------------------===//
+
+void TrackGroupNode::serializeTo(SerializedDataWriter &writer) const
+{
+    writer.beginNode(Serialization::Core::treeNode);
+    writer.writeProperty(Serialization::Core::treeNodeType, this->type);
+    writer.writeProperty(Serialization::Core::treeNodeName, this->name);
+    TreeNodeSerializer::serializeChildren(*this, writer);
+    writer.endNode();
+}
+
 //===----------------------------------------------------------------------===//
 // Menu
 //===----------------------------------------------------------------------===//
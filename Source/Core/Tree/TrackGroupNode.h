@@ -37,6 +37,14 @@ public:
     void showPage() override;
     void safeRename(const String &newName, bool sendNotifications) override;
 
+    //===------------------------------------------------------------------===//
+    // Serializable
+    //===------------------------------------------------------------------===//
+
+    // groups contain the track nodes, so they need to pass
+    // the writer down to them, instead of building the subtree
+    void serializeTo(SerializedDataWriter &writer) const override;
+
     //===------------------------------------------------------------------===//
     // Menu
     //===------------------------------------------------------------------===//
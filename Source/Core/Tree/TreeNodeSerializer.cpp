@@ -39,6 +39,18 @@ void TreeNodeSerializer::serializeChildren(const TreeNode &parentItem, Serialize
     }
 }
 
+void TreeNodeSerializer::serializeChildren(const TreeNode &parentItem, SerializedDataWriter &writer)
+{
+    for (int i = 0; i < parentItem.getNumChildren(); ++i)
+    {
+        if (auto *sub = parentItem.getChild(i))
+        {
+            auto *treeItem = static_cast<TreeNode *>(sub);
+            treeItem->serializeTo(writer);
+        }
+    }
+}
+
 void TreeNodeSerializer::deserializeChildren(TreeNode &parentItem, const SerializedData &parent)
 {
     using namespace Serialization;
@@ -24,5 +24,6 @@ class TreeNodeSerializer
 public:
 
     static void serializeChildren(const TreeNode &parentItem, SerializedData &parent);
+    static void serializeChildren(const TreeNode &parentItem, SerializedDataWriter &writer);
     static void deserializeChildren(TreeNode &parentItem, const SerializedData &parent);
 };
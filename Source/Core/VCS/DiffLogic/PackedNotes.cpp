@@ -0,0 +1,587 @@
+/*
+    This file is part of Helio Workstation.
+
+    Helio is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Helio is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Helio. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "Common.h"
+#include "PackedNotes.h"
+#include "MidiSequence.h"
+#include "SerializationKeys.h"
+#include "XmlSerializer.h"
+#include "JsonSerializer.h"
+
+namespace VCS
+{
+
+//===----------------------------------------------------------------------===//
+// Varints
+//===----------------------------------------------------------------------===//
+
+static inline uint32 zigZagEncode(int32 value) noexcept
+{
+    return (uint32(value) << 1) ^ uint32(value >> 31);
+}
+
+static inline int32 zigZagDecode(uint32 value) noexcept
+{
+    return int32(value >> 1) ^ -int32(value & 1);
+}
+
+static void writeVarInt(MemoryOutputStream &out, uint32 value)
+{
+    while (value >= 0x80)
+    {
+        out.writeByte(char((value & 0x7f) | 0x80));
+        value >>= 7;
+    }
+
+    out.writeByte(char(value));
+}
+
+struct VarIntReader final
+{
+    VarIntReader(const uint8 *data, size_t size) noexcept :
+        ptr(data), end(data + size) {}
+
+    uint32 read() noexcept
+    {
+        uint32 result = 0;
+        for (int shift = 0; shift < 35; shift += 7)
+        {
+            if (this->ptr >= this->end)
+            {
+                this->failed = true;
+                return 0;
+            }
+
+            const auto byte = *this->ptr++;
+            result |= uint32(byte & 0x7f) << shift;
+
+            if ((byte & 0x80) == 0)
+            {
+                return result;
+            }
+        }
+
+        this->failed = true;
+        return 0;
+    }
+
+    const uint8 *ptr;
+    const uint8 *const end;
+    bool failed = false;
+};
+
+//===----------------------------------------------------------------------===//
+// Conversions
+//===----------------------------------------------------------------------===//
+
+PackedNotes::Record PackedNotes::createRecord(const Note &note) noexcept
+{
+    Record record;
+    record.id = note.getId();
+    record.key = note.getKey();
+    record.beat = int(note.getBeat() * Globals::ticksPerBeat);
+    record.length = int(note.getLength() * Globals::ticksPerBeat);
+    record.velocity = int(note.getVelocity() * Globals::velocitySaveResolution);
+    record.tuplet = note.getTuplet();
+    return record;
+}
+
+Note PackedNotes::createNote(int index) const noexcept
+{
+    const auto &record = this->records.getReference(index);
+
+    Note note;
+    note.id = record.id;
+    note.beat = float(record.beat) / Globals::ticksPerBeat;
+    note.key = record.key;
+    note.length = float(record.length) / Globals::ticksPerBeat;
+    note.velocity = jlimit(0.f, 1.f, float(record.velocity) / Globals::velocitySaveResolution);
+    note.tuplet = Note::Tuplet(record.tuplet);
+    return note;
+}
+
+void PackedNotes::sortById()
+{
+    // ids are compared as unsigned, so that the deltas between them are never negative
+    std::sort(this->records.begin(), this->records.end(),
+        [](const Record &a, const Record &b) { return uint32(a.id) < uint32(b.id); });
+}
+
+PackedNotes PackedNotes::fromSequence(const MidiSequence &sequence)
+{
+    PackedNotes result;
+    result.records.ensureStorageAllocated(sequence.size());
+
+    for (const auto *event : sequence)
+    {
+        jassert(event->isTypeOf(MidiEvent::Type::Note));
+        result.records.add(createRecord(*static_cast<const Note *>(event)));
+    }
+
+    result.sortById();
+    return result;
+}
+
+PackedNotes PackedNotes::fromDeltaData(const SerializedData &data)
+{
+    PackedNotes result;
+
+    if (!data.isValid())
+    {
+        return result;
+    }
+
+    if (data.hasProperty(Serialization::VCS::PianoSequenceDeltas::packedNotes))
+    {
+        const auto &packed = data.getProperty(Serialization::VCS::PianoSequenceDeltas::packedNotes);
+        if (const auto *block = packed.getBinaryData())
+        {
+            result.unpack(static_cast<const uint8 *>(block->getData()), block->getSize());
+        }
+        else
+        {
+            // json stores the binary data as a base64 string
+            MemoryBlock block;
+            if (block.fromBase64Encoding(packed.toString()))
+            {
+                result.unpack(static_cast<const uint8 *>(block.getData()), block.getSize());
+            }
+        }
+
+        return result;
+    }
+
+    result.records.ensureStorageAllocated(data.getNumChildren());
+    forEachChildWithType(data, e, Serialization::Midi::note)
+    {
+        Note note;
+        note.deserialize(e);
+        result.records.add(createRecord(note));
+    }
+
+    result.sortById();
+    return result;
+}
+
+SerializedData PackedNotes::toDeltaData(const Identifier &deltaType) const
+{
+    SerializedData tree(deltaType);
+    tree.setProperty(Serialization::VCS::PianoSequenceDeltas::packedNotes, var(this->pack()));
+    return tree;
+}
+
+SerializedData PackedNotes::toLegacyDeltaData(const Identifier &deltaType) const
+{
+    SerializedData tree(deltaType);
+
+    for (int i = 0; i < this->records.size(); ++i)
+    {
+        tree.appendChild(this->createNote(i).serialize());
+    }
+
+    return tree;
+}
+
+//===----------------------------------------------------------------------===//
+// Packing
+//===----------------------------------------------------------------------===//
+
+MemoryBlock PackedNotes::pack() const
+{
+    // most notes take 6-8 bytes this way
+    MemoryOutputStream out(this->records.size() * 8 + 8);
+
+    out.writeByte(char(PackedNotes::formatVersion));
+    writeVarInt(out, uint32(this->records.size()));
+
+    uint32 prevId = 0;
+    for (const auto &record : this->records)
+    {
+        writeVarInt(out, uint32(record.id) - prevId);
+        prevId = uint32(record.id);
+    }
+
+    int prevKey = 0;
+    for (const auto &record : this->records)
+    {
+        writeVarInt(out, zigZagEncode(record.key - prevKey));
+        prevKey = record.key;
+    }
+
+    int prevBeat = 0;
+    for (const auto &record : this->records)
+    {
+        writeVarInt(out, zigZagEncode(record.beat - prevBeat));
+        prevBeat = record.beat;
+    }
+
+    for (const auto &record : this->records)
+    {
+        writeVarInt(out, zigZagEncode(record.length));
+    }
+
+    for (const auto &record : this->records)
+    {
+        writeVarInt(out, zigZagEncode(record.velocity));
+    }
+
+    for (const auto &record : this->records)
+    {
+        writeVarInt(out, uint32(record.tuplet));
+    }
+
+    return out.getMemoryBlock();
+}
+
+bool PackedNotes::unpack(const uint8 *data, size_t size)
+{
+    this->records.clearQuick();
+
+    if (size == 0 || data[0] != PackedNotes::formatVersion)
+    {
+        jassertfalse;
+        return false;
+    }
+
+    VarIntReader reader(data + 1, size - 1);
+
+    const auto numRecords = int(reader.read());
+    if (reader.failed || size_t(numRecords) > size)
+    {
+        jassertfalse;
+        return false;
+    }
+
+    this->records.resize(numRecords);
+
+    uint32 prevId = 0;
+    for (auto &record : this->records)
+    {
+        prevId += reader.read();
+        record.id = MidiEvent::Id(prevId);
+    }
+
+    int prevKey = 0;
+    for (auto &record : this->records)
+    {
+        prevKey += zigZagDecode(reader.read());
+        record.key = prevKey;
+    }
+
+    int prevBeat = 0;
+    for (auto &record : this->records)
+    {
+        prevBeat += zigZagDecode(reader.read());
+        record.beat = prevBeat;
+    }
+
+    for (auto &record : this->records)
+    {
+        record.length = zigZagDecode(reader.read());
+    }
+
+    for (auto &record : this->records)
+    {
+        record.velocity = zigZagDecode(reader.read());
+    }
+
+    for (auto &record : this->records)
+    {
+        record.tuplet = int(reader.read());
+    }
+
+    if (reader.failed)
+    {
+        jassertfalse;
+        this->records.clearQuick();
+        return false;
+    }
+
+    return true;
+}
+
+//===----------------------------------------------------------------------===//
+// Merges and diffs
+//===----------------------------------------------------------------------===//
+
+// all of these walk both sorted sets at once
+
+static inline bool isIdLess(MidiEvent::Id a, MidiEvent::Id b) noexcept
+{
+    return uint32(a) < uint32(b);
+}
+
+PackedNotes PackedNotes::mergeAdded(const PackedNotes &state, const PackedNotes &changes)
+{
+    // adds all notes from changes, which are not in the state yet
+    PackedNotes result;
+    result.records.ensureStorageAllocated(state.size() + changes.size());
+
+    int i = 0, j = 0;
+    while (i < state.size() || j < changes.size())
+    {
+        if (j == changes.size() || (i < state.size() &&
+            isIdLess(state.records.getReference(i).id, changes.records.getReference(j).id)))
+        {
+            result.records.add(state.records.getReference(i++));
+        }
+        else if (i == state.size() ||
+            isIdLess(changes.records.getReference(j).id, state.records.getReference(i).id))
+        {
+            result.records.add(changes.records.getReference(j++));
+        }
+        else
+        {
+            result.records.add(state.records.getReference(i++));
+            j++;
+        }
+    }
+
+    return result;
+}
+
+PackedNotes PackedNotes::mergeRemoved(const PackedNotes &state, const PackedNotes &changes)
+{
+    // keeps all notes from state, which are not in the changes
+    PackedNotes result;
+    result.records.ensureStorageAllocated(state.size());
+
+    int j = 0;
+    for (const auto &record : state.records)
+    {
+        while (j < changes.size() && isIdLess(changes.records.getReference(j).id, record.id))
+        {
+            j++;
+        }
+
+        if (j == changes.size() || changes.records.getReference(j).id != record.id)
+        {
+            result.records.add(record);
+        }
+    }
+
+    return result;
+}
+
+PackedNotes PackedNotes::mergeChanged(const PackedNotes &state, const PackedNotes &changes)
+{
+    // replaces the notes in state with the ones from changes with the same ids
+    PackedNotes result;
+    result.records.ensureStorageAllocated(state.size());
+
+    int j = 0;
+    for (const auto &record : state.records)
+    {
+        while (j < changes.size() && isIdLess(changes.records.getReference(j).id, record.id))
+        {
+            j++;
+        }
+
+        const auto hasChanges = j < changes.size() && changes.records.getReference(j).id == record.id;
+        result.records.add(hasChanges ? changes.records.getReference(j) : record);
+    }
+
+    return result;
+}
+
+PackedNotes::Changes PackedNotes::findChanges(const PackedNotes &state, const PackedNotes &changes)
+{
+    Changes result;
+
+    int i = 0, j = 0;
+    while (i < state.size() || j < changes.size())
+    {
+        if (j == changes.size() || (i < state.size() &&
+            isIdLess(state.records.getReference(i).id, changes.records.getReference(j).id)))
+        {
+            result.removed.records.add(state.records.getReference(i++));
+        }
+        else if (i == state.size() ||
+            isIdLess(changes.records.getReference(j).id, state.records.getReference(i).id))
+        {
+            result.added.records.add(changes.records.getReference(j++));
+        }
+        else
+        {
+            const auto &changesRecord = changes.records.getReference(j++);
+            if (!state.records.getReference(i++).hasSameParameters(changesRecord))
+            {
+                result.changed.records.add(changesRecord);
+            }
+        }
+    }
+
+    return result;
+}
+
+
+//===----------------------------------------------------------------------===//
+// Tests
+//===----------------------------------------------------------------------===//
+
+#if JUCE_UNIT_TESTS
+
+class PackedNotesTests final : public UnitTest
+{
+public:
+    PackedNotesTests() : UnitTest("Packed notes tests", UnitTestCategories::helio) {}
+
+    // creates a delta with a node per note, as it used to be saved
+    static SerializedData createLegacyDeltaData(int numNotes, int idOffset, Random &random)
+    {
+        using namespace Serialization;
+        static const char idChars[] = "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz";
+
+        SerializedData tree(VCS::PianoSequenceDeltas::notesAdded);
+        for (int i = idOffset; i < idOffset + numNotes; ++i)
+        {
+            String id;
+            id << idChars[i % 62] << idChars[(i / 62) % 62] << idChars[(i / (62 * 62)) % 62];
+
+            SerializedData note(Midi::note);
+            note.setProperty(Midi::id, id);
+            note.setProperty(Midi::key, 24 + random.nextInt(72));
+            note.setProperty(Midi::timestamp, i * 4 + random.nextInt(4));
+            note.setProperty(Midi::length, 1 + random.nextInt(64));
+            note.setProperty(Midi::volume, random.nextInt(int(Globals::velocitySaveResolution) + 1));
+            if (random.nextInt(10) == 0)
+            {
+                note.setProperty(Midi::tuplet, 3);
+            }
+
+            tree.appendChild(note);
+        }
+
+        return tree;
+    }
+
+    static FlatHashMap<MidiEvent::Id, Note> readLegacyNotes(const SerializedData &data)
+    {
+        FlatHashMap<MidiEvent::Id, Note> result;
+        forEachChildWithType(data, e, Serialization::Midi::note)
+        {
+            Note note;
+            note.deserialize(e);
+            result[note.getId()] = note;
+        }
+
+        return result;
+    }
+
+    void expectSameNotes(const SerializedData &legacy, const PackedNotes &packed)
+    {
+        const auto legacyNotes = readLegacyNotes(legacy);
+        expectEquals(packed.size(), int(legacyNotes.size()));
+
+        for (int i = 0; i < packed.size(); ++i)
+        {
+            const auto note = packed.createNote(i);
+            const auto found = legacyNotes.find(note.getId());
+            expect(found != legacyNotes.end());
+            if (found != legacyNotes.end())
+            {
+                expectEquals(note.getKey(), found->second.getKey());
+                expectEquals(note.getBeat(), found->second.getBeat());
+                expectEquals(note.getLength(), found->second.getLength());
+                expectEquals(note.getVelocity(), found->second.getVelocity());
+                expectEquals(int(note.getTuplet()), int(found->second.getTuplet()));
+            }
+        }
+    }
+
+    static int64 getBinarySize(const SerializedData &data)
+    {
+        MemoryOutputStream out;
+        data.writeToStream(out);
+        return int64(out.getDataSize());
+    }
+
+    void runTest() override
+    {
+        using namespace Serialization::VCS;
+
+        Random random(42);
+        const auto legacy = createLegacyDeltaData(5000, 0, random);
+
+        beginTest("Packed notes are compatible with the legacy format");
+
+        const auto packed = PackedNotes::fromDeltaData(legacy);
+        expectSameNotes(legacy, packed);
+
+        const auto packedData = packed.toDeltaData(PianoSequenceDeltas::notesAdded);
+        expectSameNotes(legacy, PackedNotes::fromDeltaData(packedData));
+        expectSameNotes(packed.toLegacyDeltaData(PianoSequenceDeltas::notesAdded), packed);
+
+        // text formats only keep the base64 string
+        String xml, json;
+        XmlSerializer().saveToString(xml, packedData);
+        JsonSerializer().saveToString(json, packedData);
+        expectSameNotes(legacy, PackedNotes::fromDeltaData(XmlSerializer().loadFromString(xml)));
+        expectSameNotes(legacy, PackedNotes::fromDeltaData(JsonSerializer().loadFromString(json)));
+
+        String legacyXml;
+        XmlSerializer().saveToString(legacyXml, legacy);
+
+        const auto legacySize = getBinarySize(legacy);
+        const auto packedSize = getBinarySize(packedData);
+        expect(packedSize * 4 < legacySize);
+
+        logMessage("5000 notes take " + String(legacySize) + " bytes in the legacy binary format, " +
+            String(packedSize) + " packed; " + String(legacyXml.length()) + " vs " +
+            String(xml.length()) + " characters in xml");
+
+        beginTest("Packed notes merges and diffs");
+
+        // the changed notes have the same ids and other parameters
+        Random otherRandom(43);
+        const auto changedNotes = PackedNotes::fromDeltaData(createLegacyDeltaData(1000, 2000, otherRandom));
+        const auto addedNotes = PackedNotes::fromDeltaData(createLegacyDeltaData(1000, 5000, otherRandom));
+        const auto removedNotes = PackedNotes::fromDeltaData(createLegacyDeltaData(500, 4500, otherRandom));
+
+        const auto startMs = Time::getMillisecondCounterHiRes();
+        const auto withAdded = PackedNotes::mergeAdded(packed, addedNotes);
+        const auto withRemoved = PackedNotes::mergeRemoved(withAdded, removedNotes);
+        const auto target = PackedNotes::mergeChanged(withRemoved, changedNotes);
+        const auto mergeMs = Time::getMillisecondCounterHiRes() - startMs;
+
+        expectEquals(withAdded.size(), 6000);
+        expectEquals(withRemoved.size(), 5500);
+        expectEquals(target.size(), 5500);
+
+        const auto diff = PackedNotes::findChanges(packed, target);
+        expectEquals(diff.added.size(), 1000);
+        expectEquals(diff.removed.size(), 500);
+        expect(diff.changed.size() > 900 && diff.changed.size() <= 1000);
+
+        // applying the diff to the original state gives the target state
+        const auto restored = PackedNotes::mergeChanged(PackedNotes::mergeRemoved(
+            PackedNotes::mergeAdded(packed, diff.added), diff.removed), diff.changed);
+
+        expectSameNotes(target.toLegacyDeltaData(PianoSequenceDeltas::notesAdded), restored);
+        expect(restored.toDeltaData(PianoSequenceDeltas::notesAdded)
+            .isEquivalentTo(target.toDeltaData(PianoSequenceDeltas::notesAdded)));
+
+        logMessage("Merging added, removed and changed notes into 5000 notes: " + String(mergeMs, 2) + " ms");
+    }
+};
+
+static PackedNotesTests packedNotesTests;
+
+#endif
+
+}
@@ -0,0 +1,114 @@
+/*
+    This file is part of Helio Workstation.
+
+    Helio is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Helio is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Helio. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+
+#include "Note.h"
+
+class MidiSequence;
+
+namespace VCS
+{
+    // Note sets in the piano track deltas used to be stored as one node
+    // per note with named properties, so each merge had to deserialize
+    // and re-serialize all notes, and the revisions took lots of space.
+
+    // This is a compact form of such sets: notes are sorted by id,
+    // and written column by column as varints into a single binary property,
+    // with ids, keys and beats delta-encoded; merges and diffs work
+    // on the unpacked records, without creating any notes or trees.
+
+    class PackedNotes final
+    {
+    public:
+
+        // note parameters with the same precision as in Note::serialize()
+        struct Record final
+        {
+            MidiEvent::Id id = 0;
+            int key = 0;
+            int beat = 0; // in ticks
+            int length = 0; // in ticks
+            int velocity = 0; // in velocity save resolution steps
+            int tuplet = 1;
+
+            bool hasSameParameters(const Record &other) const noexcept
+            {
+                return this->key == other.key &&
+                    this->beat == other.beat &&
+                    this->length == other.length &&
+                    this->velocity == other.velocity &&
+                    this->tuplet == other.tuplet;
+            }
+        };
+
+        PackedNotes() = default;
+
+        static PackedNotes fromSequence(const MidiSequence &sequence);
+
+        // reads both the packed data and the legacy one, with a node per note
+        static PackedNotes fromDeltaData(const SerializedData &data);
+        SerializedData toDeltaData(const Identifier &deltaType) const;
+
+        // the same format as the legacy deltas, for compatibility checks
+        SerializedData toLegacyDeltaData(const Identifier &deltaType) const;
+
+        const Array<Record> &getRecords() const noexcept
+        {
+            return this->records;
+        }
+
+        int size() const noexcept
+        {
+            return this->records.size();
+        }
+
+        Note createNote(int index) const noexcept;
+
+        //===--------------------------------------------------------------===//
+        // Merges and diffs
+        //===--------------------------------------------------------------===//
+
+        static PackedNotes mergeAdded(const PackedNotes &state, const PackedNotes &changes);
+        static PackedNotes mergeRemoved(const PackedNotes &state, const PackedNotes &changes);
+        static PackedNotes mergeChanged(const PackedNotes &state, const PackedNotes &changes);
+
+        struct Changes final
+        {
+            PackedNotes added;
+            PackedNotes removed;
+            PackedNotes changed;
+        };
+
+        static Changes findChanges(const PackedNotes &state, const PackedNotes &changes);
+
+    private:
+
+        static Record createRecord(const Note &note) noexcept;
+        void sortById();
+
+        bool unpack(const uint8 *data, size_t size);
+        MemoryBlock pack() const;
+
+        Array<Record> records;
+
+        static constexpr uint8 formatVersion = 1;
+
+        JUCE_LEAK_DETECTOR(PackedNotes)
+    };
+} // namespace VCS
@@ -19,8 +19,7 @@
 #include "PianoTrackDiffLogic.h"
 #include "PianoTrackNode.h"
 #include "PatternDiffHelpers.h"
-#include "Note.h"
-#include "PianoSequence.h"
+#include "PackedNotes.h"
 
 namespace VCS
 {
@@ -39,13 +38,9 @@ static DeltaDiff createInstrumentDiff(const SerializedData &state, const Seriali
 
 static Array<DeltaDiff> createEventsDiffs(const SerializedData &state, const SerializedData &changes);
 
-static void deserializeLayerChanges(const SerializedData &state, const SerializedData &changes,
-    OwnedArray<Note> &stateNotes, OwnedArray<Note> &changesNotes);
+static DeltaDiff serializePianoTrackChanges(const PackedNotes &changes,
+    const String &description, const Identifier &deltaType);
 
-static DeltaDiff serializePianoTrackChanges(Array<const MidiEvent *> changes,
-    const String &description, int64 numChanges,  const Identifier &deltaType);
-
-static SerializedData serializePianoSequence(Array<const MidiEvent *> changes, const Identifier &tag);
 static bool checkIfDeltaIsNotesType(const Delta *delta);
 
 
@@ -272,7 +267,7 @@ Diff *PianoTrackDiffLogic::createMergedItem(const TrackedItem &initialState) con
             const bool foundMissingClip = !stateHasClips && PatternDiffHelpers::checkIfDeltaIsPatternType(targetDelta);
             if (foundMissingClip)
             {
-                SerializedData emptyClipDeltaData(serializePianoSequence({}, PatternDeltas::clipsAdded));
+                SerializedData emptyClipDeltaData(PatternDeltas::clipsAdded);
                 const bool incrementalMerge = clipsDeltaData.isValid();
 
                 if (targetDelta->hasType(PatternDeltas::clipsAdded))
@@ -324,106 +319,24 @@ SerializedData mergeInstrument(const SerializedData &state, const SerializedData
 SerializedData mergeNotesAdded(const SerializedData &state, const SerializedData &changes)
 {
     using namespace Serialization::VCS;
-
-    OwnedArray<Note> stateNotes;
-    OwnedArray<Note> changesNotes;
-    deserializeLayerChanges(state, changes, stateNotes, changesNotes);
-
-    Array<const MidiEvent *> result;
-
-    result.addArray(stateNotes);
-
-    // на всякий пожарный, ищем, нет ли в состоянии нот с теми же id, где нет - добавляем
-    FlatHashSet<MidiEvent::Id> stateIDs;
-    
-    for (int j = 0; j < stateNotes.size(); ++j)
-    {
-        const Note *stateNote = stateNotes.getUnchecked(j);
-        stateIDs.insert(stateNote->getId());
-    }
-
-    for (int i = 0; i < changesNotes.size(); ++i)
-    {
-        const Note *changesNote = changesNotes.getUnchecked(i);
-        const bool foundNoteInState = stateIDs.contains(changesNote->getId());
-
-        if (! foundNoteInState)
-        {
-            result.add(changesNote);
-        }
-    }
-
-    return serializePianoSequence(result, PianoSequenceDeltas::notesAdded);
+    return PackedNotes::mergeAdded(PackedNotes::fromDeltaData(state),
+        PackedNotes::fromDeltaData(changes)).toDeltaData(PianoSequenceDeltas::notesAdded);
 }
 
 SerializedData mergeNotesRemoved(const SerializedData &state, const SerializedData &changes)
 {
     using namespace Serialization::VCS;
-
-    OwnedArray<Note> stateNotes;
-    OwnedArray<Note> changesNotes;
-    deserializeLayerChanges(state, changes, stateNotes, changesNotes);
-
-    Array<const MidiEvent *> result;
-
-    // добавляем все ноты из состояния, которых нет в изменениях
-    FlatHashSet<MidiEvent::Id> changesIDs;
-
-    for (int j = 0; j < changesNotes.size(); ++j)
-    {
-        const Note *changesNote = changesNotes.getUnchecked(j);
-        changesIDs.insert(changesNote->getId());
-    }
-    
-    for (int i = 0; i < stateNotes.size(); ++i)
-    {
-        const Note *stateNote =stateNotes.getUnchecked(i);
-        const bool foundNoteInChanges = changesIDs.contains(stateNote->getId());
-        if (! foundNoteInChanges)
-        {
-            result.add(stateNote);
-        }
-    }
-
-    return serializePianoSequence(result, PianoSequenceDeltas::notesAdded);
+    return PackedNotes::mergeRemoved(PackedNotes::fromDeltaData(state),
+        PackedNotes::fromDeltaData(changes)).toDeltaData(PianoSequenceDeltas::notesAdded);
 }
 
 SerializedData mergeNotesChanged(const SerializedData &state, const SerializedData &changes)
 {
     using namespace Serialization::VCS;
-
-    OwnedArray<Note> stateNotes;
-    OwnedArray<Note> changesNotes;
-    deserializeLayerChanges(state, changes, stateNotes, changesNotes);
-
-    Array<const MidiEvent *> result;
-
-    result.addArray(stateNotes);
-
-    // снова ищем по id и заменяем
-    FlatHashMap<MidiEvent::Id, const Note *> changesIDs;
-    
-    for (int j = 0; j < changesNotes.size(); ++j)
-    {
-        const Note *changesNote = changesNotes.getUnchecked(j);
-        changesIDs[changesNote->getId()] = changesNote;
-    }
-
-    for (int i = 0; i < stateNotes.size(); ++i)
-    {
-        const auto *stateNote = stateNotes.getUnchecked(i);
-        if (changesIDs.contains(stateNote->getId()))
-        {
-            const auto *changesNote = changesIDs[stateNote->getId()];
-            result.removeAllInstancesOf(stateNote);
-            result.addIfNotAlreadyThere(changesNote);
-        }
-    }
-
-    return serializePianoSequence(result, PianoSequenceDeltas::notesAdded);
+    return PackedNotes::mergeChanged(PackedNotes::fromDeltaData(state),
+        PackedNotes::fromDeltaData(changes)).toDeltaData(PianoSequenceDeltas::notesAdded);
 }
 
-
 //===----------------------------------------------------------------------===//
 // Diff
 //===----------------------------------------------------------------------===//
@@ -463,158 +376,41 @@ Array<DeltaDiff> createEventsDiffs(const SerializedData &state, const Serialized
 {
     using namespace Serialization::VCS;
 
-    OwnedArray<Note> stateNotes;
-    OwnedArray<Note> changesNotes;
-
-    // вот здесь по уму надо десериализовать слои
-    // а для этого надо, чтоб в слоях не было ничего, кроме нот
-    // поэтому пока есть, как есть, и это не критично
-    deserializeLayerChanges(state, changes, stateNotes, changesNotes);
+    const auto diff = PackedNotes::findChanges(PackedNotes::fromDeltaData(state),
+        PackedNotes::fromDeltaData(changes));
 
     Array<DeltaDiff> res;
 
-    Array<const MidiEvent *> addedNotes;
-    Array<const MidiEvent *> removedNotes;
-    Array<const MidiEvent *> changedNotes;
-
-    // собственно, само сравнение
-    for (int i = 0; i < stateNotes.size(); ++i)
-    {
-        bool foundNoteInChanges = false;
-        const Note *stateNote(stateNotes.getUnchecked(i));
-
-        for (int j = 0; j < changesNotes.size(); ++j)
-        {
-            const Note *changesNote = changesNotes.getUnchecked(j);
-
-            // нота из состояния - существует в изменениях. добавляем запись changed, если нужно.
-            if (stateNote->getId() == changesNote->getId())
-            {
-                foundNoteInChanges = true;
-
-                const bool noteHasChanged =
-                    stateNote->getKey() != changesNote->getKey() ||
-                    stateNote->getBeat() != changesNote->getBeat() ||
-                    stateNote->getLength() != changesNote->getLength() ||
-                    stateNote->getVelocity() != changesNote->getVelocity() ||
-                    stateNote->getTuplet() != changesNote->getTuplet();
-
-                if (noteHasChanged)
-                {
-                    changedNotes.add(changesNote);
-                }
-
-                break;
-            }
-        }
-
-        // нота из состояния - в изменениях не найдена. добавляем запись removed.
-        if (! foundNoteInChanges)
-        {
-            removedNotes.add(stateNote);
-        }
-    }
-
-    // теперь ищем в изменениях ноты, которые отсутствуют в состоянии
-    for (int i = 0; i < changesNotes.size(); ++i)
-    {
-        bool foundNoteInState = false;
-        const Note *changesNote = changesNotes.getUnchecked(i);
-
-        for (int j = 0; j < stateNotes.size(); ++j)
-        {
-            const Note *stateNote(stateNotes.getUnchecked(j));
-
-            if (stateNote->getId() == changesNote->getId())
-            {
-                foundNoteInState = true;
-                break;
-            }
-        }
-
-        // и пишем ее в список добавленных
-        if (! foundNoteInState)
-        {
-            addedNotes.add(changesNote);
-        }
-    }
-
-    // сериализуем диффы, если таковые есть
-
-    if (addedNotes.size() > 0)
+    if (diff.added.size() > 0)
     {
-        res.add(serializePianoTrackChanges(addedNotes,
-            "added {x} notes",
-            addedNotes.size(),
-            PianoSequenceDeltas::notesAdded));
+        res.add(serializePianoTrackChanges(diff.added,
+            "added {x} notes", PianoSequenceDeltas::notesAdded));
     }
 
-    if (removedNotes.size() > 0)
+    if (diff.removed.size() > 0)
     {
-        res.add(serializePianoTrackChanges(removedNotes,
-            "removed {x} notes",
-            removedNotes.size(),
-            PianoSequenceDeltas::notesRemoved));
+        res.add(serializePianoTrackChanges(diff.removed,
+            "removed {x} notes", PianoSequenceDeltas::notesRemoved));
     }
 
-    if (changedNotes.size() > 0)
+    if (diff.changed.size() > 0)
     {
-        res.add(serializePianoTrackChanges(changedNotes,
-            "changed {x} notes",
-            changedNotes.size(),
-            PianoSequenceDeltas::notesChanged));
+        res.add(serializePianoTrackChanges(diff.changed,
+            "changed {x} notes", PianoSequenceDeltas::notesChanged));
     }
 
     return res;
 }
 
-
-void deserializeLayerChanges(const SerializedData &state, const SerializedData &changes,
-        OwnedArray<Note> &stateNotes, OwnedArray<Note> &changesNotes)
-{
-    if (state.isValid())
-    {
-        forEachChildWithType(state, e, Serialization::Midi::note)
-        {
-            auto *note = new Note();
-            note->deserialize(e);
-            stateNotes.addSorted(*note, note);
-        }
-    }
-
-    if (changes.isValid())
-    {
-        forEachChildWithType(changes, e, Serialization::Midi::note)
-        {
-            auto *note = new Note();
-            note->deserialize(e);
-            changesNotes.addSorted(*note, note);
-        }
-    }
-}
-
-DeltaDiff serializePianoTrackChanges(Array<const MidiEvent *> changes,
-    const String &description, int64 numChanges, const Identifier &deltaType)
+DeltaDiff serializePianoTrackChanges(const PackedNotes &changes,
+    const String &description, const Identifier &deltaType)
 {
     DeltaDiff changesFullDelta;
-    changesFullDelta.delta = make<Delta>(DeltaDescription(description, numChanges), deltaType);
-    changesFullDelta.deltaData = serializePianoSequence(changes, deltaType);
+    changesFullDelta.delta = make<Delta>(DeltaDescription(description, changes.size()), deltaType);
+    changesFullDelta.deltaData = changes.toDeltaData(deltaType);
     return changesFullDelta;
 }
 
-SerializedData serializePianoSequence(Array<const MidiEvent *> changes, const Identifier &tag)
-{
-    SerializedData tree(tag);
-
-    for (int i = 0; i < changes.size(); ++i)
-    {
-        const MidiEvent *event = changes.getUnchecked(i);
-        tree.appendChild(event->serialize());
-    }
-
-    return tree;
-}
-
 bool checkIfDeltaIsNotesType(const Delta *d)
 {
     using namespace Serialization::VCS;
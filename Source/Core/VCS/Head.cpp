@@ -18,6 +18,7 @@
 #include "Common.h"
 #include "Head.h"
 #include "Diff.h"
+#include "ProjectInfoDiffLogic.h"
 
 namespace VCS
 {
@@ -126,6 +127,12 @@ void Head::mergeStateWith(Revision::Ptr changes)
             jassertfalse;
         }
     }
+
+    if (this->state != nullptr)
+    {
+        const ScopedWriteLock lock(this->stateLock);
+        this->state->compactItems();
+    }
 }
 
 bool Head::moveTo(const Revision::Ptr revision)
@@ -135,12 +142,6 @@ bool Head::moveTo(const Revision::Ptr revision)
         this->stopThread(Head::diffRebuildThreadStopTimeoutMs);
     }
 
-    // first, reset the snapshot state
-    {
-        const ScopedWriteLock lock(this->stateLock);
-        this->state = make<Snapshot>();
-    }
-
     // a path from the root to current revision
     ReferenceCountedArray<Revision> treePath;
     Revision::Ptr currentRevision(revision);
@@ -150,9 +151,38 @@ bool Head::moveTo(const Revision::Ptr revision)
         currentRevision = currentRevision->getParent();
     }
 
-    // then move from the root back to target revision
+    Array<int> numItemsOnPath;
+    numItemsOnPath.ensureStorageAllocated(treePath.size());
     for (const auto *rev : treePath)
     {
+        numItemsOnPath.add(numItemsOnPath.getLast() + rev->getItems().size());
+    }
+
+    // find the closest valid keyframe to start from
+    int replayStartIndex = 0;
+    auto newState = make<Snapshot>();
+    for (int i = treePath.size(); --i >= 0;)
+    {
+        const auto found = this->keyframes.find(treePath.getUnchecked(i)->getUuid());
+        if (found != this->keyframes.end() &&
+            found->second->numItemsOnPath == numItemsOnPath.getUnchecked(i))
+        {
+            newState = make<Snapshot>(found->second->snapshot.get());
+            replayStartIndex = i + 1;
+            break;
+        }
+    }
+
+    // first, reset the snapshot state
+    {
+        const ScopedWriteLock lock(this->stateLock);
+        this->state = move(newState);
+    }
+
+    // then move from the keyframe (or the root) to target revision
+    for (int i = replayStartIndex; i < treePath.size(); ++i)
+    {
+        const auto *rev = treePath.getUnchecked(i);
         DBG("VCS head moved to " + rev->getUuid());
 
         // picking all deltas and applying them to current state
@@ -175,6 +205,16 @@ bool Head::moveTo(const Revision::Ptr revision)
                 jassertfalse;
             }
         }
+
+        if ((i + 1) % Head::keyframeInterval == 0)
+        {
+            this->addKeyframe(rev, numItemsOnPath.getUnchecked(i));
+        }
+    }
+
+    {
+        const ScopedWriteLock lock(this->stateLock);
+        this->state->compactItems();
     }
 
     this->headingAt = revision;
@@ -186,46 +226,59 @@ void Head::pointTo(const Revision::Ptr revision)
 {
     this->headingAt = revision;
     this->setDiffOutdated(true);
+
+    // the state is saved along with the project, so that
+    // the first move after loading won't need to replay the whole history
+    int numItemsOnPath = 0;
+    for (const auto *rev = revision.get(); rev != nullptr; rev = rev->getParent())
+    {
+        numItemsOnPath += rev->getItems().size();
+    }
+
+    this->addKeyframe(revision.get(), numItemsOnPath);
 }
 
+void Head::addKeyframe(const Revision *revision, int numItemsOnPath)
+{
+    auto keyframe = make<Keyframe>();
+    keyframe->snapshot = make<Snapshot>(this->state.get());
+    keyframe->snapshot->compactItems();
+    keyframe->numItemsOnPath = numItemsOnPath;
+    this->keyframes[revision->getUuid()] = move(keyframe);
+}
 
-bool Head::resetChangedItemToState(const RevisionItem::Ptr diffItem)
+Head::TrackedItemsIndex Head::indexTargetItems() const
+{
+    TrackedItemsIndex result;
+
+    for (int i = 0; i < this->targetVcsItemsSource.getNumTrackedItems(); ++i)
+    {
+        auto *item = this->targetVcsItemsSource.getTrackedItem(i);
+        result.emplace(item->getUuid(), item);
+    }
+
+    return result;
+}
+
+static TrackedItem *findTrackedItem(const FlatHashMap<Uuid, TrackedItem *, UuidHash> &items, const Uuid &uuid)
+{
+    const auto found = items.find(uuid);
+    return found != items.end() ? found->second : nullptr;
+}
+
+bool Head::resetChangedItemToState(const RevisionItem::Ptr diffItem, const TrackedItemsIndex &targetItems)
 {
     if (this->state == nullptr)
     { return false; }
 
-    // на входе - один из айтемов диффа
-    TrackedItem *sourceItem = nullptr;
-
+    // на входе - один из айтемов диффа,
     // ищем в собранном состоянии айтем с соответствующим уидом
-    for (int i = 0; i < this->state->getNumTrackedItems(); ++i)
-    {
-        auto *item = this->state->getTrackedItem(i);
-
-        if (item->getUuid() == diffItem->getUuid())
-        {
-            sourceItem = item;
-            break;
-        }
-    }
+    const RevisionItem::Ptr sourceItem = this->state->getItemWithUuid(diffItem->getUuid());
 
     // обработать тип - добавлено, удалено, изменено
     if (diffItem->getType() == RevisionItem::Type::Changed)
     {
-        TrackedItem *targetItem = nullptr;
-
-        // ищем в проекте айтем с соответствующим уидом
-        for (int i = 0; i < this->targetVcsItemsSource.getNumTrackedItems(); ++i)
-        {
-            auto *item = this->targetVcsItemsSource.getTrackedItem(i);
-
-            if (item->getUuid() == diffItem->getUuid())
-            {
-                targetItem = item;
-                break;
-            }
-        }
-
+        auto *targetItem = findTrackedItem(targetItems, diffItem->getUuid());
         if (targetItem != nullptr && sourceItem != nullptr)
         {
             targetItem->resetStateTo(*sourceItem);
@@ -234,21 +287,8 @@ bool Head::resetChangedItemToState(const RevisionItem::Ptr diffItem)
     }
     else if (diffItem->getType() == RevisionItem::Type::Added)
     {
-        TrackedItem *targetItem = nullptr;
-
         // снова ищем исходный с тем же уидом и вызываем deleteTrackedItem
-        for (int i = 0; i < this->targetVcsItemsSource.getNumTrackedItems(); ++i)
-        {
-            auto *item = this->targetVcsItemsSource.getTrackedItem(i);
-
-            if (item->getUuid() == diffItem->getUuid())
-            {
-                targetItem = item;
-                break;
-            }
-        }
-
-        if (targetItem)
+        if (auto *targetItem = findTrackedItem(targetItems, diffItem->getUuid()))
         {
             return this->targetVcsItemsSource.deleteTrackedItem(targetItem);
         }
@@ -293,10 +333,11 @@ void Head::checkout()
         }
     }
 
+    const auto targetItems = this->indexTargetItems();
     for (int i = 0; i < this->state->getNumTrackedItems(); ++i)
     {
         RevisionItem::Ptr stateItem = static_cast<RevisionItem *>(this->state->getTrackedItem(i));
-        this->checkoutItem(stateItem);
+        this->checkoutItem(stateItem, targetItems);
     }
 
     this->targetVcsItemsSource.onResetState();
@@ -311,18 +352,21 @@ void Head::cherryPick(const Array<Uuid> uuids)
 
     this->targetVcsItemsSource.onBeforeResetState();
 
+    FlatHashSet<Uuid, UuidHash> selectedUuids;
+    for (const auto &uuid : uuids)
+    {
+        selectedUuids.insert(uuid);
+    }
+
+    const auto targetItems = this->indexTargetItems();
     for (int i = 0; i < this->state->getNumTrackedItems(); ++i)
     {
         RevisionItem::Ptr stateItem = static_cast<RevisionItem *>(this->state->getTrackedItem(i));
 
         // если этот айтем состояния выбран юзером, то чекаут.
-        for (int j = 0; j < uuids.size(); ++j)
+        if (selectedUuids.contains(stateItem->getUuid()))
         {
-            if (stateItem->getUuid() == uuids.getUnchecked(j))
-            {
-                this->checkoutItem(stateItem);
-                break;
-            }
+            this->checkoutItem(stateItem, targetItems);
         }
     }
 
@@ -338,10 +382,11 @@ void Head::cherryPickAll()
 
     this->targetVcsItemsSource.onBeforeResetState();
 
+    const auto targetItems = this->indexTargetItems();
     for (int i = 0; i < this->state->getNumTrackedItems(); ++i)
     {
         RevisionItem::Ptr stateItem = static_cast<RevisionItem *>(this->state->getTrackedItem(i));
-        this->checkoutItem(stateItem);
+        this->checkoutItem(stateItem, targetItems);
     }
 
     this->targetVcsItemsSource.onResetState();
@@ -356,31 +401,21 @@ bool Head::resetChanges(const Array<RevisionItem::Ptr> &changes)
 
     this->targetVcsItemsSource.onBeforeResetState();
 
+    const auto targetItems = this->indexTargetItems();
     for (const auto &item : changes)
     {
-        this->resetChangedItemToState(item);
+        this->resetChangedItemToState(item, targetItems);
     }
 
     this->targetVcsItemsSource.onResetState();
     return true;
 }
 
-void Head::checkoutItem(RevisionItem::Ptr stateItem)
+void Head::checkoutItem(RevisionItem::Ptr stateItem, const TrackedItemsIndex &targetItems)
 {
-    // Changed и Added RevisionItem'ы нужно применять через resetStateTo
-    TrackedItem *targetItem = nullptr;
-    
+    // Changed и Added RevisionItem'ы нужно применять через resetStateTo,
     // ищем в проекте айтем с соответствующим уидом
-    for (int j = 0; j < this->targetVcsItemsSource.getNumTrackedItems(); ++j)
-    {
-        TrackedItem *item = this->targetVcsItemsSource.getTrackedItem(j);
-
-        if (item->getUuid() == stateItem->getUuid())
-        {
-            targetItem = item;
-            break;
-        }
-    }
+    auto *targetItem = findTrackedItem(targetItems, stateItem->getUuid());
 
     if (stateItem->getType() == RevisionItem::Type::Changed)
     {
@@ -477,11 +512,15 @@ void Head::deserialize(const SerializedData &data)
         snapshotItem->deserialize(stateElement);
         this->state->addItem(snapshotItem);
     }
+
+    const ScopedWriteLock lock(this->stateLock);
+    this->state->compactItems();
 }
 
 void Head::reset()
 {
     this->state = make<Snapshot>();
+    this->keyframes.clear();
     this->setDiffOutdated(true);
 }
 
@@ -515,6 +554,8 @@ void Head::run()
 
     const ScopedReadLock threadStateLock(this->stateLock);
 
+    const auto targetItems = this->indexTargetItems();
+
     for (int i = 0; i < this->state->getNumTrackedItems(); ++i)
     {
         if (this->threadShouldExit())
@@ -524,43 +565,28 @@ void Head::run()
             return;
         }
 
-        bool foundItemInTarget = false;
         const RevisionItem::Ptr stateItem = static_cast<RevisionItem *>(this->state->getTrackedItem(i));
 
         // will check `removed` records later
         if (stateItem->getType() == RevisionItem::Type::Removed) { continue; }
 
-        for (int j = 0; j < this->targetVcsItemsSource.getNumTrackedItems(); ++j)
-        {
-            if (this->threadShouldExit())
-            {
-                this->setRebuildingDiffMode(false);
-                this->sendChangeMessage();
-                return;
-            }
+        // i.e. LayerTreeItem
+        auto *targetItem = findTrackedItem(targetItems, stateItem->getUuid());
 
-            TrackedItem *targetItem = this->targetVcsItemsSource.getTrackedItem(j); // i.e. LayerTreeItem
+        // state item exists in project, adding `changed` record, if needed
+        if (targetItem != nullptr)
+        {
+            UniquePointer<Diff> itemDiff(targetItem->getDiffLogic()->createDiff(*stateItem));
 
-            // state item exists in project, adding `changed` record, if needed
-            if (stateItem->getUuid() == targetItem->getUuid())
+            if (itemDiff->hasAnyChanges())
             {
-                foundItemInTarget = true;
-
-                UniquePointer<Diff> itemDiff(targetItem->getDiffLogic()->createDiff(*stateItem));
-
-                if (itemDiff->hasAnyChanges())
-                {
-                    RevisionItem::Ptr revisionRecord(new RevisionItem(RevisionItem::Type::Changed, itemDiff.get()));
-                    const ScopedWriteLock itemDiffLock(this->diffLock);
-                    this->diff->addItem(revisionRecord);
-                }
-
-                break;
+                RevisionItem::Ptr revisionRecord(new RevisionItem(RevisionItem::Type::Changed, itemDiff.get()));
+                const ScopedWriteLock itemDiffLock(this->diffLock);
+                this->diff->addItem(revisionRecord);
             }
         }
-
         // state item was not found in project, adding `removed` record
-        if (! foundItemInTarget)
+        else
         {
             auto emptyDiff = make<Diff>(*stateItem);
             RevisionItem::Ptr revisionRecord(new RevisionItem(RevisionItem::Type::Removed, emptyDiff.get()));
@@ -579,21 +605,10 @@ void Head::run()
             return;
         }
 
-        bool foundItemInState = false;
         TrackedItem *targetItem = this->targetVcsItemsSource.getTrackedItem(i);
-
-        for (int j = 0; j < this->state->getNumTrackedItems(); ++j)
-        {
-            const RevisionItem::Ptr stateItem = static_cast<RevisionItem *>(this->state->getTrackedItem(j));
-
-            if (stateItem->getType() == RevisionItem::Type::Removed) { continue; }
-
-            if (stateItem->getUuid() == targetItem->getUuid())
-            {
-                foundItemInState = true;
-                break;
-            }
-        }
+        const auto stateItem = this->state->getItemWithUuid(targetItem->getUuid());
+        const bool foundItemInState = stateItem != nullptr &&
+            stateItem->getType() != RevisionItem::Type::Removed;
 
         // copy deltas from targetItem and add `added` record
         if (! foundItemInState)
@@ -626,39 +641,33 @@ void Head::rebuildDiffSynchronously()
     }
     
     const ScopedReadLock rebuildStateLock(this->stateLock);
+
+    const auto targetItems = this->indexTargetItems();
     
     for (int i = 0; i < this->state->getNumTrackedItems(); ++i)
     {
-        bool foundItemInTarget = false;
         const RevisionItem::Ptr stateItem = static_cast<RevisionItem *>(this->state->getTrackedItem(i));
         
         // will check `removed` records later
         if (stateItem->getType() == RevisionItem::Type::Removed) { continue; }
         
-        for (int j = 0; j < this->targetVcsItemsSource.getNumTrackedItems(); ++j)
+        // i.e. LayerTreeItem
+        auto *targetItem = findTrackedItem(targetItems, stateItem->getUuid());
+
+        // state item exists in project, adding `changed` record, if needed
+        if (targetItem != nullptr)
         {
-            TrackedItem *targetItem = this->targetVcsItemsSource.getTrackedItem(j); // i.e. LayerTreeItem
+            UniquePointer<Diff> itemDiff(targetItem->getDiffLogic()->createDiff(*stateItem));
             
-            // state item exists in project, adding `changed` record, if needed
-            if (stateItem->getUuid() == targetItem->getUuid())
+            if (itemDiff->hasAnyChanges())
             {
-                foundItemInTarget = true;
-                
-                UniquePointer<Diff> itemDiff(targetItem->getDiffLogic()->createDiff(*stateItem));
-                
-                if (itemDiff->hasAnyChanges())
-                {
-                    RevisionItem::Ptr revisionRecord(new RevisionItem(RevisionItem::Type::Changed, itemDiff.get()));
-                    const ScopedWriteLock lock(this->diffLock);
-                    this->diff->addItem(revisionRecord);
-                }
-                
-                break;
+                RevisionItem::Ptr revisionRecord(new RevisionItem(RevisionItem::Type::Changed, itemDiff.get()));
+                const ScopedWriteLock lock(this->diffLock);
+                this->diff->addItem(revisionRecord);
             }
         }
-        
         // state item was not found in project, adding `removed` record
-        if (! foundItemInTarget)
+        else
         {
             auto emptyDiff = make<Diff>(*stateItem);
             RevisionItem::Ptr revisionRecord(new RevisionItem(RevisionItem::Type::Removed, emptyDiff.get()));
@@ -670,21 +679,10 @@ void Head::rebuildDiffSynchronously()
     // search for project item that are missing (or deleted) in the state
     for (int i = 0; i < this->targetVcsItemsSource.getNumTrackedItems(); ++i)
     {
-        bool foundItemInState = false;
         TrackedItem *targetItem = this->targetVcsItemsSource.getTrackedItem(i);
-        
-        for (int j = 0; j < this->state->getNumTrackedItems(); ++j)
-        {
-            const RevisionItem::Ptr stateItem = static_cast<RevisionItem *>(this->state->getTrackedItem(j));
-            
-            if (stateItem->getType() == RevisionItem::Type::Removed) { continue; }
-            
-            if (stateItem->getUuid() == targetItem->getUuid())
-            {
-                foundItemInState = true;
-                break;
-            }
-        }
+        const auto stateItem = this->state->getItemWithUuid(targetItem->getUuid());
+        const bool foundItemInState = stateItem != nullptr &&
+            stateItem->getType() != RevisionItem::Type::Removed;
         
         // copy deltas from targetItem and add `added` record
         if (! foundItemInState)
@@ -700,4 +698,185 @@ void Head::rebuildDiffSynchronously()
     this->sendChangeMessage();
 }
 
+//===----------------------------------------------------------------------===//
+// Tests
+//===----------------------------------------------------------------------===//
+
+#if JUCE_UNIT_TESTS
+
+class HeadTests final : public UnitTest
+{
+public:
+    HeadTests() : UnitTest("VCS head tests", UnitTestCategories::helio) {}
+
+    // a tracked item with a single title delta, and a payload
+    // large enough for the merges to cost something
+    class TitleItem final : public TrackedItem
+    {
+    public:
+
+        TitleItem(const Uuid &id, const String &title) :
+            delta({}, Serialization::VCS::ProjectInfoDeltas::projectTitle),
+            data(Serialization::VCS::ProjectInfoDeltas::projectTitle),
+            logic(make<ProjectInfoDiffLogic>(*this))
+        {
+            this->vcsUuid = id;
+            this->data.setProperty(Serialization::VCS::delta, title);
+            for (int i = 0; i < 100; ++i)
+            {
+                SerializedData child(Serialization::VCS::delta);
+                child.setProperty(Serialization::VCS::delta, i);
+                this->data.appendChild(child);
+            }
+        }
+
+        int getNumDeltas() const override { return 1; }
+        Delta *getDelta(int index) const override { return const_cast<Delta *>(&this->delta); }
+        SerializedData getDeltaData(int deltaIndex) const override { return this->data; }
+        String getVCSName() const override { return "title"; }
+        DiffLogic *getDiffLogic() const override { return this->logic.get(); }
+        void resetStateTo(const TrackedItem &newState) override {}
+
+    private:
+
+        Delta delta;
+        SerializedData data;
+        UniquePointer<DiffLogic> logic;
+    };
+
+    static String getTitle(const Snapshot &state, const Uuid &id)
+    {
+        if (auto item = state.getItemWithUuid(id))
+        {
+            return item->getDeltaData(0).getProperty(Serialization::VCS::delta).toString();
+        }
+
+        return {};
+    }
+
+    void runTest() override
+    {
+        static constexpr auto numRevisions = 500;
+
+        const Uuid itemId;
+        ReferenceCountedArray<Revision> revisions;
+
+        Revision::Ptr root(new Revision());
+        TitleItem firstItem(itemId, "0");
+        root->addItem(new RevisionItem(RevisionItem::Type::Added, &firstItem));
+        revisions.add(root);
+
+        for (int i = 1; i < numRevisions; ++i)
+        {
+            Revision::Ptr revision(new Revision());
+            TitleItem changedItem(itemId, String(i));
+            revision->addItem(new RevisionItem(RevisionItem::Type::Changed, &changedItem));
+            revisions.getLast()->addChild(revision);
+            revisions.add(revision);
+        }
+
+        Snapshot project;
+        Head head(project);
+
+        beginTest("Head moves replay from the closest keyframe");
+
+        auto startMs = Time::getMillisecondCounterHiRes();
+        head.moveTo(revisions.getLast());
+        const auto firstMoveMs = Time::getMillisecondCounterHiRes() - startMs;
+
+        Random random(numRevisions);
+        startMs = Time::getMillisecondCounterHiRes();
+        for (int i = 0; i < 50; ++i)
+        {
+            const auto index = random.nextInt(numRevisions);
+            head.moveTo(revisions[index]);
+            expectEquals(getTitle(*head.state, itemId), String(index));
+        }
+
+        const auto keyframeMoveMs = (Time::getMillisecondCounterHiRes() - startMs) / 50.0;
+        logMessage("Moving head through " + String(numRevisions) + " revisions: " +
+            String(firstMoveMs, 2) + " ms, from a keyframe: " + String(keyframeMoveMs, 2) + " ms");
+
+        beginTest("Keyframes are invalidated when the revisions change");
+
+        // like quick amend: adding items to the already committed revision
+        const Uuid amendedItemId;
+        TitleItem amendedItem(amendedItemId, "amended");
+        revisions[100]->addItem(new RevisionItem(RevisionItem::Type::Added, &amendedItem));
+
+        head.moveTo(revisions[200]);
+        expectEquals(getTitle(*head.state, itemId), String(200));
+        expectEquals(getTitle(*head.state, amendedItemId), String("amended"));
+
+        head.moveTo(revisions[99]);
+        expectEquals(getTitle(*head.state, itemId), String(99));
+        expect(getTitle(*head.state, amendedItemId).isEmpty());
+
+        head.reset();
+        head.moveTo(revisions[100]);
+        expectEquals(getTitle(*head.state, itemId), String(100));
+        expectEquals(getTitle(*head.state, amendedItemId), String("amended"));
+
+        beginTest("Snapshot keeps a single item per uuid");
+
+        static constexpr auto numItems = 1000;
+
+        Snapshot snapshot;
+        Array<Uuid> ids;
+        OwnedArray<TitleItem> items;
+        for (int i = 0; i < numItems; ++i)
+        {
+            ids.add(Uuid());
+            items.add(new TitleItem(ids.getLast(), String(i)));
+            snapshot.addItem(new RevisionItem(RevisionItem::Type::Added, items.getLast()));
+        }
+
+        startMs = Time::getMillisecondCounterHiRes();
+        for (int i = 0; i < numItems; i += 2)
+        {
+            TitleItem changedItem(ids[i], "changed");
+            snapshot.mergeItem(new RevisionItem(RevisionItem::Type::Changed, &changedItem));
+        }
+
+        for (int i = 1; i < numItems; i += 4)
+        {
+            snapshot.removeItem(new RevisionItem(RevisionItem::Type::Removed, items[i]));
+        }
+
+        snapshot.compactItems();
+        const auto snapshotUpdateMs = Time::getMillisecondCounterHiRes() - startMs;
+
+        expectEquals(snapshot.getNumTrackedItems(), numItems);
+        for (int i = 0; i < numItems; ++i)
+        {
+            const auto item = snapshot.getItemWithUuid(ids[i]);
+            expect(item != nullptr);
+            expect(item->getType() == (i % 4 == 1 ?
+                RevisionItem::Type::Removed : RevisionItem::Type::Added));
+            expectEquals(getTitle(snapshot, ids[i]), i % 2 == 0 ? String("changed") : String(i));
+        }
+
+        // a removed item can be added back
+        snapshot.addItem(new RevisionItem(RevisionItem::Type::Added, items[1]));
+        snapshot.compactItems();
+        expectEquals(snapshot.getNumTrackedItems(), numItems);
+        expect(snapshot.getItemWithUuid(ids[1])->getType() == RevisionItem::Type::Added);
+        expect(snapshot.getItemWithUuid(Uuid()) == nullptr);
+
+        // the replaced items go to the end of the list, which has no gaps
+        expect(snapshot.getTrackedItem(numItems - 1)->getUuid() == ids[1]);
+        for (int i = 0; i < snapshot.getNumTrackedItems(); ++i)
+        {
+            expect(snapshot.getTrackedItem(i) != nullptr);
+        }
+
+        logMessage("Merging and removing " + String(numItems * 3 / 4) + " items in a snapshot of " +
+            String(numItems) + ": " + String(snapshotUpdateMs, 2) + " ms");
+    }
+};
+
+static HeadTests headTests;
+
+#endif
+
 }
@@ -50,7 +50,8 @@ namespace VCS
 
         void mergeStateWith(Revision::Ptr changes);
         bool moveTo(const Revision::Ptr revision); // rebuilds state index
-        void pointTo(const Revision::Ptr revision); // does not rebuild index
+        void pointTo(const Revision::Ptr revision); // does not rebuild index,
+        // assumes that the current state is the one of that revision, e.g. just loaded
 
         void checkout();
         void cherryPick(const Array<Uuid> uuids);
@@ -82,8 +83,14 @@ namespace VCS
         //===--------------------------------------------------------------===//
 
         void run() override;
-        void checkoutItem(RevisionItem::Ptr stateItem);
-        bool resetChangedItemToState(const RevisionItem::Ptr diffItem);
+
+        // the project's tracked items by uuid, so that matching them
+        // against the state doesn't need a nested loop for each item
+        using TrackedItemsIndex = FlatHashMap<Uuid, TrackedItem *, UuidHash>;
+        TrackedItemsIndex indexTargetItems() const;
+
+        void checkoutItem(RevisionItem::Ptr stateItem, const TrackedItemsIndex &targetItems);
+        bool resetChangedItemToState(const RevisionItem::Ptr diffItem, const TrackedItemsIndex &targetItems);
 
         static constexpr auto diffRebuildThreadStopTimeoutMs = 5000;
 
@@ -102,10 +109,32 @@ namespace VCS
         ReadWriteLock stateLock;
         UniquePointer<Snapshot> state;
 
+    private:
+
+        // moveTo() needs to replay all the revisions from the root,
+        // and each merge of a changed item is quite expensive, so the head
+        // keeps copies of the state at every Nth revision on the path,
+        // and starts replaying from the closest one
+        struct Keyframe final
+        {
+            UniquePointer<Snapshot> snapshot;
+            // revisions might get more items after the keyframe is taken
+            // (amended, or a shallow copy fetched), which invalidates it
+            int numItemsOnPath = 0;
+        };
+
+        void addKeyframe(const Revision *revision, int numItemsOnPath);
+
+        FlatHashMap<String, UniquePointer<Keyframe>, StringHash> keyframes;
+
+        static constexpr auto keyframeInterval = 32;
+
     private:
 
         TrackedItemsSource &targetVcsItemsSource;
 
+        friend class HeadTests;
+
         JUCE_LEAK_DETECTOR(Head)
 
     };
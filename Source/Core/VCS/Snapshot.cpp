@@ -23,40 +23,25 @@ namespace VCS
 {
 
 Snapshot::Snapshot(const Snapshot &other) :
-    items(other.items) {}
+    items(other.items),
+    index(other.index),
+    numEmptySlots(other.numEmptySlots) {}
 
 Snapshot::Snapshot(const Snapshot *other) :
-    items(other->items) {}
+    items(other->items),
+    index(other->index),
+    numEmptySlots(other->numEmptySlots) {}
 
 void Snapshot::addItem(RevisionItem::Ptr item)
 {
-    RevisionItem::Ptr ownItem = this->getItemWithSameUuid(item);
-
-    if (ownItem == nullptr)
-    {
-        this->items.addIfNotAlreadyThere(item);
-    }
-    else
-    {
-        // ситуация, когда в состоянии есть removed запись, которую нужно заменить на added
-        this->items.removeAllInstancesOf(ownItem);
-        this->items.addIfNotAlreadyThere(item);
-    }
+    // there might be a removed record, which needs to be replaced with the added one
+    this->replaceItem(item);
 }
 
 void Snapshot::removeItem(RevisionItem::Ptr item)
 {
-    this->items.removeAllInstancesOf(item);
-
-    RevisionItem::Ptr ownItem = this->getItemWithSameUuid(item);
-
-    if (ownItem != nullptr)
-    {
-        this->items.removeAllInstancesOf(ownItem);
-    }
-
-    // removed-запись
-    this->items.addIfNotAlreadyThere(item);
+    // the removed record replaces the item with the same uuid, if any
+    this->replaceItem(item);
 }
 
 void Snapshot::mergeItem(RevisionItem::Ptr newItem)
@@ -70,8 +55,7 @@ void Snapshot::mergeItem(RevisionItem::Ptr newItem)
         if (diff->hasAnyChanges())
         {
             RevisionItem::Ptr mergedItem(new RevisionItem(stateItem->getType(), diff.get()));
-            this->items.removeAllInstancesOf(stateItem);
-            this->items.add(mergedItem);
+            this->replaceItem(mergedItem);
         }
     }
     else
@@ -81,17 +65,67 @@ void Snapshot::mergeItem(RevisionItem::Ptr newItem)
     }
 }
 
+// keeps the same order as before the index was there:
+// the replacing item always goes to the end of the list,
+// and the item with the same uuid, if any, leaves an empty slot
+void Snapshot::replaceItem(RevisionItem::Ptr newItem)
+{
+    const auto found = this->index.find(newItem->getUuid());
+    if (found != this->index.end())
+    {
+        this->items.getReference(found->second) = nullptr;
+        this->numEmptySlots++;
+    }
+
+    this->index[newItem->getUuid()] = this->items.size();
+    this->items.add(newItem);
+}
+
+void Snapshot::compactItems()
+{
+    if (this->numEmptySlots == 0)
+    {
+        return;
+    }
+
+    int numItems = 0;
+    for (int i = 0; i < this->items.size(); ++i)
+    {
+        auto &item = this->items.getReference(i);
+        if (item == nullptr)
+        {
+            continue;
+        }
+
+        this->index[item->getUuid()] = numItems;
+        if (i != numItems)
+        {
+            this->items.getReference(numItems) = std::move(item);
+        }
+
+        numItems++;
+    }
+
+    this->items.removeRange(numItems, this->items.size() - numItems);
+    this->numEmptySlots = 0;
+}
+
 //===----------------------------------------------------------------------===//
 // TrackedItemsSource
 //===----------------------------------------------------------------------===//
 
+// the getters don't modify anything, since the readers
+// only hold the read lock, and may run concurrently
+
 int Snapshot::getNumTrackedItems() noexcept
 {
+    jassert(this->numEmptySlots == 0); // forgot to call compactItems()?
     return this->items.size();
 }
 
 TrackedItem *Snapshot::getTrackedItem(int index) noexcept
 {
+    jassert(this->numEmptySlots == 0);
     return this->items[index].get();
 }
 
@@ -102,12 +136,10 @@ RevisionItem::Ptr Snapshot::getItemWithSameUuid(RevisionItem::Ptr item) const
 
 RevisionItem::Ptr Snapshot::getItemWithUuid(const Uuid &uuid) const
 {
-    for (auto &item : this->items)
+    const auto found = this->index.find(uuid);
+    if (found != this->index.end())
     {
-        if (item->getUuid() == uuid)
-        {
-            return item;
-        }
+        return this->items.getUnchecked(found->second);
     }
 
     return nullptr;
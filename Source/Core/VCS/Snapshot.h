@@ -36,6 +36,11 @@ namespace VCS
         void removeItem(RevisionItem::Ptr item);
         void mergeItem(RevisionItem::Ptr item);
 
+        // removes the empty slots left by the replaced items,
+        // expected to be called after each batch of changes,
+        // under the same lock as the changes themselves
+        void compactItems();
+
         //===--------------------------------------------------------------===//
         // TrackedItemsSource
         //===--------------------------------------------------------------===//
@@ -54,8 +59,16 @@ namespace VCS
     private:
 
         RevisionItem::Ptr getItemWithSameUuid(RevisionItem::Ptr item) const;
+        void replaceItem(RevisionItem::Ptr newItem);
 
+        // the ordered list is what gets serialized and checked out,
+        // the index maps uuids to positions in that list, at most one per uuid;
+        // the replaced items leave empty slots in the list, so that
+        // replacing doesn't shift the whole list, and they are
+        // compacted in one pass after the whole batch of changes
         Array<RevisionItem::Ptr> items;
+        FlatHashMap<Uuid, int, UuidHash> index;
+        int numEmptySlots = 0;
 
         JUCE_LEAK_DETECTOR(Snapshot);
     };
@@ -47,6 +47,11 @@ namespace VCS
             tree.setProperty(Serialization::VCS::vcsItemId, this->getUuid().toString());
         }
 
+        void serializeVCSUuid(SerializedDataWriter &writer) const
+        {
+            writer.writeProperty(Serialization::VCS::vcsItemId, this->getUuid().toString());
+        }
+
         void deserializeVCSUuid(const SerializedData &tree)
         {
             this->vcsUuid = tree.getProperty(Serialization::VCS::vcsItemId, this->vcsUuid.toString());
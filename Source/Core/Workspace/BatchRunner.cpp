@@ -0,0 +1,267 @@
+/*
+    This file is part of Helio Workstation.
+
+    Helio is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Helio is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Helio. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "Common.h"
+#include "BatchRunner.h"
+#include "RootNode.h"
+#include "ProjectNode.h"
+#include "Workspace.h"
+#include "AudioCore.h"
+#include "Transport.h"
+
+#include <iostream>
+
+static void printToConsole(const String &message)
+{
+    std::cout << message << std::endl;
+}
+
+static File getFileFromArgument(const String &arg)
+{
+    return File::getCurrentWorkingDirectory().getChildFile(arg.unquoted());
+}
+
+BatchRunner::BatchRunner(const StringArray &commandLineArgs)
+{
+    jassert(BatchRunner::isBatchCommandLine(commandLineArgs));
+    BatchRunner::parseCommand(commandLineArgs[0], this->command);
+    this->inputFile = getFileFromArgument(commandLineArgs[1]);
+    this->outputFile = getFileFromArgument(commandLineArgs[2]);
+}
+
+BatchRunner::~BatchRunner()
+{
+    this->stopTimer();
+
+    if (this->project != nullptr)
+    {
+        this->project->getTransport().stopRender();
+        this->project = nullptr;
+    }
+}
+
+bool BatchRunner::parseCommand(const String &arg, Command &outCommand)
+{
+    if (arg == "--render")
+    {
+        outCommand = Command::Render;
+        return true;
+    }
+    else if (arg == "--export-midi")
+    {
+        outCommand = Command::ExportMidi;
+        return true;
+    }
+    else if (arg == "--import-midi")
+    {
+        outCommand = Command::ImportMidi;
+        return true;
+    }
+
+    return false;
+}
+
+bool BatchRunner::isBatchCommandLine(const StringArray &commandLineArgs)
+{
+    Command command;
+    return commandLineArgs.size() == 3 &&
+        BatchRunner::parseCommand(commandLineArgs[0], command);
+}
+
+void BatchRunner::start()
+{
+    this->totalStartMs = Time::getMillisecondCounterHiRes();
+
+    if (!this->inputFile.existsAsFile())
+    {
+        this->finish(false, "File not found: " + this->inputFile.getFullPathName());
+        return;
+    }
+
+    switch (this->command)
+    {
+    case Command::Render:
+        // the built-in instrument is initialized asynchronously,
+        // and the project's tracks can only be linked to it when it's ready:
+        this->state = State::WaitingForInstrument;
+        this->stateStartMs = Time::getMillisecondCounterHiRes();
+        this->startTimer(BatchRunner::pollIntervalMs);
+        break;
+    case Command::ExportMidi:
+        this->finish(this->runExportMidi(), {});
+        break;
+    case Command::ImportMidi:
+        this->finish(this->runImportMidi(), {});
+        break;
+    }
+}
+
+void BatchRunner::timerCallback()
+{
+    const auto nowMs = Time::getMillisecondCounterHiRes();
+
+    if (this->state == State::WaitingForInstrument)
+    {
+        if (App::Workspace().getAudioCore().getDefaultInstrument() != nullptr)
+        {
+            if (!this->runRender())
+            {
+                this->finish(false, "Failed to start rendering: " + this->outputFile.getFullPathName());
+            }
+        }
+        else if (nowMs - this->stateStartMs > BatchRunner::instrumentTimeoutMs)
+        {
+            this->finish(false, "Failed to initialize the built-in instrument");
+        }
+    }
+    else if (this->state == State::Rendering)
+    {
+        auto &transport = this->project->getTransport();
+        if (transport.isRendering())
+        {
+            const auto percents = int(transport.getRenderingPercentsComplete() * 100.f);
+            if (percents >= this->lastReportedPercents + 10)
+            {
+                this->lastReportedPercents = percents;
+                printToConsole("Rendering: " + String(percents) + "%");
+            }
+
+            return;
+        }
+
+        const auto renderMs = nowMs - this->stateStartMs;
+        const auto audioMs = transport.findTimeAt(transport.getProjectLastBeat());
+
+        String stats;
+        stats << "Rendered " << String(audioMs / 1000.0, 2) << " s of audio in "
+              << String(renderMs / 1000.0, 2) << " s";
+
+        if (renderMs > 0.0)
+        {
+            stats << " (" << String(audioMs / renderMs, 2) << "x realtime)";
+        }
+
+        this->finish(this->outputFile.existsAsFile(), stats);
+    }
+}
+
+bool BatchRunner::loadProject(const File &file)
+{
+    const auto startMs = Time::getMillisecondCounterHiRes();
+
+    this->project = make<ProjectNode>(file);
+    if (!this->project->getDocument()->load(file))
+    {
+        printToConsole("Failed to load the project: " + file.getFullPathName());
+        return false;
+    }
+
+    this->loadTimeMs = Time::getMillisecondCounterHiRes() - startMs;
+    printToConsole("Loaded " + file.getFileName() + " in " + String(this->loadTimeMs, 1) + " ms");
+    return true;
+}
+
+bool BatchRunner::runRender()
+{
+    this->stopTimer();
+
+    const auto extension = this->outputFile.getFileExtension().toLowerCase();
+    const auto format = extension == ".wav" ? RenderFormat::WAV : RenderFormat::FLAC;
+
+    if (!this->loadProject(this->inputFile))
+    {
+        return false;
+    }
+
+    if (!this->project->getTransport().startRender(URL(this->outputFile), format))
+    {
+        return false;
+    }
+
+    this->state = State::Rendering;
+    this->stateStartMs = Time::getMillisecondCounterHiRes();
+    this->startTimer(BatchRunner::pollIntervalMs);
+    return true;
+}
+
+bool BatchRunner::runExportMidi()
+{
+    if (!this->loadProject(this->inputFile))
+    {
+        return false;
+    }
+
+    const auto startMs = Time::getMillisecondCounterHiRes();
+
+    this->outputFile.deleteFile();
+    FileOutputStream out(this->outputFile);
+    if (out.failedToOpen())
+    {
+        printToConsole("Failed to write: " + this->outputFile.getFullPathName());
+        return false;
+    }
+
+    this->project->exportMidi(out);
+    out.flush();
+
+    printToConsole("Exported " + this->outputFile.getFileName() + " (" +
+        File::descriptionOfSizeInBytes(out.getPosition()) + ") in " +
+        String(Time::getMillisecondCounterHiRes() - startMs, 1) + " ms");
+
+    return out.getStatus().wasOk();
+}
+
+bool BatchRunner::runImportMidi()
+{
+    FileInputStream in(this->inputFile);
+    if (in.failedToOpen())
+    {
+        printToConsole("Failed to read: " + this->inputFile.getFullPathName());
+        return false;
+    }
+
+    const auto startMs = Time::getMillisecondCounterHiRes();
+
+    // the new project's document is the output file
+    this->project = make<ProjectNode>(this->outputFile);
+    RootNode::addAllEssentialProjectNodes(this->project.get());
+    this->project->importMidi(in);
+
+    printToConsole("Imported " + this->inputFile.getFileName() + " (" +
+        String(this->project->getTracks().size()) + " tracks) in " +
+        String(Time::getMillisecondCounterHiRes() - startMs, 1) + " ms");
+
+    this->project->getDocument()->save();
+    return this->outputFile.existsAsFile();
+}
+
+void BatchRunner::finish(bool succeeded, const String &message)
+{
+    this->stopTimer();
+    this->state = State::Idle;
+
+    if (message.isNotEmpty())
+    {
+        printToConsole(message);
+    }
+
+    printToConsole(String(succeeded ? "Done" : "Failed") + " in " +
+        String((Time::getMillisecondCounterHiRes() - this->totalStartMs) / 1000.0, 2) + " s");
+
+    JUCEApplicationBase::getInstance()->setApplicationReturnValue(succeeded ? 0 : 1);
+    JUCEApplicationBase::quit();
+}
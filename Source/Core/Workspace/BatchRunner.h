@@ -0,0 +1,82 @@
+/*
+    This file is part of Helio Workstation.
+
+    Helio is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Helio is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Helio. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+class ProjectNode;
+
+// Runs one command line job without the UI, prints the timing stats and quits:
+//   helio --render project.helio output.flac (or .wav)
+//   helio --export-midi project.helio output.mid
+//   helio --import-midi input.mid project.helio
+// The exit code is 0 on success, and 1 otherwise.
+
+class BatchRunner final : private Timer
+{
+public:
+
+    explicit BatchRunner(const StringArray &commandLineArgs);
+    ~BatchRunner() override;
+
+    static bool isBatchCommandLine(const StringArray &commandLineArgs);
+
+    void start();
+
+private:
+
+    enum class Command : int8
+    {
+        Render,
+        ExportMidi,
+        ImportMidi
+    };
+
+    enum class State : int8
+    {
+        Idle,
+        WaitingForInstrument,
+        Rendering
+    };
+
+    static bool parseCommand(const String &arg, Command &outCommand);
+
+    void timerCallback() override;
+
+    bool loadProject(const File &file);
+    bool runRender();
+    bool runExportMidi();
+    bool runImportMidi();
+
+    void finish(bool succeeded, const String &message);
+
+    Command command = Command::Render;
+    File inputFile;
+    File outputFile;
+
+    State state = State::Idle;
+    double stateStartMs = 0.0;
+    double totalStartMs = 0.0;
+    double loadTimeMs = 0.0;
+    int lastReportedPercents = 0;
+
+    UniquePointer<ProjectNode> project;
+
+    static constexpr auto pollIntervalMs = 50;
+    static constexpr auto instrumentTimeoutMs = 10000;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(BatchRunner)
+};
@@ -58,6 +58,17 @@ void Workspace::init()
     }
 }
 
+// The command line batch mode only needs the audio core with the built-in
+// instrument: it doesn't load the user's workspace, doesn't create the tree
+// and is never marked as initialized, so that nothing gets autosaved
+void Workspace::initHeadless()
+{
+    jassert(!this->wasInitialized);
+    this->audioCore = make<AudioCore>();
+    this->pluginManager = make<PluginScanner>();
+    this->audioCore->initDefaultInstrument();
+}
+
 bool Workspace::isInitialized() const noexcept
 {
     return this->wasInitialized;
@@ -281,6 +292,11 @@ void Workspace::unloadProject(const String &projectId, bool deleteLocally, bool
 
 Array<ProjectNode *> Workspace::getLoadedProjects() const
 {
+    if (this->treeRoot == nullptr)
+    {
+        return {}; // headless
+    }
+
     return this->treeRoot->findChildrenOfType<ProjectNode>();
 }
 
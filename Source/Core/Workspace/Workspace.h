@@ -36,6 +36,7 @@ public:
     ~Workspace() override;
 
     void init();
+    void initHeadless();
     void shutdown();
     bool isInitialized() const noexcept;
     void stopPlaybackForAllProjects(); // on app suspend / shutdown
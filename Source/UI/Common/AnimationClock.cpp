@@ -0,0 +1,118 @@
+/*
+    This file is part of Helio Workstation.
+
+    Helio is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Helio is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Helio. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "Common.h"
+#include "AnimationClock.h"
+
+AnimationClock::~AnimationClock()
+{
+    this->stopTimer();
+}
+
+void AnimationClock::addListener(Listener *listener, Priority priority)
+{
+    jassert(MessageManager::getInstance()->currentThreadHasLockedMessageManager());
+
+    this->removeListener(listener); // in case it wants to change the priority
+    this->listeners[int(priority)].add(listener);
+    this->updateTimerState();
+}
+
+void AnimationClock::removeListener(Listener *listener)
+{
+    jassert(MessageManager::getInstance()->currentThreadHasLockedMessageManager());
+
+    for (auto &list : this->listeners)
+    {
+        list.remove(listener);
+    }
+
+    this->updateTimerState();
+}
+
+void AnimationClock::setSuspended(bool shouldBeSuspended)
+{
+    this->isSuspended = shouldBeSuspended;
+    this->updateTimerState();
+}
+
+void AnimationClock::updateTimerState()
+{
+    // while suspended, only the low priority listeners are updated,
+    // but there's no reason to wake up more often than they need:
+    const auto lowPriority = int(Priority::Low);
+    const auto needsFrames = this->isSuspended ?
+        !this->listeners[lowPriority].isEmpty() :
+        std::any_of(std::begin(this->listeners), std::end(this->listeners),
+            [](const ListenerList<Listener> &list) { return !list.isEmpty(); });
+
+    const auto frameRate = this->isSuspended ?
+        AnimationClock::framesPerSecond / (1 << lowPriority) :
+        AnimationClock::framesPerSecond;
+
+    if (!needsFrames)
+    {
+        this->stopTimer();
+    }
+    else if (!this->isTimerRunning() ||
+        this->getTimerInterval() != 1000 / frameRate)
+    {
+        this->startTimerHz(frameRate);
+    }
+}
+
+void AnimationClock::timerCallback()
+{
+    // all listeners get the same frame time, so that
+    // the playheads in different views never go out of sync
+    const auto timeMs = Time::getMillisecondCounterHiRes();
+
+    this->frameNumber++;
+
+    for (int i = 0; i < AnimationClock::numPriorities; ++i)
+    {
+        if (this->isSuspended)
+        {
+            // nothing to see, only the non-visual updates are running
+            this->pendingUpdates[i] = (i == int(Priority::Low));
+        }
+        else
+        {
+            const bool isDue = (this->frameNumber % (1 << i)) == 0;
+            this->pendingUpdates[i] = this->pendingUpdates[i] || isDue;
+        }
+    }
+
+    for (int i = 0; i < AnimationClock::numPriorities; ++i)
+    {
+        if (!this->pendingUpdates[i])
+        {
+            continue;
+        }
+
+        // animations are never postponed, and the non-visual updates
+        // shouldn't be either, but the rest can wait for a frame or two
+        const auto elapsedMs = Time::getMillisecondCounterHiRes() - timeMs;
+        if (i == int(Priority::Normal) && elapsedMs > AnimationClock::frameBudgetMs)
+        {
+            continue;
+        }
+
+        this->pendingUpdates[i] = false;
+        this->listeners[i].call(&Listener::onAnimationFrame, timeMs);
+    }
+}
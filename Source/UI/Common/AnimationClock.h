@@ -0,0 +1,78 @@
+/*
+    This file is part of Helio Workstation.
+
+    Helio is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Helio is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Helio. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+// A single app-wide clock for everything that needs to be updated periodically
+// on the message thread, e.g. playheads, smooth scrolling, audio monitors,
+// note previews, or the lengths of the notes being recorded:
+// instead of each of them running its own timer and waking up
+// the message thread on its own schedule, they all get updated
+// within the same callback, so the resulting repaints get coalesced.
+
+// The clock only runs while there's someone listening, so it costs nothing
+// while the transport is stopped, and the listeners are expected to unsubscribe
+// as soon as they're idle; while the app is minimized or sent to background,
+// the clock skips all visual updates and only keeps the low priority ones.
+
+class AnimationClock final : private Timer
+{
+public:
+
+    AnimationClock() = default;
+    ~AnimationClock() override;
+
+    enum class Priority : int8
+    {
+        Animation = 0,  // every frame, e.g. playheads and scrolling
+        Normal = 1,     // every 2nd frame, e.g. audio monitors
+        Low = 2         // every 4th frame, non-visual stuff only
+    };
+
+    class Listener
+    {
+    public:
+        virtual ~Listener() = default;
+        virtual void onAnimationFrame(double timeMs) = 0;
+    };
+
+    // message thread only:
+    void addListener(Listener *listener, Priority priority = Priority::Animation);
+    void removeListener(Listener *listener);
+
+    void setSuspended(bool shouldBeSuspended);
+
+    static constexpr auto framesPerSecond = 60;
+
+private:
+
+    void timerCallback() override;
+    void updateTimerState();
+
+    static constexpr auto numPriorities = 3;
+    ListenerList<Listener> listeners[AnimationClock::numPriorities];
+
+    // lower priorities may get postponed to the next frame,
+    // if the higher ones have already used up the frame budget:
+    bool pendingUpdates[AnimationClock::numPriorities] = {};
+    static constexpr auto frameBudgetMs = 8.0;
+
+    uint32 frameNumber = 0;
+    bool isSuspended = false;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(AnimationClock)
+};
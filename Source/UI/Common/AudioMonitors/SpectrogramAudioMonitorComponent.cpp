@@ -32,8 +32,7 @@ static const float kPeakSpectrumFrequencies[] =
 };
 
 SpectrogramAudioMonitorComponent::SpectrogramAudioMonitorComponent(WeakReference<AudioMonitor> monitor)
-    : Thread("GenericAudioMonitor"),
-    colour(findDefaultColour(ColourIDs::AudioMonitor::foreground)),
+    : colour(findDefaultColour(ColourIDs::AudioMonitor::foreground)),
     audioMonitor(monitor)
 {
     // (true, false) will enable switching rendering modes on click
@@ -48,10 +47,7 @@ SpectrogramAudioMonitorComponent::SpectrogramAudioMonitorComponent(WeakReference
     this->lPeakBand = make<SpectrumBand>();
     this->rPeakBand = make<SpectrumBand>();
 
-    if (this->audioMonitor != nullptr)
-    {
-        this->startThread(5);
-    }
+    this->updateAnimationState();
 }
 
 void SpectrogramAudioMonitorComponent::setTargetAnalyzer(WeakReference<AudioMonitor> monitor)
@@ -59,41 +55,68 @@ void SpectrogramAudioMonitorComponent::setTargetAnalyzer(WeakReference<AudioMoni
     if (monitor != nullptr)
     {
         this->audioMonitor = monitor;
-        this->startThread(5);
+        this->updateAnimationState();
     }
 }
 
 SpectrogramAudioMonitorComponent::~SpectrogramAudioMonitorComponent()
-{ 
-    this->stopThread(1000);
+{
+    if (this->isAnimating)
+    {
+        App::AnimationClock().removeListener(this);
+    }
 }
 
-void SpectrogramAudioMonitorComponent::run()
+void SpectrogramAudioMonitorComponent::visibilityChanged()
 {
-    while (! this->threadShouldExit())
-    {
-        Thread::sleep(jlimit(10, 100, 35 - this->skewTime));
-        const double b = Time::getMillisecondCounterHiRes();
+    this->updateAnimationState();
+}
 
-        if (this->isVisible())
-        {
-            for (int i = 0; i < SpectrogramAudioMonitorComponent::numBands; ++i)
-            {
-                this->lPeak = this->audioMonitor->getPeak(0);
-                this->rPeak = this->audioMonitor->getPeak(1);
-                this->values[i] = this->audioMonitor->getInterpolatedSpectrumAtFrequency(kPeakSpectrumFrequencies[i]);
-            }
-
-            this->triggerAsyncUpdate();
-        }
+void SpectrogramAudioMonitorComponent::updateAnimationState()
+{
+    const bool shouldAnimate = this->audioMonitor != nullptr && this->isVisible();
+    if (shouldAnimate == this->isAnimating)
+    {
+        return;
+    }
 
-        const double a = Time::getMillisecondCounterHiRes();
-        this->skewTime = int(a - b);
+    this->isAnimating = shouldAnimate;
+    if (shouldAnimate)
+    {
+        App::AnimationClock().addListener(this, AnimationClock::Priority::Normal);
+    }
+    else
+    {
+        App::AnimationClock().removeListener(this);
     }
 }
 
-void SpectrogramAudioMonitorComponent::handleAsyncUpdate()
+void SpectrogramAudioMonitorComponent::onAnimationFrame(double timeMs)
 {
+    if (this->audioMonitor == nullptr)
+    {
+        return;
+    }
+
+    this->lPeak = this->audioMonitor->getPeak(0);
+    this->rPeak = this->audioMonitor->getPeak(1);
+
+    bool hasSignal = this->lPeak > 0.f || this->rPeak > 0.f;
+    for (int i = 0; i < SpectrogramAudioMonitorComponent::numBands; ++i)
+    {
+        this->values[i] = this->audioMonitor->getInterpolatedSpectrumAtFrequency(kPeakSpectrumFrequencies[i]);
+        hasSignal = hasSignal || this->values[i] > 0.f;
+    }
+
+    if (hasSignal)
+    {
+        this->lastSignalTimeMs = timeMs;
+    }
+    else if (timeMs - this->lastSignalTimeMs > double(SpectrumBand::peakFadeMs))
+    {
+        return;
+    }
+
     this->repaint();
 }
 
@@ -117,8 +140,8 @@ void SpectrogramAudioMonitorComponent::paint(Graphics &g)
     const float h = float(this->getHeight());
     const uint32 timeNow = Time::getMillisecondCounter();
 
-    this->lPeakBand->processSignal(this->lPeak.get(), h, timeNow);
-    this->rPeakBand->processSignal(this->rPeak.get(), h, timeNow);
+    this->lPeakBand->processSignal(this->lPeak, h, timeNow);
+    this->rPeakBand->processSignal(this->rPeak, h, timeNow);
 
     // Volume indicators:
     // TODO pretty up their look and add yellow/red colors for clipped signal
@@ -147,7 +170,7 @@ void SpectrogramAudioMonitorComponent::paint(Graphics &g)
 
     for (int i = 0; i < SpectrogramAudioMonitorComponent::numBands; ++i)
     {
-        this->bands[i]->processSignal(this->values[i].get(), h, timeNow);
+        this->bands[i]->processSignal(this->values[i], h, timeNow);
     }
 
     g.setColour(this->colour.withAlpha(0.35f));
@@ -18,9 +18,10 @@
 #pragma once
 
 #include "AudioMonitor.h"
+#include "AnimationClock.h"
 
 class SpectrogramAudioMonitorComponent final :
-    public Component, private Thread, private AsyncUpdater
+    public Component, private AnimationClock::Listener
 {
 public:
 
@@ -31,6 +32,7 @@ public:
         
     void resized() override;
     void paint(Graphics &g) override;
+    void visibilityChanged() override;
 
 private:
     
@@ -60,9 +62,15 @@ private:
     
 private:
     
-    void run() override;
-    void handleAsyncUpdate() override;
-    
+    void onAnimationFrame(double timeMs) override;
+
+    void updateAnimationState();
+    bool isAnimating = false;
+
+    // stop repainting when there's only silence
+    // and all the bands and peaks have faded out:
+    double lastSignalTimeMs = 0.0;
+
     const Colour colour;
 
     WeakReference<AudioMonitor> audioMonitor;
@@ -72,12 +80,10 @@ private:
     UniquePointer<SpectrumBand> rPeakBand;
 
     static constexpr auto numBands = 11;
-    Atomic<float> values[SpectrogramAudioMonitorComponent::numBands];
-
-    Atomic<float> lPeak;
-    Atomic<float> rPeak;
+    float values[SpectrogramAudioMonitorComponent::numBands] = {};
 
-    int skewTime = 0;
+    float lPeak = 0.f;
+    float rPeak = 0.f;
     
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SpectrogramAudioMonitorComponent);
 };
@@ -22,22 +22,21 @@
 #include "ColourIDs.h"
 
 WaveformAudioMonitorComponent::WaveformAudioMonitorComponent(WeakReference<AudioMonitor> targetAnalyzer) :
-    Thread("WaveformAudioMonitor"),
     colour(findDefaultColour(ColourIDs::AudioMonitor::foreground)),
     audioMonitor(targetAnalyzer)
 {
     this->setInterceptsMouseClicks(false, false);
     this->setPaintingIsUnclipped(true);
 
-    if (this->audioMonitor != nullptr)
-    {
-        this->startThread(6);
-    }
+    this->updateAnimationState();
 }
 
 WaveformAudioMonitorComponent::~WaveformAudioMonitorComponent()
 {
-    this->stopThread(1000);
+    if (this->isAnimating)
+    {
+        App::AnimationClock().removeListener(this);
+    }
 }
 
 void WaveformAudioMonitorComponent::setTargetAnalyzer(WeakReference<AudioMonitor> targetAnalyzer)
@@ -45,46 +44,70 @@ void WaveformAudioMonitorComponent::setTargetAnalyzer(WeakReference<AudioMonitor
     if (targetAnalyzer != nullptr)
     {
         this->audioMonitor = targetAnalyzer;
-        this->startThread(6);
+        this->updateAnimationState();
     }
 }
 
-void WaveformAudioMonitorComponent::run()
+void WaveformAudioMonitorComponent::visibilityChanged()
+{
+    this->updateAnimationState();
+}
+
+void WaveformAudioMonitorComponent::updateAnimationState()
 {
-    while (! this->threadShouldExit())
+    const bool shouldAnimate = this->audioMonitor != nullptr && this->isVisible();
+    if (shouldAnimate == this->isAnimating)
     {
-        Thread::sleep(jlimit(10, 100, 35 - this->skewTime));
-        const double b = Time::getMillisecondCounterHiRes();
-
-        // Shift buffers:
-        for (int i = 0; i < WaveformAudioMonitorComponent::bufferSize - 1; ++i)
-        {
-            this->lPeakBuffer[i] = this->lPeakBuffer[i + 1].get();
-            this->rPeakBuffer[i] = this->rPeakBuffer[i + 1].get();
-            this->lRmsBuffer[i] = this->lRmsBuffer[i + 1].get();
-            this->rRmsBuffer[i] = this->rRmsBuffer[i + 1].get();
-        }
-
-        const int i = WaveformAudioMonitorComponent::bufferSize - 1;
-
-        // Push next values:
-        this->lPeakBuffer[i] = this->audioMonitor->getPeak(0);
-        this->rPeakBuffer[i] = this->audioMonitor->getPeak(1);
-        this->lRmsBuffer[i] = this->audioMonitor->getRootMeanSquare(0);
-        this->rRmsBuffer[i] = this->audioMonitor->getRootMeanSquare(1);
-
-        if (this->isVisible())
-        {
-            this->triggerAsyncUpdate();
-        }
-
-        const double a = Time::getMillisecondCounterHiRes();
-        this->skewTime = int(a - b);
+        return;
+    }
+
+    this->isAnimating = shouldAnimate;
+    if (shouldAnimate)
+    {
+        App::AnimationClock().addListener(this, AnimationClock::Priority::Normal);
+    }
+    else
+    {
+        App::AnimationClock().removeListener(this);
     }
 }
 
-void WaveformAudioMonitorComponent::handleAsyncUpdate()
+void WaveformAudioMonitorComponent::onAnimationFrame(double timeMs)
 {
+    if (this->audioMonitor == nullptr)
+    {
+        return;
+    }
+
+    const auto lPeak = this->audioMonitor->getPeak(0);
+    const auto rPeak = this->audioMonitor->getPeak(1);
+    const auto lRms = this->audioMonitor->getRootMeanSquare(0);
+    const auto rRms = this->audioMonitor->getRootMeanSquare(1);
+
+    const bool isSilent = lPeak == 0.f && rPeak == 0.f && lRms == 0.f && rRms == 0.f;
+    this->numSilentFrames = isSilent ? this->numSilentFrames + 1 : 0;
+    if (this->numSilentFrames > WaveformAudioMonitorComponent::bufferSize)
+    {
+        return;
+    }
+
+    // Shift buffers:
+    for (int i = 0; i < WaveformAudioMonitorComponent::bufferSize - 1; ++i)
+    {
+        this->lPeakBuffer[i] = this->lPeakBuffer[i + 1];
+        this->rPeakBuffer[i] = this->rPeakBuffer[i + 1];
+        this->lRmsBuffer[i] = this->lRmsBuffer[i + 1];
+        this->rRmsBuffer[i] = this->rRmsBuffer[i + 1];
+    }
+
+    const int i = WaveformAudioMonitorComponent::bufferSize - 1;
+
+    // Push next values:
+    this->lPeakBuffer[i] = lPeak;
+    this->rPeakBuffer[i] = rPeak;
+    this->lRmsBuffer[i] = lRms;
+    this->rRmsBuffer[i] = rRms;
+
     this->repaint();
 }
 
@@ -119,8 +142,8 @@ void WaveformAudioMonitorComponent::paint(Graphics &g)
     for (int i = 0; i < w - 1; ++i)
     {
         const float fancyFade = (i == 0 || i == (w - 2)) ? 0.75f : ((i == 1 || i == (w - 3)) ? 0.9f : 1.f);
-        const float peakL = waveformIecLevel(this->lPeakBuffer[i].get()) * midH * fancyFade;
-        const float peakR = waveformIecLevel(this->rPeakBuffer[i].get()) * midH * fancyFade;
+        const float peakL = waveformIecLevel(this->lPeakBuffer[i]) * midH * fancyFade;
+        const float peakR = waveformIecLevel(this->rPeakBuffer[i]) * midH * fancyFade;
         g.fillRect(1.f + (i * 2.f), midH - peakL, 1.f, peakR + peakL);
     }
 
@@ -129,8 +152,8 @@ void WaveformAudioMonitorComponent::paint(Graphics &g)
     for (int i = 0; i < w; ++i)
     {
         const float fancyFade = (i == 0 || i == (w - 1)) ? 0.85f : ((i == 1 || i == (w - 2)) ? 0.95f : 1.f);
-        const float rmsL = waveformIecLevel(this->lRmsBuffer[i].get()) * midH * fancyFade;
-        const float rmsR = waveformIecLevel(this->rRmsBuffer[i].get()) * midH * fancyFade;
+        const float rmsL = waveformIecLevel(this->lRmsBuffer[i]) * midH * fancyFade;
+        const float rmsR = waveformIecLevel(this->rRmsBuffer[i]) * midH * fancyFade;
         g.fillRect(i * 2.f, midH - rmsL, 1.f, rmsR + rmsL);
     }
 }
@@ -20,9 +20,10 @@
 class AudioMonitor;
 
 #include "SequencerLayout.h"
+#include "AnimationClock.h"
 
 class WaveformAudioMonitorComponent final :
-    public Component, private Thread, private AsyncUpdater
+    public Component, private AnimationClock::Listener
 {
 public:
 
@@ -36,25 +37,30 @@ public:
     //===------------------------------------------------------------------===//
 
     void paint(Graphics &g) override;
+    void visibilityChanged() override;
 
 private:
 
-    void run() override;
-    void handleAsyncUpdate() override;
-    
+    void onAnimationFrame(double timeMs) override;
+
+    void updateAnimationState();
+    bool isAnimating = false;
+
+    // no need to shift and repaint the buffers,
+    // once they are filled with silence entirely:
+    int numSilentFrames = 0;
+
     const Colour colour;
 
     WeakReference<AudioMonitor> audioMonitor;
     
     static constexpr auto bufferSize = Globals::UI::sidebarWidth / 2;
 
-    Atomic<float> lPeakBuffer[bufferSize];
-    Atomic<float> rPeakBuffer[bufferSize];
-
-    Atomic<float> lRmsBuffer[bufferSize];
-    Atomic<float> rRmsBuffer[bufferSize];
+    float lPeakBuffer[bufferSize] = {};
+    float rPeakBuffer[bufferSize] = {};
 
-    int skewTime = 0;
+    float lRmsBuffer[bufferSize] = {};
+    float rRmsBuffer[bufferSize] = {};
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(WaveformAudioMonitorComponent)
 
@@ -121,6 +121,7 @@ CommandIDs::Id CommandIDs::getIdForName(const String &command)
         CASE_FOR(ShowNextPage)
         CASE_FOR(ShowRootPage)
         CASE_FOR(ToggleShowHideCombo)
+        CASE_FOR(ToggleProfilerOverlay)
         CASE_FOR(StartDragViewport)
         CASE_FOR(EndDragViewport)
         CASE_FOR(SelectAudioDeviceType)
@@ -301,6 +302,7 @@ I18n::Key CommandIDs::getTranslationKeyFor(CommandIDs::Id id)
         TRANS_NONE(ShowNextPage)
         TRANS_NONE(ShowRootPage)
         TRANS_NONE(ToggleShowHideCombo)
+        TRANS_NONE(ToggleProfilerOverlay)
         TRANS_NONE(StartDragViewport)
         TRANS_NONE(EndDragViewport)
         TRANS_NONE(SelectAudioDeviceType)
@@ -140,6 +140,7 @@ namespace CommandIDs
         ShowNextPage                    = 0x2505,
         ShowRootPage                    = 0x2506,
         ToggleShowHideCombo             = 0x2507,
+        ToggleProfilerOverlay           = 0x2508,
 
         StartDragViewport               = 0x2510,
         EndDragViewport                 = 0x2511,
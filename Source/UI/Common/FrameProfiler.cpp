@@ -0,0 +1,201 @@
+/*
+    This file is part of Helio Workstation.
+
+    Helio is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Helio is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Helio. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "Common.h"
+#include "FrameProfiler.h"
+
+FrameProfiler *FrameProfiler::instance = nullptr;
+
+FrameProfiler::FrameProfiler()
+{
+    jassert(FrameProfiler::instance == nullptr);
+
+    this->events.resize(FrameProfiler::maxEvents);
+    this->frames.resize(FrameProfiler::maxFrames);
+
+    this->lastTickMs = Time::getMillisecondCounterHiRes();
+    this->currentFrame.startMs = this->lastTickMs;
+
+    FrameProfiler::instance = this;
+    this->startTimerHz(FrameProfiler::framesPerSecond);
+}
+
+FrameProfiler::~FrameProfiler()
+{
+    this->stopTimer();
+    FrameProfiler::instance = nullptr;
+}
+
+void FrameProfiler::addEvent(const char *name, Category category,
+    double startMs, double durationMs) noexcept
+{
+    jassert(MessageManager::getInstance()->isThisTheMessageThread());
+
+    auto &event = this->events.getReference(this->nextEventIndex);
+    event.name = name;
+    event.category = category;
+    event.startMs = startMs;
+    event.durationMs = durationMs;
+
+    this->nextEventIndex = (this->nextEventIndex + 1) % FrameProfiler::maxEvents;
+    this->eventsWrapped = this->eventsWrapped || this->nextEventIndex == 0;
+
+    switch (category)
+    {
+    case Category::Paint:
+    case Category::MiniMap:
+        this->currentFrame.paintMs += durationMs;
+        this->currentFrame.numPaints++;
+        break;
+    case Category::BatchRepaint:
+    case Category::Playhead:
+    case Category::Zoom:
+        this->currentFrame.updateMs += durationMs;
+        break;
+    case Category::Stall:
+        this->currentFrame.numStalls++;
+        this->currentFrame.longestStallMs =
+            jmax(this->currentFrame.longestStallMs, durationMs);
+        break;
+    default:
+        break;
+    }
+}
+
+// The timer is expected to fire once per frame, so if it was late
+// for more than a threshold, something was blocking the message thread:
+void FrameProfiler::timerCallback()
+{
+    const auto nowMs = Time::getMillisecondCounterHiRes();
+    const auto expectedMs = 1000.0 / double(FrameProfiler::framesPerSecond);
+    const auto lateMs = nowMs - this->lastTickMs - expectedMs;
+
+    if (lateMs > FrameProfiler::stallThresholdMs)
+    {
+        this->addEvent("MessageThreadStall", Category::Stall,
+            this->lastTickMs + expectedMs, lateMs);
+    }
+
+    this->frames.getReference(this->nextFrameIndex) = this->currentFrame;
+    this->nextFrameIndex = (this->nextFrameIndex + 1) % FrameProfiler::maxFrames;
+    this->framesWrapped = this->framesWrapped || this->nextFrameIndex == 0;
+
+    this->currentFrame = {};
+    this->currentFrame.startMs = nowMs;
+    this->lastTickMs = nowMs;
+}
+
+Array<FrameProfiler::FrameStats> FrameProfiler::getRecentFrames(int numFrames) const
+{
+    const auto numAvailable = this->framesWrapped ?
+        int(FrameProfiler::maxFrames) : this->nextFrameIndex;
+
+    const auto numResults = jmin(numFrames, numAvailable);
+
+    Array<FrameStats> result;
+    result.ensureStorageAllocated(numResults);
+
+    for (int i = numResults; i > 0; --i)
+    {
+        const auto index = (this->nextFrameIndex - i + FrameProfiler::maxFrames) % FrameProfiler::maxFrames;
+        result.add(this->frames.getReference(index));
+    }
+
+    return result;
+}
+
+void FrameProfiler::clear()
+{
+    this->nextEventIndex = 0;
+    this->eventsWrapped = false;
+    this->nextFrameIndex = 0;
+    this->framesWrapped = false;
+    this->currentFrame = {};
+    this->currentFrame.startMs = Time::getMillisecondCounterHiRes();
+}
+
+//===----------------------------------------------------------------------===//
+// Chrome trace format, see
+// https://docs.google.com/document/d/1CvAClvFfyA5R-PhYUmn5OOQtYMH4h6I0nSsKchNAySU
+//===----------------------------------------------------------------------===//
+
+static const char *getCategoryName(FrameProfiler::Category category) noexcept
+{
+    switch (category)
+    {
+        case FrameProfiler::Category::Paint: return "paint";
+        case FrameProfiler::Category::MiniMap: return "minimap";
+        case FrameProfiler::Category::BatchRepaint: return "repaint";
+        case FrameProfiler::Category::Playhead: return "playhead";
+        case FrameProfiler::Category::Zoom: return "zoom";
+        case FrameProfiler::Category::Stall: return "stall";
+        default: return "misc";
+    }
+}
+
+static inline String msToTraceTimestamp(double ms)
+{
+    return String(int64(ms * 1000.0)); // trace timestamps are in microseconds
+}
+
+bool FrameProfiler::exportChromeTrace(const File &file) const
+{
+    MemoryOutputStream out;
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+
+    bool isFirstRecord = true;
+    const auto writeSeparator = [&out, &isFirstRecord]()
+    {
+        if (!isFirstRecord)
+        {
+            out << ",\n";
+        }
+
+        isFirstRecord = false;
+    };
+
+    const auto numEvents = this->eventsWrapped ?
+        int(FrameProfiler::maxEvents) : this->nextEventIndex;
+
+    for (int i = numEvents; i > 0; --i)
+    {
+        const auto index = (this->nextEventIndex - i + FrameProfiler::maxEvents) % FrameProfiler::maxEvents;
+        const auto &event = this->events.getReference(index);
+
+        writeSeparator();
+        out << "{\"name\":\"" << event.name
+            << "\",\"cat\":\"" << getCategoryName(event.category)
+            << "\",\"ph\":\"X\",\"pid\":1,\"tid\":1"
+            << ",\"ts\":" << msToTraceTimestamp(event.startMs)
+            << ",\"dur\":" << msToTraceTimestamp(event.durationMs) << "}";
+    }
+
+    // per-frame counters go as separate tracks
+    for (const auto &frame : this->getRecentFrames(FrameProfiler::maxFrames))
+    {
+        writeSeparator();
+        out << "{\"name\":\"frame\",\"ph\":\"C\",\"pid\":1"
+            << ",\"ts\":" << msToTraceTimestamp(frame.startMs)
+            << ",\"args\":{\"paints\":" << frame.numPaints
+            << ",\"repaints\":" << frame.numRepaints
+            << ",\"listeners\":" << frame.numListenerCalls << "}}";
+    }
+
+    out << "\n]}\n";
+
+    return file.replaceWithData(out.getData(), out.getDataSize());
+}
@@ -0,0 +1,157 @@
+/*
+    This file is part of Helio Workstation.
+
+    Helio is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Helio is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Helio. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+// A simple message thread profiler: while it exists, it collects the scoped
+// events (paints, batch repaints, playhead ticks, etc.) into a ring buffer,
+// aggregates them into per-frame stats, keeps track of the message thread
+// stalls, and is able to dump all that as a Chrome trace json
+// (which can be opened in chrome://tracing or in Perfetto UI).
+
+// Instrumented code is not supposed to check if the profiler is running,
+// all the static methods are no-op when it's not, so that the cost
+// is a single pointer check per scope for normal runs.
+
+class FrameProfiler final : private Timer
+{
+public:
+
+    FrameProfiler();
+    ~FrameProfiler() override;
+
+    enum class Category : int8
+    {
+        Paint,
+        MiniMap,
+        BatchRepaint,
+        Playhead,
+        Zoom,
+        Stall
+    };
+
+    struct Event final
+    {
+        const char *name = nullptr;
+        Category category = Category::Paint;
+        double startMs = 0.0;
+        double durationMs = 0.0;
+    };
+
+    struct FrameStats final
+    {
+        double startMs = 0.0;
+        double paintMs = 0.0; // includes both paint and mini-map categories
+        double updateMs = 0.0; // batch repaints, playhead and zoom updates
+        int numPaints = 0;
+        int numRepaints = 0;
+        int numListenerCalls = 0;
+        int numStalls = 0;
+        double longestStallMs = 0.0;
+    };
+
+    class ScopedEvent final
+    {
+    public:
+
+        ScopedEvent(const char *name, Category category) noexcept :
+            name(name), category(category),
+            startMs(FrameProfiler::instance != nullptr ?
+                Time::getMillisecondCounterHiRes() : 0.0) {}
+
+        ~ScopedEvent()
+        {
+            if (this->startMs > 0.0 && FrameProfiler::instance != nullptr)
+            {
+                FrameProfiler::instance->addEvent(this->name, this->category,
+                    this->startMs, Time::getMillisecondCounterHiRes() - this->startMs);
+            }
+        }
+
+    private:
+
+        const char *name;
+        const Category category;
+        const double startMs;
+
+        JUCE_DECLARE_NON_COPYABLE(ScopedEvent)
+        JUCE_PREVENT_HEAP_ALLOCATION
+    };
+
+    //===------------------------------------------------------------------===//
+    // Instrumentation, message thread only
+    //===------------------------------------------------------------------===//
+
+    static inline bool isRunning() noexcept
+    {
+        return FrameProfiler::instance != nullptr;
+    }
+
+    static inline void countRepaints(int numComponents) noexcept
+    {
+        if (FrameProfiler::instance != nullptr)
+        {
+            FrameProfiler::instance->currentFrame.numRepaints += numComponents;
+        }
+    }
+
+    static inline void countListenerCalls(int numListeners) noexcept
+    {
+        if (FrameProfiler::instance != nullptr)
+        {
+            FrameProfiler::instance->currentFrame.numListenerCalls += numListeners;
+        }
+    }
+
+    //===------------------------------------------------------------------===//
+    // Stats
+    //===------------------------------------------------------------------===//
+
+    // returns the last N frames, the oldest first
+    Array<FrameStats> getRecentFrames(int numFrames) const;
+
+    bool exportChromeTrace(const File &file) const;
+    void clear();
+
+    static constexpr auto stallThresholdMs = 50.0;
+
+private:
+
+    void addEvent(const char *name, Category category,
+        double startMs, double durationMs) noexcept;
+
+    void timerCallback() override;
+
+    static FrameProfiler *instance;
+
+    static constexpr auto maxEvents = 1 << 16;
+    static constexpr auto maxFrames = 1 << 12;
+    static constexpr auto framesPerSecond = 60;
+
+    Array<Event> events;
+    int nextEventIndex = 0;
+    bool eventsWrapped = false;
+
+    Array<FrameStats> frames;
+    int nextFrameIndex = 0;
+    bool framesWrapped = false;
+
+    FrameStats currentFrame;
+    double lastTickMs = 0.0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(FrameProfiler)
+};
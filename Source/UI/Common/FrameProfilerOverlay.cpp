@@ -0,0 +1,128 @@
+/*
+    This file is part of Helio Workstation.
+
+    Helio is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Helio is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Helio. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "Common.h"
+#include "FrameProfilerOverlay.h"
+#include "DocumentHelpers.h"
+#include "MainLayout.h"
+
+FrameProfilerOverlay::FrameProfilerOverlay()
+{
+    this->setPaintingIsUnclipped(true);
+    this->setAlwaysOnTop(true);
+    this->setMouseCursor(MouseCursor::PointingHandCursor);
+    this->setSize(FrameProfilerOverlay::overlayWidth, FrameProfilerOverlay::overlayHeight);
+
+    // the overlay itself doesn't need to be updated every frame
+    this->startTimerHz(5);
+}
+
+FrameProfilerOverlay::~FrameProfilerOverlay()
+{
+    this->stopTimer();
+}
+
+void FrameProfilerOverlay::timerCallback()
+{
+    this->recentFrames = this->profiler.getRecentFrames(FrameProfilerOverlay::numFramesToShow);
+    this->repaint();
+}
+
+void FrameProfilerOverlay::paint(Graphics &g)
+{
+    g.setColour(Colours::black.withAlpha(0.75f));
+    g.fillRect(this->getLocalBounds());
+
+    if (this->recentFrames.isEmpty())
+    {
+        return;
+    }
+
+    double totalPaintMs = 0.0;
+    double totalUpdateMs = 0.0;
+    double maxFrameMs = 0.0;
+    int64 totalPaints = 0;
+    int64 totalRepaints = 0;
+    int64 totalListenerCalls = 0;
+    int totalStalls = 0;
+    double longestStallMs = 0.0;
+
+    for (const auto &frame : this->recentFrames)
+    {
+        totalPaintMs += frame.paintMs;
+        totalUpdateMs += frame.updateMs;
+        maxFrameMs = jmax(maxFrameMs, frame.paintMs + frame.updateMs);
+        totalPaints += frame.numPaints;
+        totalRepaints += frame.numRepaints;
+        totalListenerCalls += frame.numListenerCalls;
+        totalStalls += frame.numStalls;
+        longestStallMs = jmax(longestStallMs, frame.longestStallMs);
+    }
+
+    const auto numFrames = double(this->recentFrames.size());
+
+    String stats;
+    stats << "paint: " << String(totalPaintMs / numFrames, 2) << " ms avg, "
+          << String(maxFrameMs, 2) << " ms max" << newLine
+          << "updates: " << String(totalUpdateMs / numFrames, 2) << " ms avg" << newLine
+          << "paints: " << String(double(totalPaints) / numFrames, 1)
+          << ", repaints: " << String(double(totalRepaints) / numFrames, 1) << " per frame" << newLine
+          << "listener calls: " << String(double(totalListenerCalls) / numFrames, 1) << " per frame" << newLine
+          << "stalls: " << totalStalls << ", longest " << String(longestStallMs, 0) << " ms";
+
+    g.setColour(Colours::white.withAlpha(0.85f));
+    g.setFont(Globals::UI::Fonts::XS);
+    g.drawFittedText(stats, this->getLocalBounds().reduced(6, 4).withTrimmedBottom(32),
+        Justification::topLeft, 5, 1.f);
+
+    // the graph of paint + update time per frame, the frame budget is the top line
+    const auto graphArea = this->getLocalBounds().reduced(6, 4).removeFromBottom(28).toFloat();
+    const auto barWidth = graphArea.getWidth() / float(FrameProfilerOverlay::numFramesToShow);
+
+    g.setColour(Colours::white.withAlpha(0.2f));
+    g.fillRect(graphArea.getX(), graphArea.getY(), graphArea.getWidth(), 1.f);
+
+    float x = graphArea.getRight() - barWidth * float(this->recentFrames.size());
+    for (const auto &frame : this->recentFrames)
+    {
+        const auto frameMs = frame.paintMs + frame.updateMs;
+        const auto h = float(jmin(1.0, frameMs / FrameProfilerOverlay::budgetMs)) * graphArea.getHeight();
+
+        g.setColour(frame.numStalls > 0 ? Colours::red :
+            (frameMs > FrameProfilerOverlay::budgetMs ? Colours::orange : Colours::lightgreen));
+
+        g.fillRect(x, graphArea.getBottom() - h, jmax(1.f, barWidth - 1.f), jmax(1.f, h));
+        x += barWidth;
+    }
+}
+
+void FrameProfilerOverlay::mouseUp(const MouseEvent &e)
+{
+    const auto fileName = "helio-trace-" +
+        Time::getCurrentTime().formatted("%Y-%m-%d-%H%M%S") + ".json";
+
+    const auto file = DocumentHelpers::getDocumentSlot(fileName);
+
+    if (this->profiler.exportChromeTrace(file))
+    {
+        App::Layout().showTooltip(file.getFullPathName(), MainLayout::TooltipIcon::Success);
+    }
+    else
+    {
+        App::Layout().showTooltip({}, MainLayout::TooltipIcon::Failure);
+    }
+}
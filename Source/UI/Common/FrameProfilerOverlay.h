@@ -0,0 +1,51 @@
+/*
+    This file is part of Helio Workstation.
+
+    Helio is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Helio is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Helio. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include "FrameProfiler.h"
+
+// Shows the stats of the recent frames in the corner of the main layout;
+// the profiler runs for as long as the overlay exists,
+// click on the overlay to export the Chrome trace file.
+
+class FrameProfilerOverlay final : public Component, private Timer
+{
+public:
+
+    FrameProfilerOverlay();
+    ~FrameProfilerOverlay() override;
+
+    static constexpr auto overlayWidth = 240;
+    static constexpr auto overlayHeight = 112;
+
+    void paint(Graphics &g) override;
+    void mouseUp(const MouseEvent &e) override;
+
+private:
+
+    void timerCallback() override;
+
+    FrameProfiler profiler;
+
+    Array<FrameProfiler::FrameStats> recentFrames;
+
+    static constexpr auto numFramesToShow = 120;
+    static constexpr auto budgetMs = 1000.0 / 60.0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(FrameProfilerOverlay)
+};
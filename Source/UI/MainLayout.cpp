@@ -40,6 +40,7 @@
 #include "ColourIDs.h"
 #include "ColourSchemesManager.h"
 #include "CommandPaletteCommonActions.h"
+#include "FrameProfilerOverlay.h"
 
 class InitScreen final : public Component, private Timer
 {
@@ -155,6 +156,7 @@ MainLayout::MainLayout()
 MainLayout::~MainLayout()
 {
     this->removeAllChildren();
+    this->profilerOverlay = nullptr;
     this->consoleCommonActions = nullptr;
     this->hotkeyScheme = nullptr;
     this->headline = nullptr;
@@ -380,6 +382,13 @@ void MainLayout::resized()
     {
         this->initScreen->setBounds(this->getLocalBounds());
     }
+
+    if (this->profilerOverlay)
+    {
+        this->profilerOverlay->setTopLeftPosition(
+            this->getWidth() - this->profilerOverlay->getWidth(),
+            this->getHeight() - this->profilerOverlay->getHeight());
+    }
 }
 
 void MainLayout::lookAndFeelChanged()
@@ -528,6 +537,9 @@ void MainLayout::handleCommandMessage(int commandId)
         emitCommandPalette();
         break;
     }
+    case CommandIDs::ToggleProfilerOverlay:
+        this->toggleProfilerOverlay();
+        break;
     default:
         break;
     }
@@ -548,6 +560,19 @@ void MainLayout::broadcastCommandMessage(int commandId)
     }
 }
 
+void MainLayout::toggleProfilerOverlay()
+{
+    if (this->profilerOverlay != nullptr)
+    {
+        this->profilerOverlay = nullptr;
+        return;
+    }
+
+    this->profilerOverlay = make<FrameProfilerOverlay>();
+    this->addAndMakeVisible(this->profilerOverlay.get());
+    this->resized();
+}
+
 //===----------------------------------------------------------------------===//
 // Command Palette
 //===----------------------------------------------------------------------===//
@@ -23,6 +23,7 @@ class HeadlineItemDataSource;
 class CommandPaletteCommonActions;
 class TooltipContainer;
 class InitScreen;
+class FrameProfilerOverlay;
 
 #include "CommandPaletteModel.h"
 #include "ComponentFader.h"
@@ -112,5 +113,8 @@ private:
 
     UniquePointer<CommandPaletteCommonActions> consoleCommonActions;
 
+    void toggleProfilerOverlay();
+    UniquePointer<FrameProfilerOverlay> profilerOverlay;
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(MainLayout)
 };
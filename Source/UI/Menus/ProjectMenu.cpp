@@ -226,7 +226,7 @@ void ProjectMenu::showNewAutomationMenu(AnimationType animationType)
         {
             String outTrackId;
             String instrumentId; // empty, it doesn't matter for master tempo track
-            const auto autoTracks = this->project.findChildrenOfType<AutomationTrackNode>();
+            const auto autoTracks = this->project.getAutomationTracks();
             const auto autoTrackParams =
                 SequencerOperations::createAutoTrackTemplate(this->project,
                     TRANS(I18n::Defaults::tempoTrackName), MidiTrack::tempoController,
@@ -331,7 +331,7 @@ void ProjectMenu::showBatchActionsMenu(AnimationType animationType)
     menu.add(MenuItem::item(Icons::automationTrack, CommandIDs::ProjectSetOneTempo,
         TRANS(I18n::Menu::setOneTempo))->closesMenu());
 
-    const auto &tracks = this->project.findChildrenOfType<MidiTrackNode>();
+    const auto &tracks = this->project.getTrackNodes();
     const auto &instruments = App::Workspace().getAudioCore().getInstruments();
     if (instruments.size() > 1 && tracks.size() > 0)
     {
@@ -428,7 +428,7 @@ void ProjectMenu::showSetInstrumentMenu()
             {
                 DBG(instrumentId);
 
-                const auto tracks = this->project.findChildrenOfType<MidiTrackNode>();
+                const auto tracks = this->project.getTrackNodes();
 
                 if (tracks.size() > 0)
                 {
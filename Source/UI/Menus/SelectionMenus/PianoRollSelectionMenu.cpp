@@ -106,7 +106,7 @@ MenuPanel::Menu PianoRollSelectionMenu::createMoveToTrackPanel()
 
     const auto *sourceTrack = this->lasso->getFirstAs<NoteComponent>()->getNote().getSequence()->getTrack();
 
-    for (auto *targetTrack : this->project.findChildrenOfType<PianoTrackNode>())
+    for (auto *targetTrack : this->project.getPianoTracks())
     {
         if (targetTrack == sourceTrack)
         {
@@ -169,7 +169,7 @@ MenuPanel::Menu PianoRollSelectionMenu::createRefactoringPanel()
     menu.add(MenuItem::item(Icons::cut, CommandIDs::NewTrackFromSelection,
         TRANS(I18n::Menu::Selection::notesToTrack))->closesMenu());
 
-    const bool nowhereToMove = this->project.findChildrenOfType<PianoTrackNode>().size() < 2;
+    const bool nowhereToMove = this->project.getPianoTracks().size() < 2;
 
     menu.add(MenuItem::item(Icons::cut,
         TRANS(I18n::Menu::Selection::notesMoveTo))->
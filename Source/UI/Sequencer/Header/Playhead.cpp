@@ -20,6 +20,7 @@
 #include "Transport.h"
 #include "RollBase.h"
 #include "ColourIDs.h"
+#include "FrameProfiler.h"
 #include "PlayerThread.h"
 
 Playhead::Playhead(RollBase &parentRoll,
@@ -49,6 +50,7 @@ Playhead::Playhead(RollBase &parentRoll,
 
 Playhead::~Playhead()
 {
+    this->stopAnimation();
     this->transport.removeTransportListener(this);
 }
 
@@ -62,7 +64,7 @@ void Playhead::onSeek(float beatPosition, double currentTimeMs, double totalTime
 
     this->triggerAsyncUpdate();
 
-    if (this->isTimerRunning())
+    if (this->isAnimating)
     {
         this->timerStartTime = Time::getMillisecondCounterHiRes();
         this->timerStartPosition = this->lastCorrectPosition;
@@ -73,7 +75,7 @@ void Playhead::onTempoChanged(double msPerQuarter)
 {
     this->msPerQuarterNote = jmax(msPerQuarter, 0.01);
         
-    if (this->isTimerRunning())
+    if (this->isAnimating)
     {
         this->timerStartTime = Time::getMillisecondCounterHiRes();
         this->timerStartPosition = this->lastCorrectPosition;
@@ -84,7 +86,7 @@ void Playhead::onPlay()
 {
     this->timerStartTime = Time::getMillisecondCounterHiRes();
     this->timerStartPosition = this->lastCorrectPosition;
-    this->startTimerHz(60);
+    this->startAnimation();
 }
 
 void Playhead::onRecord()
@@ -98,7 +100,7 @@ void Playhead::onStop()
     this->currentColour = this->playbackColour;
     this->repaint();
 
-    this->stopTimer();
+    this->stopAnimation();
 
     this->timerStartTime = 0.0;
     this->timerStartPosition = 0.0;
@@ -106,12 +108,35 @@ void Playhead::onStop()
 }
 
 //===----------------------------------------------------------------------===//
-// Timer
+// AnimationClock::Listener
 //===----------------------------------------------------------------------===//
 
-void Playhead::timerCallback()
+void Playhead::onAnimationFrame(double timeMs)
 {
-    this->triggerAsyncUpdate();
+    FrameProfiler::ScopedEvent profilerScope("Playhead::onAnimationFrame",
+        FrameProfiler::Category::Playhead);
+
+    this->tick(timeMs);
+}
+
+// transport callbacks come under the message manager lock,
+// so it's safe to subscribe and unsubscribe from there
+void Playhead::startAnimation()
+{
+    if (!this->isAnimating)
+    {
+        App::AnimationClock().addListener(this);
+        this->isAnimating = true;
+    }
+}
+
+void Playhead::stopAnimation()
+{
+    if (this->isAnimating)
+    {
+        App::AnimationClock().removeListener(this);
+        this->isAnimating = false;
+    }
 }
 
 //===----------------------------------------------------------------------===//
@@ -120,9 +145,12 @@ void Playhead::timerCallback()
 
 void Playhead::handleAsyncUpdate()
 {
-    if (this->isTimerRunning())
+    FrameProfiler::ScopedEvent profilerScope("Playhead::handleAsyncUpdate",
+        FrameProfiler::Category::Playhead);
+
+    if (this->isAnimating)
     {
-        this->tick();
+        this->tick(Time::getMillisecondCounterHiRes());
     }
     else
     {
@@ -159,9 +187,9 @@ void Playhead::parentChanged()
     {
         this->setSize(this->getWidth(), this->getParentHeight());
         
-        if (this->isTimerRunning())
+        if (this->isAnimating)
         {
-            this->tick();
+            this->tick(Time::getMillisecondCounterHiRes());
         }
         else
         {
@@ -174,6 +202,14 @@ void Playhead::parentChanged()
 void Playhead::updatePosition(double position)
 {
     const int newX = this->roll.getPlayheadPositionByBeat(position, double(this->getParentWidth()));
+
+    // at small zoom levels, the playhead may stay at the same pixel for several frames,
+    // and there's no need to invalidate anything (or to scroll the roll) in that case
+    if (newX == this->getX() && this->getY() == 0)
+    {
+        return;
+    }
+
     this->setTopLeftPosition(newX, 0);
 
     if (this->listener != nullptr)
@@ -182,9 +218,9 @@ void Playhead::updatePosition(double position)
     }
 }
 
-void Playhead::tick()
+void Playhead::tick(double timeMs)
 {
-    const double timeOffsetMs = Time::getMillisecondCounterHiRes() - this->timerStartTime.get();
+    const double timeOffsetMs = timeMs - this->timerStartTime.get();
     const double positionOffset = timeOffsetMs / this->msPerQuarterNote.get();
     const double estimatedPosition = this->timerStartPosition.get() + positionOffset;
     this->updatePosition(estimatedPosition);
@@ -21,12 +21,13 @@ class Transport;
 class RollBase;
 
 #include "TransportListener.h"
+#include "AnimationClock.h"
 
 class Playhead final :
     public Component,
     public TransportListener,
     private AsyncUpdater,
-    private Timer
+    private AnimationClock::Listener
 {
 public:
 
@@ -73,11 +74,15 @@ protected:
 private:
 
     //===------------------------------------------------------------------===//
-    // Timer
+    // AnimationClock::Listener
     //===------------------------------------------------------------------===//
 
-    void timerCallback() override;
-    void tick();
+    void onAnimationFrame(double timeMs) override;
+    void tick(double timeMs);
+
+    void startAnimation();
+    void stopAnimation();
+    bool isAnimating = false;
 
     void parentChanged();
 
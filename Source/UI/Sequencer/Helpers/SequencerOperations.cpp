@@ -1748,7 +1748,7 @@ bool SequencerOperations::rescale(const ProjectNode &project, float startBeat, f
     bool hasMadeChanges = false;
     bool didCheckpoint = !shouldCheckpoint;
 
-    const auto pianoTracks = project.findChildrenOfType<PianoTrackNode>();
+    const auto pianoTracks = project.getPianoTracks();
     for (const auto *track : pianoTracks)
     {
         auto *sequence = static_cast<PianoSequence *>(track->getSequence());
@@ -1853,7 +1853,7 @@ bool SequencerOperations::remapNotesToTemperament(const ProjectNode &project,
         return 0;
     };
 
-    const auto pianoTracks = project.findChildrenOfType<PianoTrackNode>();
+    const auto pianoTracks = project.getPianoTracks();
     for (const auto *track : pianoTracks)
     {
         // upscaling temperament from twelve-tone is really straightforward,
@@ -2322,7 +2322,7 @@ bool SequencerOperations::setOneTempoForProject(ProjectNode &project,
 
     // make sure there's only one tempo track with exactly one clip:
 
-    const auto automations = project.findChildrenOfType<AutomationTrackNode>();
+    const auto automations = project.getAutomationTracks();
 
     AutomationTrackNode *tempoTrackOne = nullptr;
     Array<AutomationTrackNode *> tracksToDelete;
@@ -19,6 +19,7 @@
 #include "LevelsMapScroller.h"
 #include "RollBase.h"
 #include "ColourIDs.h"
+#include "FrameProfiler.h"
 #include "HelioTheme.h"
 
 LevelsMapScroller::LevelsMapScroller(SafePointer<RollBase> roll) : roll(roll)
@@ -59,6 +60,9 @@ void LevelsMapScroller::resized()
 
 void LevelsMapScroller::paint(Graphics &g)
 {
+    FrameProfiler::ScopedEvent profilerScope("LevelsMapScroller::paint",
+        FrameProfiler::Category::MiniMap);
+
     const auto &theme = HelioTheme::getCurrentTheme();
     g.setFillType({ theme.getBgCacheC(), {} });
     g.fillRect(this->getLocalBounds());
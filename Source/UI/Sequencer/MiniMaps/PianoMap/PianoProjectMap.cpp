@@ -26,6 +26,7 @@
 #include "RollBase.h"
 #include "AnnotationEvent.h"
 #include "ColourIDs.h"
+#include "FrameProfiler.h"
 
 PianoProjectMap::PianoProjectMap(ProjectNode &parentProject, RollBase &parentRoll) :
     project(parentProject),
@@ -64,6 +65,9 @@ void PianoProjectMap::resized()
 
 void PianoProjectMap::paint(Graphics &g)
 {
+    FrameProfiler::ScopedEvent profilerScope("PianoProjectMap::paint",
+        FrameProfiler::Category::MiniMap);
+
     const float rollLengthInBeats = this->rollLastBeat - this->rollFirstBeat;
     const float projectLengthInBeats = this->projectLastBeat - this->projectFirstBeat;
     const float mapWidth = float(this->getWidth()) * (projectLengthInBeats / rollLengthInBeats);
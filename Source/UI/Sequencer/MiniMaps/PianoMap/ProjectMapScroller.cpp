@@ -23,6 +23,7 @@
 #include "Transport.h"
 #include "RollBase.h"
 #include "ColourIDs.h"
+#include "FrameProfiler.h"
 #include "HelioTheme.h"
 #include "MainLayout.h"
 
@@ -179,6 +180,9 @@ void ProjectMapScroller::resized()
 
 void ProjectMapScroller::paint(Graphics &g)
 {
+    FrameProfiler::ScopedEvent profilerScope("ProjectMapScroller::paint",
+        FrameProfiler::Category::MiniMap);
+
     const auto &theme = HelioTheme::getCurrentTheme();
     g.setFillType({ theme.getBgCacheC(), {} });
     g.fillRect(this->getLocalBounds());
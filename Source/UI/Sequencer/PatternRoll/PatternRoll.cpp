@@ -56,6 +56,7 @@
 #include "CommandIDs.h"
 #include "ColourIDs.h"
 #include "Config.h"
+#include "FrameProfiler.h"
 
 struct StringComparator final
 {
@@ -864,8 +865,11 @@ void PatternRoll::resized()
 
 void PatternRoll::paint(Graphics &g)
 {
+    FrameProfiler::ScopedEvent profilerScope("PatternRoll::paint",
+        FrameProfiler::Category::Paint);
+
     g.setTiledImageFill(this->rowPattern, 0, Globals::UI::rollHeaderHeight, 1.f);
-    g.fillRect(this->viewport.getViewArea());
+    g.fillRect(this->viewport.getViewArea().getIntersection(g.getClipBounds()));
     g.setFont(Globals::UI::Fonts::XS); // so that clips don't have to do it
     RollBase::paint(g);
 }
@@ -56,6 +56,7 @@
 #include "MainLayout.h"
 #include "ComponentIDs.h"
 #include "Config.h"
+#include "FrameProfiler.h"
 
 #define forEachEventOfGivenTrack(map, child, track) \
     for (const auto &_c : map) \
@@ -1369,18 +1370,29 @@ void PianoRoll::resized()
 
 void PianoRoll::paint(Graphics &g)
 {
+    FrameProfiler::ScopedEvent profilerScope("PianoRoll::paint",
+        FrameProfiler::Category::Paint);
+
     jassert(this->defaultHighlighting != nullptr); // trying to paint before the content is ready
 
+    // only fill what's invalidated, which is often just
+    // a thin strip around the playhead during the playback:
+    const auto paintArea = this->viewport.getViewArea().getIntersection(g.getClipBounds());
+    if (paintArea.isEmpty())
+    {
+        return;
+    }
+
     const auto *keysSequence = this->project.getTimeline()->getKeySignatures()->getSequence();
-    const int paintStartX = this->viewport.getViewPositionX();
-    const int paintEndX = paintStartX + this->viewport.getViewWidth();
+    const int paintStartX = paintArea.getX();
+    const int paintEndX = paintArea.getRight();
 
     static constexpr auto paintOffsetY = Globals::UI::rollHeaderHeight;
 
     int prevBeatX = paintStartX;
     const HighlightingScheme *prevScheme = nullptr;
-    const int y = this->viewport.getViewPositionY();
-    const int h = this->viewport.getViewHeight();
+    const int y = paintArea.getY();
+    const int h = paintArea.getHeight();
 
     const auto periodHeight = this->rowHeight * this->getPeriodSize();
     const auto numPeriodsToSkip = (y - paintOffsetY) / periodHeight;
@@ -1841,7 +1853,7 @@ Array<CommandPaletteActionsProvider *> PianoRoll::getCommandPaletteActionProvide
     }
 
     if (this->selection.getNumSelected() > 0 &&
-        this->project.findChildrenOfType<PianoTrackNode>().size() > 1)
+        this->project.getPianoTracks().size() > 1)
     {
         result.add(this->consoleMoveNotesMenu.get());
     }
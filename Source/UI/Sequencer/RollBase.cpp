@@ -63,6 +63,7 @@
 #include "AudioMonitor.h"
 #include "Config.h"
 #include "ColourIDs.h"
+#include "FrameProfiler.h"
 
 #if PLATFORM_DESKTOP
 #   define ROLL_VIEW_FOLLOWS_PLAYHEAD 1
@@ -178,6 +179,7 @@ RollBase::~RollBase()
     }
 
     this->removeAllRollListeners();
+    this->stopScrollingToPlayhead();
 
     this->project.getTransport().removeTransportListener(this);
     this->project.getEditMode().removeChangeListener(this);
@@ -519,6 +521,9 @@ void RollBase::zoomToArea(float minBeat, float maxBeat, float marginBeats)
 void RollBase::zoomRelative(const Point<float> &origin,
     const Point<float> &factor, bool isInertialZoom)
 {
+    FrameProfiler::ScopedEvent profilerScope("RollBase::zoomRelative",
+        FrameProfiler::Category::Zoom);
+
     this->stopFollowingPlayhead();
 
     const auto oldViewPosition = this->viewport.getViewPosition().toFloat();
@@ -1465,31 +1470,54 @@ void RollBase::paint(Graphics &g)
 {
     this->computeAllSnapLines();
 
-    const float y = float(this->viewport.getViewPositionY());
-    const float h = float(this->viewport.getViewHeight());
+    // the snap lines above are still computed for the whole view,
+    // since the header uses them, but when only a part of the roll
+    // is invalidated (e.g. the playhead strip), only that part is filled:
+    const auto paintArea = this->viewport.getViewArea().getIntersection(g.getClipBounds());
+    if (paintArea.isEmpty())
+    {
+        return;
+    }
+
+    const float paintStartX = float(paintArea.getX() - 1);
+    const float paintEndX = float(paintArea.getRight());
+    const float y = float(paintArea.getY());
+    const float h = float(paintArea.getHeight());
 
     g.setColour(this->barLineColour);
     for (const auto &f : this->visibleBars)
     {
-        g.fillRect(floorf(f), y, 1.f, h);
+        if (f >= paintStartX && f < paintEndX)
+        {
+            g.fillRect(floorf(f), y, 1.f, h);
+        }
     }
 
     g.setColour(this->barLineBevelColour);
     for (const auto &f : this->visibleBars)
     {
-        g.fillRect(floorf(f + 1.f), y, 1.f, h);
+        if (f >= paintStartX && f < paintEndX)
+        {
+            g.fillRect(floorf(f + 1.f), y, 1.f, h);
+        }
     }
 
     g.setColour(this->beatLineColour);
     for (const auto &f : this->visibleBeats)
     {
-        g.fillRect(floorf(f), y, 1.f, h);
+        if (f >= paintStartX && f < paintEndX)
+        {
+            g.fillRect(floorf(f), y, 1.f, h);
+        }
     }
 
     g.setColour(this->snapLineColour);
     for (const auto &f : this->visibleSnaps)
     {
-        g.fillRect(floorf(f), y, 1.f, h);
+        if (f >= paintStartX && f < paintEndX)
+        {
+            g.fillRect(floorf(f), y, 1.f, h);
+        }
     }
 }
 
@@ -1509,8 +1537,15 @@ void RollBase::onPlayheadMoved(int playheadX)
         const double smoothThreshold = (this->beatWidth > 75) ? 128.0 : 5.0;
         const double newOffset = (abs(offset) < smoothThreshold) ? 0.0 : offset * smoothCoefficient;
         const int newViewPosX = playheadX - viewHalfWidth - int(round(newOffset));
+
+        // the viewport clamps the position, so near the project edges
+        // it often stays where it was, and nothing needs to be re-laid out:
+        const int oldViewPosX = this->viewport.getViewPositionX();
         this->viewport.setViewPosition(newViewPosX, this->viewport.getViewPositionY());
-        this->updateChildrenPositions();
+        if (this->viewport.getViewPositionX() != oldViewPosX)
+        {
+            this->updateChildrenPositions();
+        }
     }
 }
 
@@ -1591,11 +1626,11 @@ void RollBase::onUiAnimationsFlagChanged(bool enabled)
 #if PLATFORM_DESKTOP
     this->smoothPanController->setAnimationsEnabled(enabled);
     this->smoothZoomController->setAnimationsEnabled(enabled);
-    this->scrollToPlayheadTimerMs = enabled ? 7 : 1;
+    this->scrollToPlayheadStepMs = enabled ? 7.0 : 1.0;
 #elif PLATFORM_MOBILE
     this->smoothPanController->setAnimationsEnabled(false);
     this->smoothZoomController->setAnimationsEnabled(false);
-    this->scrollToPlayheadTimerMs = 1;
+    this->scrollToPlayheadStepMs = 1.0;
 #endif
 }
 
@@ -1655,7 +1690,7 @@ void RollBase::stopFollowingPlayhead()
     }
 
 #if ROLL_VIEW_FOLLOWS_PLAYHEAD
-    this->stopTimer();
+    this->stopScrollingToPlayhead();
     this->shouldFollowPlayhead = false;
 #endif
 }
@@ -1664,7 +1699,12 @@ void RollBase::scrollToPlayheadPosition()
 {
 #if ROLL_VIEW_FOLLOWS_PLAYHEAD
     this->startFollowingPlayhead();
-    this->startTimer(this->scrollToPlayheadTimerMs);
+    if (!this->isScrollingToPlayhead)
+    {
+        this->isScrollingToPlayhead = true;
+        this->lastScrollToPlayheadFrameMs = Time::getMillisecondCounterHiRes();
+        App::AnimationClock().addListener(this, AnimationClock::Priority::Animation);
+    }
 #else
     const int playheadX = this->getXPositionByBeat(this->lastTransportBeat.get());
     this->viewport.setViewPosition(playheadX -
@@ -1680,9 +1720,14 @@ void RollBase::scrollToPlayheadPosition()
 
 void RollBase::handleAsyncUpdate()
 {
+    FrameProfiler::ScopedEvent profilerScope("RollBase::handleAsyncUpdate",
+        FrameProfiler::Category::BatchRepaint);
+
     // batch repaint & resize stuff
     if (this->batchRepaintList.size() > 0)
     {
+        FrameProfiler::countRepaints(this->batchRepaintList.size());
+
         const auto &editMode = this->project.getEditMode();
         const bool childrenInteractionEnabled = editMode.shouldInteractWithChildren();
         const auto childCursor = childrenInteractionEnabled ?
@@ -1707,27 +1752,6 @@ void RollBase::handleAsyncUpdate()
 
         this->batchRepaintList.clearQuick();
     }
-
-#if ROLL_VIEW_FOLLOWS_PLAYHEAD
-    if (this->isTimerRunning())
-    {
-        const int playheadX = this->getPlayheadPositionByBeat(this->lastTransportBeat.get(), double(this->getWidth()));
-        const int newX = playheadX - int(this->playheadOffset.get() * 0.9) - (this->viewport.getViewWidth() / 2);
-        const bool stuckFollowingPlayhead = newX == this->viewport.getViewPositionX() ||
-            newX < 0 || newX > (this->getWidth() - this->viewport.getViewWidth());
-
-        if (stuckFollowingPlayhead)
-        {
-            this->stopTimer();
-        }
-        else
-        {
-            this->viewport.setViewPosition(newX, this->viewport.getViewPositionY());
-            this->playheadOffset = this->findPlayheadOffsetFromViewCentre();
-            this->updateChildrenPositions();
-        }
-    }
-#endif
 }
 
 double RollBase::findPlayheadOffsetFromViewCentre() const
@@ -1744,17 +1768,45 @@ void RollBase::triggerBatchRepaintFor(FloatBoundsComponent *target)
 }
 
 //===----------------------------------------------------------------------===//
-// Timer
+// AnimationClock::Listener
 //===----------------------------------------------------------------------===//
 
-void RollBase::hiResTimerCallback()
+void RollBase::onAnimationFrame(double timeMs)
 {
+    // each 7ms step used to close 10% of the distance to the playhead,
+    // so here the step is scaled by the actual time since the last frame:
+    const auto elapsedMs = jmax(0.0, timeMs - this->lastScrollToPlayheadFrameMs);
+    const auto remainingFraction = pow(0.9, elapsedMs / this->scrollToPlayheadStepMs);
+    this->lastScrollToPlayheadFrameMs = timeMs;
+
+    const int playheadX = this->getPlayheadPositionByBeat(this->lastTransportBeat.get(), double(this->getWidth()));
+    const int newX = playheadX - int(this->playheadOffset.get() * remainingFraction) - (this->viewport.getViewWidth() / 2);
+    const bool stuckFollowingPlayhead = newX == this->viewport.getViewPositionX() ||
+        newX < 0 || newX > (this->getWidth() - this->viewport.getViewWidth());
+
+    if (stuckFollowingPlayhead)
+    {
+        this->stopScrollingToPlayhead();
+        return;
+    }
+
+    this->viewport.setViewPosition(newX, this->viewport.getViewPositionY());
+    this->playheadOffset = this->findPlayheadOffsetFromViewCentre();
+    this->updateChildrenPositions();
+
     if (fabs(this->playheadOffset.get()) < 0.1)
     {
-        this->stopTimer();
+        this->stopScrollingToPlayhead();
     }
+}
 
-    this->triggerAsyncUpdate();
+void RollBase::stopScrollingToPlayhead()
+{
+    if (this->isScrollingToPlayhead)
+    {
+        this->isScrollingToPlayhead = false;
+        App::AnimationClock().removeListener(this);
+    }
 }
 
 //===----------------------------------------------------------------------===//
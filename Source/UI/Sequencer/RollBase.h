@@ -37,6 +37,7 @@ class TimelineWarningMarker;
 #include "TimeSignaturesProjectMap.h"
 #include "KeySignaturesProjectMap.h"
 #include "Playhead.h"
+#include "AnimationClock.h"
 #include "TransportListener.h"
 #include "MidiEventComponent.h"
 #include "LongTapListener.h"
@@ -76,7 +77,7 @@ class RollBase :
     protected ChangeListener, // listens to RollEditMode,
     protected TransportListener, // for positioning the playhead component and auto-scrolling
     protected AsyncUpdater, // coalesce multiple transport events ^^ into a single async view change
-    protected HighResolutionTimer, // for smooth scrolling to seek position
+    protected AnimationClock::Listener, // for smooth scrolling to seek position
     protected AudioMonitor::ClippingListener // for displaying clipping indicator components
 {
 public:
@@ -307,7 +308,12 @@ protected:
 
     Atomic<double> playheadOffset = 0.0;
     bool shouldFollowPlayhead = false;
-    int scrollToPlayheadTimerMs = 7;
+    // the smooth scrolling used to be driven by a 7ms timer,
+    // now it's frame-based, but the speed is kept the same:
+    double scrollToPlayheadStepMs = 7.0;
+    double lastScrollToPlayheadFrameMs = 0.0;
+    bool isScrollingToPlayhead = false;
+    void stopScrollingToPlayhead();
 
     //===------------------------------------------------------------------===//
     // AsyncUpdater
@@ -319,10 +325,10 @@ protected:
     friend class RollHeader;
     
     //===------------------------------------------------------------------===//
-    // Timer
+    // AnimationClock::Listener
     //===------------------------------------------------------------------===//
 
-    void hiResTimerCallback() override;
+    void onAnimationFrame(double timeMs) override;
     
 protected:
     